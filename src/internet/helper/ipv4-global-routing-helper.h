@@ -84,6 +84,17 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes previously installed in a prior call to
+   * PopulateRoutingTables(), RecomputeRoutingTables() or
+   * UpdateRoutingTables() after a change of the topology.
+   *
+   * The resulting routes are the same as with RecomputeRoutingTables(),
+   * but when links or networks were only removed (e.g., an interface was
+   * set down), the routes are only recomputed for the routers whose
+   * shortest paths went through them.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
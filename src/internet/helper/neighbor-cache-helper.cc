@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <vector>
+#include "neighbor-cache-helper.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel-list.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+NeighborCacheHelper::NeighborCacheHelper ()
+  : m_permanent (true)
+{
+}
+
+void
+NeighborCacheHelper::SetPermanent (bool permanent)
+{
+  m_permanent = permanent;
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      PopulateNeighborCache (*i);
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<uint32_t> channels;
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); i++)
+    {
+      Ptr<Channel> channel = (*i)->GetChannel ();
+      if (channel != 0 && channels.insert (channel->GetId ()).second)
+        {
+          PopulateNeighborCache (channel);
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  std::vector<Ptr<Ipv4Interface> > ipv4Interfaces;
+  std::vector<Ptr<Ipv6Interface> > ipv6Interfaces;
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      if (ipv4 != 0)
+        {
+          int32_t interface = ipv4->GetInterfaceForDevice (device);
+          if (interface >= 0)
+            {
+              ipv4Interfaces.push_back (ipv4->GetInterface (interface));
+            }
+        }
+      Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+      if (ipv6 != 0)
+        {
+          int32_t interface = ipv6->GetInterfaceForDevice (device);
+          if (interface >= 0)
+            {
+              ipv6Interfaces.push_back (ipv6->GetInterface (interface));
+            }
+        }
+    }
+
+  for (std::size_t i = 0; i < ipv4Interfaces.size (); i++)
+    {
+      for (std::size_t j = 0; j < ipv4Interfaces.size (); j++)
+        {
+          if (i != j)
+            {
+              PopulateArpCache (ipv4Interfaces[i], ipv4Interfaces[j]);
+            }
+        }
+    }
+  for (std::size_t i = 0; i < ipv6Interfaces.size (); i++)
+    {
+      for (std::size_t j = 0; j < ipv6Interfaces.size (); j++)
+        {
+          if (i != j)
+            {
+              PopulateNdiscCache (ipv6Interfaces[i], ipv6Interfaces[j]);
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateArpCache (Ptr<Ipv4Interface> interface, Ptr<Ipv4Interface> neighbor) const
+{
+  NS_LOG_FUNCTION (this << interface << neighbor);
+  Ptr<ArpCache> cache = interface->GetArpCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+  Address mac = neighbor->GetDevice ()->GetAddress ();
+  for (uint32_t i = 0; i < neighbor->GetNAddresses (); i++)
+    {
+      Ipv4Address address = neighbor->GetAddress (i).GetLocal ();
+      if (address == Ipv4Address::GetLoopback () || cache->Lookup (address) != 0)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Adding " << address << " -> " << mac);
+      ArpCache::Entry *entry = cache->Add (address);
+      entry->SetMacAddress (mac);
+      if (m_permanent)
+        {
+          entry->MarkPermanent ();
+        }
+      else
+        {
+          // new entries are alive
+          entry->UpdateSeen ();
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNdiscCache (Ptr<Ipv6Interface> interface, Ptr<Ipv6Interface> neighbor) const
+{
+  NS_LOG_FUNCTION (this << interface << neighbor);
+  Ptr<NdiscCache> cache = interface->GetNdiscCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+  Address mac = neighbor->GetDevice ()->GetAddress ();
+  for (uint32_t i = 0; i < neighbor->GetNAddresses (); i++)
+    {
+      Ipv6Address address = neighbor->GetAddress (i).GetAddress ();
+      if (address.IsLocalhost () || cache->Lookup (address) != 0)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Adding " << address << " -> " << mac);
+      NdiscCache::Entry *entry = cache->Add (address);
+      if (m_permanent)
+        {
+          entry->SetMacAddress (mac);
+          entry->MarkPermanent ();
+        }
+      else
+        {
+          entry->MarkReachable (mac);
+          entry->StartReachableTimer ();
+        }
+    }
+}
+
+} // namespace ns3
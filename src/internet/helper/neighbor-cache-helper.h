@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+class Ipv4Interface;
+class Ipv6Interface;
+
+/**
+ * \ingroup arp
+ *
+ * \brief Helper class that fills the ARP and NDISC caches from the topology.
+ *
+ * The neighbor caches are otherwise filled on demand: the first packets to
+ * each neighbor wait for an ARP or Neighbor Discovery exchange, which on
+ * large shared channels means a burst of broadcasts at the start of the
+ * simulation. This helper adds, to the cache of each IPv4 and IPv6
+ * interface, an entry for every address of every other interface attached
+ * to the same channel.
+ *
+ * By default the entries are permanent: they never expire, and no timer
+ * is scheduled for them. Otherwise the entries behave like freshly
+ * resolved ones and are refreshed by the protocols once they expire.
+ *
+ * The caches reflect the addresses assigned when the helper is called;
+ * existing entries are left untouched.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Choose the kind of entries added to the caches.
+   * \param permanent true for permanent entries, false for entries which
+   *        expire like the resolved ones
+   */
+  void SetPermanent (bool permanent);
+
+  /**
+   * \brief Populate the neighbor caches of all the channels.
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the neighbor caches of the devices attached to a channel.
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the neighbor caches of the channels of some devices.
+   *
+   * All the devices attached to these channels are populated, including
+   * the ones missing from the container.
+   *
+   * \param devices the devices
+   */
+  void PopulateNeighborCache (const NetDeviceContainer &devices) const;
+
+private:
+  /**
+   * \brief Add the addresses of a neighbor to the ARP cache of an interface.
+   * \param interface the interface
+   * \param neighbor the interface of the neighbor
+   */
+  void PopulateArpCache (Ptr<Ipv4Interface> interface, Ptr<Ipv4Interface> neighbor) const;
+
+  /**
+   * \brief Add the addresses of a neighbor to the NDISC cache of an interface.
+   * \param interface the interface
+   * \param neighbor the interface of the neighbor
+   */
+  void PopulateNdiscCache (Ptr<Ipv6Interface> interface, Ptr<Ipv6Interface> neighbor) const;
+
+  bool m_permanent; //!< Whether the added entries are permanent
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,11 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap indexed by vertex ID, so that Push, Pop,
+ * Update and Find do not depend linearly on the number of candidates.
+ * Vertices ranked equally are popped in the order in which they were
+ * pushed or last updated.
  */
 class CandidateQueue
 {
@@ -154,6 +160,17 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restore the order of the Candidate Queue after the distance of
+ * one of its vertices decreased.
+ *
+ * The vertex is ranked after the other vertices of the same rank.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance decreased.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +201,45 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /// A SPFVertex candidate and its sequence number among equally ranked candidates
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< the vertex
+    uint64_t sequence;  //!< the order of the last push or update
+  };
+
+/**
+ * \brief return true if c1 should be popped before c2
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 is ranked before c2, or ranked equally but pushed
+ * or updated before c2
+ */
+  static bool IsBefore (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Move a candidate towards the top of the heap until in order.
+ * \param i The heap index of the candidate
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move a candidate towards the bottom of the heap until in order.
+ * \param i The heap index of the candidate
+ */
+  void SiftDown (uint32_t i);
+
+/**
+ * \brief Store a candidate at a heap index.
+ * \param i The heap index
+ * \param c The candidate
+ */
+  void Place (uint32_t i, const Candidate &c);
+
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex candidates
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  std::unordered_map<uint32_t, uint32_t> m_positions; //!< heap index of the candidates, by vertex ID
+  uint64_t m_sequence; //!< sequence number of the next push or update
 
   /**
    * \brief Stream insertion operator.
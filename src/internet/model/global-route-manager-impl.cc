@@ -27,9 +27,15 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <set>
+#include <map>
+#include <functional>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -39,11 +45,26 @@
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/callback.h"
+#endif
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \brief A global switch to spread the SPF calculations of the routers over
+ * several threads.
+ */
+static GlobalValue g_spfThreads = GlobalValue ("GlobalRoutingSpfThreads",
+                                               "The number of threads running the SPF calculations of the "
+                                               "global routers (only when logging is disabled)",
+                                               UintegerValue (1),
+                                               MakeUintegerChecker<uint32_t> (1));
+
 /**
  * \brief Stream insertion operator.
  *
@@ -470,7 +491,29 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      if (!m_database.insert (LSDBPair_t (addr, lsa)).second)
+        {
+          return;
+        }
+//
+// Index the LSA by the link data of its transit network records.  When
+// several LSAs have the same link data, the one with the lowest address is
+// found, as when searching the database in order.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<std::unordered_map<uint32_t, GlobalRoutingLSA*>::iterator, bool> result =
+            m_linkDataIndex.insert (std::make_pair (lr->GetLinkData ().Get (), lsa));
+          if (!result.second && addr < result.first->second->GetLinkStateId ())
+            {
+              result.first->second = lsa;
+            }
+        }
     }
 }
 
@@ -495,15 +538,12 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i == m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return 0;
     }
-  return 0;
+  return i->second;
 }
 
 GlobalRoutingLSA*
@@ -511,24 +551,43 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its transit network records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  std::unordered_map<uint32_t, GlobalRoutingLSA*>::const_iterator i = m_linkDataIndex.find (addr.Get ());
+  if (i == m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return 0;
     }
-  return 0;
+  return i->second;
+}
+
+std::vector<GlobalRoutingLSA*>
+GlobalRouteManagerLSDB::GetLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<GlobalRoutingLSA*> lsas;
+  lsas.reserve (m_database.size ());
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+  return lsas;
+}
+
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy () const
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB* lsdb = new GlobalRouteManagerLSDB ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsdb->Insert (i->first, new GlobalRoutingLSA (*i->second));
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      lsdb->Insert (m_extdatabase[j]->GetLinkStateId (), new GlobalRoutingLSA (*m_extdatabase[j]));
+    }
+  return lsdb;
 }
 
 // ---------------------------------------------------------------------------
@@ -537,9 +596,20 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 //
 // ---------------------------------------------------------------------------
 
+struct GlobalRouteManagerImpl::SPFWork
+{
+  std::vector<SPFRoot> roots; //!< the routers
+  uint32_t next;              //!< the index of the next router to process
+#ifdef HAVE_PTHREAD_H
+  SystemMutex mutex;          //!< protects next
+#endif
+};
+
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfrootNodeId (0),
+    m_spfWork (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -578,19 +648,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      NS_LOG_LOGIC ("Deleting routes from node " << node->GetId ());
+      DeleteRoutes (router->GetRoutingProtocol ());
     }
   if (m_lsdb)
     {
@@ -600,6 +659,22 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Ipv4GlobalRouting> routing)
+{
+  NS_LOG_FUNCTION (routing);
+  uint32_t j = 0;
+  uint32_t nRoutes = routing->GetNRoutes ();
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      routing->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes");
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -696,40 +771,526 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("About to start SPF calculation");
+  SPFCalculateAll (GetSPFRoots ());
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+std::vector<GlobalRouteManagerImpl::SPFRoot>
+GlobalRouteManagerImpl::GetSPFRoots () const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<SPFRoot> roots;
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
+  uint32_t systemId = MpiInterface::GetSystemId ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
       Ptr<Node> node = *i;
-//
-// Look for the GlobalRouter interface that indicates that the node is
-// participating in routing.
-//
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      uint32_t systemId = MpiInterface::GetSystemId ();
       // Ignore nodes that are not assigned to our systemId (distributed sim)
       if (node->GetSystemId () != systemId) 
         {
           continue;
         }
+//
+// Look for the GlobalRouter interface that indicates that the node is
+// participating in routing.  If the node has a global router interface,
+// then the global routing algorithms are run for it.  The objects the
+// routes are written to are found here, once, so that the SPF calculations
+// do not need to walk the list of nodes.
+//
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetNumLSAs ())
+        {
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.nodeId = node->GetId ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4, 
+                         "GlobalRouteManagerImpl::GetSPFRoots (): "
+                         "GetObject for <Ipv4> interface failed");
+          root.routing = rtr->GetRoutingProtocol ();
+          NS_ASSERT (root.routing);
+          roots.push_back (root);
+        }
+    }
+  return roots;
+}
 
 //
-// if the node has a global router interface, then run the global routing
-// algorithms.
+// The SPF calculations of the routers are independent, except that they
+// update the status of the LSAs in the database.  Each additional thread
+// thus works on its own copy of the database.  The routes of each router
+// are only written by the thread running its calculation.  Since logging is
+// not thread-safe, a single thread is used when any log component is
+// enabled: the calculations also log through the routing and FIB components.
 //
-      if (rtr && rtr->GetNumLSAs () )
+static bool
+IsAnyLogEnabled (void)
+{
+  LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+  for (LogComponent::ComponentList::const_iterator i = components->begin (); i != components->end (); i++)
+    {
+      if (!i->second->IsNoneEnabled ())
         {
-          SPFCalculate (rtr->GetRouterId ());
+          return true;
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateAll (const std::vector<SPFRoot> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  SPFWork work;
+  work.roots = roots;
+  work.next = 0;
+  m_spfWork = &work;
+#ifdef HAVE_PTHREAD_H
+  UintegerValue nThreads;
+  g_spfThreads.GetValue (nThreads);
+  uint32_t n = std::min<uint64_t> (nThreads.Get (), roots.size ());
+  if (n > 1 && !IsAnyLogEnabled ())
+    {
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 1; i < n; i++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          worker->DebugUseLsdb (m_lsdb->Copy ());
+          worker->m_spfWork = &work;
+          workers.push_back (worker);
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFThread, worker)));
+          threads.back ()->Start ();
+        }
+      SPFThread ();
+      for (uint32_t i = 0; i < threads.size (); i++)
+        {
+          threads[i]->Join ();
+          delete workers[i];
+        }
+      m_spfWork = 0;
+      return;
+    }
+#endif
+  SPFThread ();
+  m_spfWork = 0;
+}
+
+void
+GlobalRouteManagerImpl::SPFThread ()
+{
+  NS_LOG_FUNCTION (this);
+  for (;;)
+    {
+      uint32_t index;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (m_spfWork->mutex);
+#endif
+        if (m_spfWork->next == m_spfWork->roots.size ())
+          {
+            return;
+          }
+        index = m_spfWork->next++;
+      }
+      SPFCalculate (m_spfWork->roots[index]);
+    }
 }
 
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB *old = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<SPFRoot> roots = GetSPFRoots ();
+  std::vector<bool> affected;
+  std::vector<std::pair<Ipv4Address, Ipv4Mask> > removed;
+  if (!FindAffectedRoots (old, roots, affected, removed))
+    {
+      delete old;
+      NS_LOG_INFO ("Recomputing all the routes");
+      NodeList::Iterator listEnd = NodeList::End ();
+      for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+        {
+          Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+          if (router != 0)
+            {
+              DeleteRoutes (router->GetRoutingProtocol ());
+            }
+        }
+      SPFCalculateAll (roots);
+      return;
+    }
+  delete old;
+  std::vector<SPFRoot> recompute;
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      if (affected[i])
+        {
+          DeleteRoutes (roots[i].routing);
+          recompute.push_back (roots[i]);
+        }
+      else if (!removed.empty ())
+        {
+          roots[i].routing->RemoveRoutesTo (removed);
+        }
+    }
+  NS_LOG_INFO ("Recomputing the routes of " << recompute.size () << " of " << roots.size () << " routers");
+  SPFCalculateAll (recompute);
+}
+
+//
+// The routes of a router stay valid when the links and networks which were
+// removed were on none of its shortest paths: only removing links, the other
+// paths cannot get shorter.  The next hops of a router also depend on the
+// link records of its neighbors (and of the routers on the networks it is
+// attached to), so the routers close to a change are recomputed as well.
+// The routes to the addresses and networks which are no longer advertised
+// are finally removed from the other routers.
+//
+// The distances to the ends of the removed links are computed with reverse
+// Dijkstra calculations on the old database, one per end.
+//
+bool
+GlobalRouteManagerImpl::FindAffectedRoots (GlobalRouteManagerLSDB* old,
+                                           const std::vector<SPFRoot> &roots,
+                                           std::vector<bool> &affected,
+                                           std::vector<std::pair<Ipv4Address, Ipv4Mask> > &removed) const
+{
+  NS_LOG_FUNCTION (this << old << roots.size ());
+  std::vector<GlobalRoutingLSA*> oldLsas = old->GetLSAs ();
+  std::vector<GlobalRoutingLSA*> newLsas = m_lsdb->GetLSAs ();
+  if (oldLsas.size () != newLsas.size ())
+    {
+      NS_LOG_LOGIC ("Routers or networks changed");
+      return false;
+    }
+  if (old->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
+    {
+      NS_LOG_LOGIC ("External routes changed");
+      return false;
+    }
+  for (uint32_t i = 0; i < old->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *o = old->GetExtLSA (i);
+      GlobalRoutingLSA *n = m_lsdb->GetExtLSA (i);
+      if (o->GetLinkStateId () != n->GetLinkStateId ()
+          || o->GetNetworkLSANetworkMask () != n->GetNetworkLSANetworkMask ()
+          || o->GetAdvertisingRouter () != n->GetAdvertisingRouter ())
+        {
+          NS_LOG_LOGIC ("External routes changed");
+          return false;
+        }
+    }
+//
+// Number the vertices and find the edges of the old SPF graph, in reverse.
+//
+  std::map<Ipv4Address, uint32_t> index;
+  for (uint32_t i = 0; i < oldLsas.size (); i++)
+    {
+      if (oldLsas[i]->GetLinkStateId () != newLsas[i]->GetLinkStateId ()
+          || oldLsas[i]->GetLSType () != newLsas[i]->GetLSType ())
+        {
+          NS_LOG_LOGIC ("Routers or networks changed");
+          return false;
+        }
+      index[oldLsas[i]->GetLinkStateId ()] = i;
+    }
+  typedef std::pair<uint32_t, uint32_t> Edge; // the other vertex and the metric
+  std::vector<std::vector<Edge> > in (oldLsas.size ());
+  std::vector<std::vector<uint32_t> > neighbors (oldLsas.size ());
+  for (uint32_t u = 0; u < oldLsas.size (); u++)
+    {
+      GlobalRoutingLSA *lsa = oldLsas[u];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  continue;
+                }
+              std::map<Ipv4Address, uint32_t>::const_iterator v = index.find (l->GetLinkId ());
+              if (v != index.end ())
+                {
+                  in[v->second].push_back (Edge (u, l->GetMetric ()));
+                  neighbors[u].push_back (v->second);
+                  neighbors[v->second].push_back (u);
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA *w = old->GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              if (w)
+                {
+                  uint32_t v = index[w->GetLinkStateId ()];
+                  in[v].push_back (Edge (u, 0));
+                  neighbors[u].push_back (v);
+                  neighbors[v].push_back (u);
+                }
+            }
+        }
+    }
+//
+// Compare the LSAs.  Removed records and attached routers are removed edges
+// (u, v, metric), or removed addresses and networks.
+//
+  struct RemovedEdge
+  {
+    uint32_t u;
+    uint32_t v;
+    uint32_t metric;
+  };
+  std::vector<RemovedEdge> removedEdges;
+  std::vector<uint32_t> changed;
+  for (uint32_t u = 0; u < oldLsas.size (); u++)
+    {
+      GlobalRoutingLSA *o = oldLsas[u];
+      GlobalRoutingLSA *n = newLsas[u];
+      bool vertexChanged = false;
+      if (o->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          std::multiset<std::vector<uint32_t> > records;
+          for (uint32_t j = 0; j < o->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = o->GetLinkRecord (j);
+              std::vector<uint32_t> record;
+              record.push_back (l->GetLinkType ());
+              record.push_back (l->GetLinkId ().Get ());
+              record.push_back (l->GetLinkData ().Get ());
+              record.push_back (l->GetMetric ());
+              records.insert (record);
+            }
+          for (uint32_t j = 0; j < n->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = n->GetLinkRecord (j);
+              std::vector<uint32_t> record;
+              record.push_back (l->GetLinkType ());
+              record.push_back (l->GetLinkId ().Get ());
+              record.push_back (l->GetLinkData ().Get ());
+              record.push_back (l->GetMetric ());
+              std::multiset<std::vector<uint32_t> >::iterator r = records.find (record);
+              if (r == records.end ())
+                {
+                  NS_LOG_LOGIC ("Link added to router " << o->GetLinkStateId ());
+                  return false;
+                }
+              records.erase (r);
+            }
+          for (std::multiset<std::vector<uint32_t> >::const_iterator r = records.begin (); r != records.end (); r++)
+            {
+              vertexChanged = true;
+              Ipv4Address linkId ((*r)[1]);
+              Ipv4Address linkData ((*r)[2]);
+              if ((*r)[0] == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  Ipv4Mask mask (linkData.Get ());
+                  removed.push_back (std::make_pair (linkId.CombineMask (mask), mask));
+                  continue;
+                }
+              if ((*r)[0] == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  removed.push_back (std::make_pair (linkData, Ipv4Mask::GetOnes ()));
+                }
+              std::map<Ipv4Address, uint32_t>::const_iterator v = index.find (linkId);
+              if (v != index.end ())
+                {
+                  RemovedEdge edge = { u, v->second, (*r)[3] };
+                  removedEdges.push_back (edge);
+                }
+            }
+        }
+      else
+        {
+          if (o->GetNetworkLSANetworkMask () != n->GetNetworkLSANetworkMask ())
+            {
+              NS_LOG_LOGIC ("Mask of network " << o->GetLinkStateId () << " changed");
+              return false;
+            }
+          std::multiset<uint32_t> attached;
+          for (uint32_t j = 0; j < o->GetNAttachedRouters (); j++)
+            {
+              attached.insert (o->GetAttachedRouter (j).Get ());
+            }
+          for (uint32_t j = 0; j < n->GetNAttachedRouters (); j++)
+            {
+              std::multiset<uint32_t>::iterator a = attached.find (n->GetAttachedRouter (j).Get ());
+              if (a == attached.end ())
+                {
+                  NS_LOG_LOGIC ("Router attached to network " << o->GetLinkStateId ());
+                  return false;
+                }
+              attached.erase (a);
+            }
+          for (std::multiset<uint32_t>::const_iterator a = attached.begin (); a != attached.end (); a++)
+            {
+              vertexChanged = true;
+              GlobalRoutingLSA *w = old->GetLSAByLinkData (Ipv4Address (*a));
+              if (w)
+                {
+                  RemovedEdge edge = { u, index[w->GetLinkStateId ()], 0 };
+                  removedEdges.push_back (edge);
+                }
+            }
+        }
+      if (vertexChanged)
+        {
+          changed.push_back (u);
+        }
+    }
+//
+// The removed addresses and networks must not be advertised anymore.
+//
+  std::set<std::pair<uint32_t, uint32_t> > removedSet;
+  for (uint32_t i = 0; i < removed.size (); i++)
+    {
+      removedSet.insert (std::make_pair (removed[i].first.Get (), removed[i].second.Get ()));
+    }
+  for (uint32_t u = 0; u < newLsas.size () && !removedSet.empty (); u++)
+    {
+      GlobalRoutingLSA *lsa = newLsas[u];
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+          if (removedSet.count (std::make_pair (lsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ())))
+            {
+              NS_LOG_LOGIC ("Removed network " << lsa->GetLinkStateId () << " still advertised");
+              return false;
+            }
+          continue;
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          std::pair<uint32_t, uint32_t> destination;
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              Ipv4Mask mask (l->GetLinkData ().Get ());
+              destination = std::make_pair (l->GetLinkId ().CombineMask (mask).Get (), mask.Get ());
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              destination = std::make_pair (l->GetLinkData ().Get (), Ipv4Mask::GetOnes ().Get ());
+            }
+          else
+            {
+              continue;
+            }
+          if (removedSet.count (destination))
+            {
+              NS_LOG_LOGIC ("Removed address " << Ipv4Address (destination.first) << " still advertised");
+              return false;
+            }
+        }
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetExtLSA (i);
+      Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+      if (removedSet.count (std::make_pair (lsa->GetLinkStateId ().CombineMask (mask).Get (), mask.Get ())))
+        {
+          NS_LOG_LOGIC ("Removed network " << lsa->GetLinkStateId () << " still advertised");
+          return false;
+        }
+    }
+//
+// The routers close to a change are affected.
+//
+  std::vector<bool> near (oldLsas.size (), false);
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t u = changed[i];
+      near[u] = true;
+      for (uint32_t j = 0; j < neighbors[u].size (); j++)
+        {
+          uint32_t v = neighbors[u][j];
+          near[v] = true;
+          if (oldLsas[v]->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+            {
+              for (uint32_t k = 0; k < neighbors[v].size (); k++)
+                {
+                  near[neighbors[v][k]] = true;
+                }
+            }
+        }
+    }
+  affected.assign (roots.size (), false);
+  std::vector<uint32_t> rootVertex (roots.size ());
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      std::map<Ipv4Address, uint32_t>::const_iterator v = index.find (roots[i].routerId);
+      if (v == index.end ())
+        {
+          NS_LOG_LOGIC ("Router " << roots[i].routerId << " not in the database");
+          return false;
+        }
+      rootVertex[i] = v->second;
+      affected[i] = near[v->second];
+    }
+//
+// So are the routers having a removed link on one of their shortest paths.
+//
+  std::map<uint32_t, std::vector<uint32_t> > distances; // to a vertex, from every vertex
+  for (uint32_t e = 0; e < removedEdges.size (); e++)
+    {
+      uint32_t targets[2] = { removedEdges[e].u, removedEdges[e].v };
+      for (uint32_t t = 0; t < 2; t++)
+        {
+          if (distances.count (targets[t]))
+            {
+              continue;
+            }
+          std::vector<uint32_t> &d = distances[targets[t]];
+          d.assign (oldLsas.size (), SPF_INFINITY);
+          d[targets[t]] = 0;
+          typedef std::pair<uint32_t, uint32_t> Entry; // the distance and the vertex
+          std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+          queue.push (Entry (0, targets[t]));
+          while (!queue.empty ())
+            {
+              Entry top = queue.top ();
+              queue.pop ();
+              uint32_t v = top.second;
+              if (top.first != d[v])
+                {
+                  continue;
+                }
+              for (uint32_t j = 0; j < in[v].size (); j++)
+                {
+                  uint32_t u = in[v][j].first;
+                  uint32_t distance = d[v] + in[v][j].second;
+                  if (distance < d[u])
+                    {
+                      d[u] = distance;
+                      queue.push (Entry (distance, u));
+                    }
+                }
+            }
+        }
+      const std::vector<uint32_t> &du = distances[removedEdges[e].u];
+      const std::vector<uint32_t> &dv = distances[removedEdges[e].v];
+      for (uint32_t i = 0; i < roots.size (); i++)
+        {
+          uint32_t r = rootVertex[i];
+          if (!affected[i] && du[r] != SPF_INFINITY && dv[r] != SPF_INFINITY
+              && du[r] + removedEdges[e].metric == dv[r])
+            {
+              affected[i] = true;
+            }
+        }
+    }
+  return true;
+}
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -958,9 +1519,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
-// must reorder the priority queue keyed to that cost.
+// must move it in the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +1808,22 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  SPFRoot spfRoot;
+  spfRoot.routerId = root;
+  spfRoot.nodeId = 0;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          spfRoot.nodeId = (*i)->GetId ();
+          spfRoot.ipv4 = (*i)->GetObject<Ipv4> ();
+          spfRoot.routing = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  SPFCalculate (spfRoot);
 }
 
 //
@@ -1320,9 +1896,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+                  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
                   NS_ASSERT (gr);
                   gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1339,9 +1913,14 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (const SPFRoot &spfRoot)
 {
-  NS_LOG_FUNCTION (this << root);
+  NS_LOG_FUNCTION (this << spfRoot.routerId);
+
+  Ipv4Address root = spfRoot.routerId;
+  m_spfrootNodeId = spfRoot.nodeId;
+  m_spfrootIpv4 = spfRoot.ipv4;
+  m_spfrootRouting = spfRoot.routing;
 
   SPFVertex *v;
 //
@@ -1377,10 +1956,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootRouting != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootIpv4 = 0;
+      m_spfrootRouting = 0;
       return;
     }
 
@@ -1502,6 +2084,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootIpv4 = 0;
+  m_spfrootRouting = 0;
 }
 
 void
@@ -1556,62 +2140,30 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routing protocol of the node having the router ID of the root vertex
+// was found when the calculation started.  This is the one we're going to
+// write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No GlobalRouter for router " << m_spfroot->GetVertexId ());
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << m_spfrootNodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2178,30 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1720,69 +2263,28 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+// going to write the actual routing table entries.  Its routing protocol was
+// found from the router ID of the root when the calculation started.
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No GlobalRouter for router " << m_spfroot->GetVertexId ());
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << m_spfrootNodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,46 +2298,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix() on the node at the root
+// of the SPF tree.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
@@ -1844,70 +2336,33 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// We have an IP address <a> and the Ipv4 of the node at the root of the SPF
+// tree, found from its router ID when the calculation started.  The
+// question is what interface index does this address correspond to.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootIpv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
 //
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
+// Couldn't find it.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = m_spfrootIpv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1935,69 +2390,28 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol was
+// found from the router ID of the root when the calculation started.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No GlobalRouter for router " << m_spfroot->GetVertexId ());
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << m_spfrootNodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2420,19 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << m_spfrootNodeId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,46 +2446,34 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 {
@@ -2080,104 +2483,55 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// going to write the actual routing table entries.  Its routing protocol was
+// found from the router ID of the root when the calculation started.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << m_spfroot->GetVertexId ());
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No GlobalRouter for router " << m_spfroot->GetVertexId ());
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << m_spfrootNodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouting;
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << m_spfrootNodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -26,6 +26,8 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,6 +39,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -674,12 +677,31 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the Link State Advertisements other than the External ones.
+   *
+   * @see GlobalRoutingLSA
+   * @returns the LSAs, ordered by link state ID.
+   */
+  std::vector<GlobalRoutingLSA*> GetLSAs () const;
+
+  /**
+   * @brief Make a deep copy of the database.
+   *
+   * The copy can be used to run SPF calculations concurrently with the
+   * calculations using this database, since these calculations update
+   * the status of the LSAs.
+   *
+   * @returns a new database holding copies of the LSAs of this database.
+   */
+  GlobalRouteManagerLSDB* Copy () const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  std::unordered_map<uint32_t, GlobalRoutingLSA*> m_linkDataIndex; //!< LSAs indexed by the link data of their TransitNetwork records
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -735,6 +757,19 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after changes in the topology.
+ *
+ * The routing database is rebuilt and compared with the one the current
+ * routes were computed from.  When the changes only remove links or
+ * networks, the SPF calculation is only run again for the routers whose
+ * shortest path tree may have changed; the other routers only lose their
+ * routes to the removed addresses and networks.  Any other change makes
+ * all the routes to be recomputed, like DeleteGlobalRoutes,
+ * BuildGlobalRoutingDatabase and InitializeRoutes do.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +801,70 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /// A router whose routes are computed by a SPF calculation
+  struct SPFRoot
+  {
+    Ipv4Address routerId;          //!< the router ID
+    uint32_t nodeId;               //!< the ID of the node of the router
+    Ptr<Ipv4> ipv4;                //!< the Ipv4 of the node
+    Ptr<Ipv4GlobalRouting> routing; //!< the routing protocol receiving the routes
+  };
+
+  /// Routers waiting for their SPF calculation, shared by the SPF threads
+  struct SPFWork;
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  uint32_t m_spfrootNodeId; //!< the ID of the node of the root
+  Ptr<Ipv4> m_spfrootIpv4; //!< the Ipv4 of the node of the root
+  Ptr<Ipv4GlobalRouting> m_spfrootRouting; //!< the routing protocol of the root
+  SPFWork* m_spfWork; //!< the work shared with the other SPF threads
+
+  /**
+   * \brief Get the routers which are SPF roots in this (possibly distributed)
+   * simulation.
+   * \returns the routers
+   */
+  std::vector<SPFRoot> GetSPFRoots () const;
+
+  /**
+   * \brief Run the SPF calculation of a set of routers.
+   *
+   * The calculations are spread over the number of threads given by the
+   * "GlobalRoutingSpfThreads" global value, or run in the calling thread
+   * when a log component is enabled.
+   *
+   * \param roots the routers
+   */
+  void SPFCalculateAll (const std::vector<SPFRoot> &roots);
+
+  /**
+   * \brief Run the SPF calculations of m_spfWork until there is none left.
+   */
+  void SPFThread ();
+
+  /**
+   * \brief Find the routers whose routes must be recomputed after a change
+   * of the routing database.
+   *
+   * \param old the previous routing database
+   * \param roots the routers
+   * \param affected [out] for each router, whether its SPF calculation must
+   *        be run again
+   * \param removed [out] the addresses and networks (address and mask) to
+   *        which the other routers must delete their routes
+   * \returns false if all the routes must be recomputed
+   */
+  bool FindAffectedRoots (GlobalRouteManagerLSDB* old,
+                          const std::vector<SPFRoot> &roots,
+                          std::vector<bool> &affected,
+                          std::vector<std::pair<Ipv4Address, Ipv4Mask> > &removed) const;
+
+  /**
+   * \brief Delete all the routes of a router.
+   * \param routing the routing protocol of the router
+   */
+  static void DeleteRoutes (Ptr<Ipv4GlobalRouting> routing);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -787,7 +884,7 @@ private:
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (const SPFRoot &root);
 
   /**
    * \brief Process Stub nodes
@@ -65,6 +65,17 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routing database and the routes after a change of the
+ * topology.
+ *
+ * When links or networks were only removed, the SPF computation only runs
+ * again for the routers whose shortest paths used them.  Otherwise, this is
+ * equivalent to calling DeleteGlobalRoutes, BuildGlobalRoutingDatabase and
+ * InitializeRoutes.
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
@@ -29,17 +30,141 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
 
+bool
+Ipv4EndPointDemux::Key::operator== (const Key &other) const
+{
+  return localAddress == other.localAddress && localPort == other.localPort
+         && peerAddress == other.peerAddress && peerPort == other.peerPort
+         && device == other.device;
+}
+
+size_t
+Ipv4EndPointDemux::KeyHash::operator() (const Key &key) const
+{
+  size_t hash = Ipv4AddressHash () (key.localAddress);
+  hash = hash * 31 + key.localPort;
+  hash = hash * 31 + Ipv4AddressHash () (key.peerAddress);
+  hash = hash * 31 + key.peerPort;
+  hash = hash * 31 + reinterpret_cast<size_t> (key.device);
+  return hash;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position position;
+  position.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  position.sequence = m_sequence++;
+  m_positions[endPoint] = position;
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.peerPort = endPoint->GetPeerPort ();
+  key.device = 0;
+  if (key.peerAddress != Ipv4Address::GetAny () && key.peerPort != 0)
+    {
+      m_connected[key].push_back (endPoint);
+    }
+  else
+    {
+      m_unconnected[key.localPort].push_back (endPoint);
+    }
+  key.peerAddress = Ipv4Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (endPoint->GetBoundNetDevice ());
+  m_bindings[key]++;
+  m_ports[key.localPort]++;
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.peerPort = endPoint->GetPeerPort ();
+  key.device = 0;
+  if (key.peerAddress != Ipv4Address::GetAny () && key.peerPort != 0)
+    {
+      std::unordered_map<Key, EndPointVector, KeyHash>::iterator i = m_connected.find (key);
+      NS_ASSERT (i != m_connected.end ());
+      i->second.erase (std::find (i->second.begin (), i->second.end (), endPoint));
+      if (i->second.empty ())
+        {
+          m_connected.erase (i);
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::iterator i = m_unconnected.find (key.localPort);
+      NS_ASSERT (i != m_unconnected.end ());
+      i->second.erase (std::find (i->second.begin (), i->second.end (), endPoint));
+      if (i->second.empty ())
+        {
+          m_unconnected.erase (i);
+        }
+    }
+  key.peerAddress = Ipv4Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (endPoint->GetBoundNetDevice ());
+  std::unordered_map<Key, uint32_t, KeyHash>::iterator binding = m_bindings.find (key);
+  NS_ASSERT (binding != m_bindings.end ());
+  if (--binding->second == 0)
+    {
+      m_bindings.erase (binding);
+    }
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_ports.find (key.localPort);
+  NS_ASSERT (port != m_ports.end ());
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
+    }
+}
+
+void
+Ipv4EndPointDemux::GetConnected (Ipv4Address localAddress, uint16_t localPort,
+                                 Ipv4Address peerAddress, uint16_t peerPort,
+                                 std::vector<Ipv4EndPoint *> &endPoints) const
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  key.device = 0;
+  std::unordered_map<Key, EndPointVector, KeyHash>::const_iterator i = m_connected.find (key);
+  if (i != m_connected.end ())
+    {
+      endPoints.insert (endPoints.end (), i->second.begin (), i->second.end ());
+    }
+}
+
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
@@ -49,30 +174,20 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
-        {
-          return true;
-        }
-    }
-  return false;
+  Key key;
+  key.localAddress = addr;
+  key.localPort = port;
+  key.peerAddress = Ipv4Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (boundNetDevice);
+  return m_bindings.find (key) != m_bindings.end ();
 }
 
 Ipv4EndPoint *
@@ -85,10 +200,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -101,10 +213,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -124,10 +233,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -136,7 +242,20 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointVector sameTuple;
+  if (peerAddress != Ipv4Address::GetAny () && peerPort != 0)
+    {
+      GetConnected (localAddress, localPort, peerAddress, peerPort, sameTuple);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::const_iterator i = m_unconnected.find (localPort);
+      if (i != m_unconnected.end ())
+        {
+          sameTuple = i->second;
+        }
+    }
+  for (EndPointVector::iterator i = sameTuple.begin (); i != sameTuple.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -150,25 +269,21 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  if (i != m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (i->second.position);
+      m_positions.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -208,7 +323,35 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  // Only the end points on the destination port, which either have no peer
+  // or have the source as peer and a local address which may match, can
+  // match.  The ones with a peer are found from their four-tuple.
+  EndPointVector candidates;
+  std::unordered_map<uint16_t, EndPointVector>::const_iterator unconnected = m_unconnected.find (dport);
+  if (unconnected != m_unconnected.end ())
+    {
+      candidates = unconnected->second;
+    }
+  GetConnected (daddr, dport, saddr, sport, candidates);
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      GetConnected (Ipv4Address::GetAny (), dport, saddr, sport, candidates);
+    }
+  std::vector<Ipv4Address> netparts;
+  for (uint32_t i = 0; incomingInterface && i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+      if (addrNetpart != daddr && addrNetpart != Ipv4Address::GetAny ()
+          && std::find (netparts.begin (), netparts.end (), addrNetpart) == netparts.end ())
+        {
+          netparts.push_back (addrNetpart);
+          GetConnected (addrNetpart, dport, saddr, sport, candidates);
+        }
+    }
+
+  for (EndPointVector::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -343,6 +486,42 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  // An exact match is found from the indexes.  If there are several, the
+  // first one allocated is returned.
+  EndPointVector exact;
+  if (saddr != Ipv4Address::GetAny () && sport != 0)
+    {
+      GetConnected (daddr, dport, saddr, sport, exact);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::const_iterator i = m_unconnected.find (dport);
+      if (i != m_unconnected.end ())
+        {
+          for (EndPointVector::const_iterator j = i->second.begin (); j != i->second.end (); j++)
+            {
+              if ((*j)->GetLocalAddress () == daddr &&
+                  (*j)->GetPeerPort () == sport &&
+                  (*j)->GetPeerAddress () == saddr)
+                {
+                  exact.push_back (*j);
+                }
+            }
+        }
+    }
+  Ipv4EndPoint *first = 0;
+  for (EndPointVector::const_iterator i = exact.begin (); i != exact.end (); i++)
+    {
+      if (first == 0 || m_positions[*i].sequence < m_positions[first].sequence)
+        {
+          first = *i;
+        }
+    }
+  if (first != 0)
+    {
+      return first;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
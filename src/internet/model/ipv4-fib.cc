@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ipv4-fib.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4Fib");
+
+Ipv4Fib::Ipv4Fib ()
+  : m_nRoutes (0),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4Fib::MaskTable &
+Ipv4Fib::GetTable (uint32_t mask)
+{
+  std::vector<MaskTable>::iterator i = m_tables.begin ();
+  while (i != m_tables.end () && i->mask > mask)
+    {
+      i++;
+    }
+  if (i == m_tables.end () || i->mask != mask)
+    {
+      MaskTable table;
+      table.mask = mask;
+      table.nRoutes = 0;
+      i = m_tables.insert (i, table);
+    }
+  return *i;
+}
+
+void
+Ipv4Fib::Add (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  MaskTable &table = GetTable (mask);
+  table.prefixes[route->GetDestNetwork ().Get () & mask].push_back (std::make_pair (route, metric));
+  table.nRoutes++;
+  m_nRoutes++;
+  m_generation++;
+}
+
+void
+Ipv4Fib::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  for (std::vector<MaskTable>::iterator i = m_tables.begin (); i != m_tables.end (); i++)
+    {
+      if (i->mask != mask)
+        {
+          continue;
+        }
+      std::unordered_map<uint32_t, Routes>::iterator prefix =
+        i->prefixes.find (route->GetDestNetwork ().Get () & mask);
+      NS_ASSERT_MSG (prefix != i->prefixes.end (), "Route not found");
+      for (Routes::iterator j = prefix->second.begin (); j != prefix->second.end (); j++)
+        {
+          if (j->first == route)
+            {
+              prefix->second.erase (j);
+              if (prefix->second.empty ())
+                {
+                  i->prefixes.erase (prefix);
+                }
+              m_nRoutes--;
+              m_generation++;
+              if (--i->nRoutes == 0)
+                {
+                  m_tables.erase (i);
+                }
+              return;
+            }
+        }
+      break;
+    }
+  NS_ASSERT_MSG (false, "Route not found");
+}
+
+void
+Ipv4Fib::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tables.clear ();
+  m_nRoutes = 0;
+  m_generation++;
+}
+
+uint32_t
+Ipv4Fib::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+uint32_t
+Ipv4Fib::GetGeneration (void) const
+{
+  return m_generation;
+}
+
+Ipv4Fib::Routes const *
+Ipv4Fib::Lookup (Ipv4Address dest, int32_t interface) const
+{
+  NS_LOG_FUNCTION (this << dest << interface);
+  uint32_t address = dest.Get ();
+  for (std::vector<MaskTable>::const_iterator i = m_tables.begin (); i != m_tables.end (); i++)
+    {
+      std::unordered_map<uint32_t, Routes>::const_iterator prefix = i->prefixes.find (address & i->mask);
+      if (prefix == i->prefixes.end ())
+        {
+          continue;
+        }
+      if (interface < 0)
+        {
+          return &prefix->second;
+        }
+      for (Routes::const_iterator j = prefix->second.begin (); j != prefix->second.end (); j++)
+        {
+          if (j->first->GetInterface () == static_cast<uint32_t> (interface))
+            {
+              return &prefix->second;
+            }
+        }
+      NS_LOG_LOGIC ("No route through interface " << interface << " to " << Ipv4Address (address & i->mask)
+                    << "/" << Ipv4Mask (i->mask).GetPrefixLength ());
+    }
+  return 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_FIB_H
+#define IPV4_FIB_H
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Longest prefix match index over unicast routing table entries.
+ *
+ * The routing protocols keep their routes in lists, which define the
+ * order in which the routes are printed and indexed. This index, kept in
+ * sync with such a list, finds the routes of the longest prefix matching
+ * a destination without scanning the list.
+ *
+ * The routes are stored in one hash table per network mask, keyed by the
+ * network address, and the tables are probed from the longest mask to the
+ * shortest. A lookup thus costs at most one hash probe per distinct mask
+ * in use (33 for prefix masks), whatever the number of routes. Routes
+ * with the same network and mask form an equal-cost multipath set, kept
+ * in insertion order.
+ *
+ * The index does not own the routes.
+ */
+class Ipv4Fib
+{
+public:
+  /// A route and its metric
+  typedef std::pair<Ipv4RoutingTableEntry *, uint32_t> Route;
+  /// Routes to a prefix, in insertion order
+  typedef std::vector<Route> Routes;
+
+  Ipv4Fib ();
+
+  /**
+   * \brief Add a route.
+   * \param route the route
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+
+  /**
+   * \brief Remove a route.
+   * \param route the route, which must have been added and not modified since
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+
+  /**
+   * \returns the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \returns a counter incremented on each change of the routes
+   */
+  uint32_t GetGeneration (void) const;
+
+  /**
+   * \brief Find the routes of the longest prefix matching a destination.
+   *
+   * \param dest the destination
+   * \param interface if not negative, ignore the prefixes with no route
+   *        through this interface. The returned set may still contain
+   *        routes through other interfaces.
+   * \returns the routes, or 0 if no prefix matches
+   */
+  Routes const *Lookup (Ipv4Address dest, int32_t interface = -1) const;
+
+private:
+  /// Routes with a given network mask
+  struct MaskTable
+  {
+    uint32_t mask;     //!< the network mask
+    uint32_t nRoutes;  //!< the number of routes in the table
+    std::unordered_map<uint32_t, Routes> prefixes; //!< routes indexed by network address
+  };
+
+  /**
+   * \param mask a network mask
+   * \returns the table of this mask, created if needed
+   */
+  MaskTable &GetTable (uint32_t mask);
+
+  std::vector<MaskTable> m_tables; //!< tables sorted by decreasing mask
+  uint32_t m_nRoutes;              //!< the number of routes
+  uint32_t m_generation;           //!< the number of changes of the routes
+};
+
+} // namespace ns3
+
+#endif /* IPV4_FIB_H */
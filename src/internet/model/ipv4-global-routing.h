@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <utility>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-fib.h"
 
 namespace ns3 {
 
@@ -99,6 +102,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual int64_t GetGeneration (void) const;
 
   /**
    * \brief Add a host route to the global routing table.
@@ -218,6 +222,16 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove the host and network routes to a set of destinations.
+   *
+   * The AS external routes are kept.
+   *
+   * \param destinations the destinations, as network addresses and masks.
+   * A host route matches a destination with a 255.255.255.255 mask.
+   */
+  void RemoveRoutesTo (const std::vector<std::pair<Ipv4Address, Ipv4Mask> > &destinations);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -271,6 +285,9 @@ private:
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ipv4Fib m_hostFib;                   //!< Index of the routes to hosts
+  Ipv4Fib m_networkFib;                //!< Index of the routes to networks
+  Ipv4Fib m_ASexternalFib;             //!< Index of the external routes
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
@@ -473,4 +473,109 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Ipv4HeaderView::Ipv4HeaderView (Ptr<const Packet> packet)
+  : HeaderView<Ipv4Header> (packet, 20)
+{
+}
+
+uint16_t
+Ipv4HeaderView::GetPayloadSize (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (2) - GetSerializedSize ();
+    }
+  return GetHeader ().GetPayloadSize ();
+}
+
+uint16_t
+Ipv4HeaderView::GetIdentification (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (4);
+    }
+  return GetHeader ().GetIdentification ();
+}
+
+uint8_t
+Ipv4HeaderView::GetTos (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (1);
+    }
+  return GetHeader ().GetTos ();
+}
+
+bool
+Ipv4HeaderView::IsLastFragment (void) const
+{
+  if (IsDirect ())
+    {
+      return !(ReadU8 (6) & (1<<5));
+    }
+  return GetHeader ().IsLastFragment ();
+}
+
+uint16_t
+Ipv4HeaderView::GetFragmentOffset (void) const
+{
+  if (IsDirect ())
+    {
+      return (ReadNtohU16 (6) & 0x1fff) << 3;
+    }
+  return GetHeader ().GetFragmentOffset ();
+}
+
+uint8_t
+Ipv4HeaderView::GetTtl (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (8);
+    }
+  return GetHeader ().GetTtl ();
+}
+
+uint8_t
+Ipv4HeaderView::GetProtocol (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (9);
+    }
+  return GetHeader ().GetProtocol ();
+}
+
+Ipv4Address
+Ipv4HeaderView::GetSource (void) const
+{
+  if (IsDirect ())
+    {
+      return Ipv4Address (ReadNtohU32 (12));
+    }
+  return GetHeader ().GetSource ();
+}
+
+Ipv4Address
+Ipv4HeaderView::GetDestination (void) const
+{
+  if (IsDirect ())
+    {
+      return Ipv4Address (ReadNtohU32 (16));
+    }
+  return GetHeader ().GetDestination ();
+}
+
+uint32_t
+Ipv4HeaderView::GetSerializedSize (void) const
+{
+  if (IsDirect ())
+    {
+      return (ReadU8 (0) & 0x0f) * 4;
+    }
+  return GetHeader ().GetSerializedSize ();
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define IPV4_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -259,6 +260,60 @@ private:
   uint16_t m_headerSize; //!< IP header size
 };
 
+/**
+ * \ingroup ipv4
+ *
+ * \brief Read-only view of an Ipv4Header stored at the start of a packet.
+ */
+class Ipv4HeaderView : public HeaderView<Ipv4Header>
+{
+public:
+  /**
+   * \param packet the packet which starts with the IPv4 header
+   */
+  Ipv4HeaderView (Ptr<const Packet> packet);
+  /**
+   * \returns the size of the payload in bytes
+   */
+  uint16_t GetPayloadSize (void) const;
+  /**
+   * \returns the identification field of this packet.
+   */
+  uint16_t GetIdentification (void) const;
+  /**
+   * \returns the TOS field of this packet.
+   */
+  uint8_t GetTos (void) const;
+  /**
+   * \returns true if this is the last fragment of a packet, false otherwise.
+   */
+  bool IsLastFragment (void) const;
+  /**
+   * \returns the offset of this fragment measured in bytes from the start.
+   */
+  uint16_t GetFragmentOffset (void) const;
+  /**
+   * \returns the TTL field of this packet
+   */
+  uint8_t GetTtl (void) const;
+  /**
+   * \returns the protocol field of this packet
+   */
+  uint8_t GetProtocol (void) const;
+  /**
+   * \returns the source address of this packet
+   */
+  Ipv4Address GetSource (void) const;
+  /**
+   * \returns the destination address of this packet
+   */
+  Ipv4Address GetDestination (void) const;
+  /**
+   * \returns the size of the header (including options) in bytes
+   */
+  uint32_t GetSerializedSize (void) const;
+};
+
 } // namespace ns3
 
 
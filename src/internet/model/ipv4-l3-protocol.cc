@@ -31,8 +31,10 @@
 #include "ns3/object-vector.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -69,6 +71,21 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("IdentificationMode",
+                   "How the identification of the sent packets is chosen. "
+                   "The counters of the PerTuple and PerSource modes are "
+                   "removed once idle for longer than FragmentExpirationTimeout, "
+                   "while the Hashed mode uses a fixed table of counters.",
+                   EnumValue (ID_PER_TUPLE),
+                   MakeEnumAccessor (&Ipv4L3Protocol::m_identificationMode),
+                   MakeEnumChecker (ID_PER_TUPLE, "PerTuple",
+                                    ID_PER_SOURCE, "PerSource",
+                                    ID_HASHED, "Hashed"))
+    .AddAttribute ("IdentificationTableSize",
+                   "The number of identification counters of the Hashed mode.",
+                   UintegerValue (2048),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_identificationTableSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -81,6 +98,14 @@ Ipv4L3Protocol::GetTypeId (void)
                      "Drop ipv4 packet",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_dropTrace),
                      "ns3::Ipv4L3Protocol::DropTracedCallback")
+    .AddAttribute ("FlowCacheSize",
+                   "The maximum number of flows whose forwarding route is cached, "
+                   "0 to disable the cache. The cache is only used with routing "
+                   "protocols which track their changes (see "
+                   "Ipv4RoutingProtocol::GetGeneration).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_flowCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("InterfaceList",
                    "The set of Ipv4 interfaces associated to this Ipv4 stack.",
                    ObjectVectorValue (),
@@ -108,6 +133,9 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_flowCacheGeneration (-1),
+    m_flowCacheHits (0),
+    m_flowCacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -271,6 +299,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  FlushFlowCache ();
 }
 
 
@@ -301,22 +330,21 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  m_flowCache.clear ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
       it->second = 0;
     }
 
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
+  m_timeoutEventList.clear ();
+  if (m_timeoutEvent.IsRunning ())
     {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
+      m_timeoutEvent.Cancel ();
     }
 
   m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_identification.clear ();
 
   Object::DoDispose ();
 }
@@ -399,6 +427,7 @@ Ipv4L3Protocol::AddIpv4Interface (Ptr<Ipv4Interface>interface)
   uint32_t index = m_interfaces.size ();
   m_interfaces.push_back (interface);
   m_reverseInterfacesContainer[interface->GetDevice ()] = index;
+  FlushFlowCache ();
   return index;
 }
 
@@ -631,8 +660,35 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  if (m_flowCacheSize > 0)
+    {
+      int64_t generation = m_routingProtocol->GetGeneration ();
+      if (generation >= 0)
+        {
+          if (generation != m_flowCacheGeneration)
+            {
+              FlushFlowCache ();
+              m_flowCacheGeneration = generation;
+            }
+          FlowKey key;
+          key.source = ipHeader.GetSource ().Get ();
+          key.destination = ipHeader.GetDestination ().Get ();
+          key.iif = interface;
+          key.tos = ipHeader.GetTos ();
+          std::unordered_map<FlowKey, Ptr<Ipv4Route>, FlowKeyHash>::const_iterator it = m_flowCache.find (key);
+          if (it != m_flowCache.end ())
+            {
+              NS_LOG_LOGIC ("Flow cache hit: forwarding to " << it->second->GetGateway ());
+              m_flowCacheHits++;
+              IpForward (it->second, packet, ipHeader);
+              return;
+            }
+          m_flowCacheMisses++;
+          ucb = MakeCallback (&Ipv4L3Protocol::IpForwardAndCache, this).Bind (key);
+        }
+    }
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, ucb,
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
@@ -860,6 +916,51 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
 // \todo when should we set ip_id?   check whether we are incrementing
 // m_identification on packets that may later be dropped in this stack
 // and whether that deviates from Linux
+uint16_t
+Ipv4L3Protocol::GetNextIdentification (Ipv4Address source, Ipv4Address destination, uint8_t protocol)
+{
+  NS_LOG_FUNCTION (this << source << destination << (uint16_t)protocol);
+  uint64_t src = source.Get ();
+  uint64_t dst = destination.Get ();
+  std::pair<uint64_t, uint32_t> key = std::make_pair (dst | (src << 32), protocol);
+
+  if (m_identificationMode == ID_HASHED)
+    {
+      if (m_identificationTable.size () != m_identificationTableSize)
+        {
+          m_identificationTable.assign (m_identificationTableSize, 0);
+        }
+      return m_identificationTable[FragmentKeyHash () (key) % m_identificationTableSize]++;
+    }
+
+  if (m_identificationMode == ID_PER_SOURCE)
+    {
+      key = std::make_pair (src << 32, 0);
+    }
+  Time now = Simulator::Now ();
+  if (now >= m_identificationPurgeTime)
+    {
+      // A counter idle for longer than the reassembly timeout can restart
+      // from 0: the previous packets with the same identification are gone.
+      for (std::unordered_map<std::pair<uint64_t, uint32_t>, std::pair<uint16_t, Time>, FragmentKeyHash>::iterator it = m_identification.begin ();
+           it != m_identification.end (); )
+        {
+          if (it->second.second + m_fragmentExpirationTimeout < now)
+            {
+              it = m_identification.erase (it);
+            }
+          else
+            {
+              it++;
+            }
+        }
+      m_identificationPurgeTime = now + m_fragmentExpirationTimeout;
+    }
+  std::pair<uint16_t, Time> &counter = m_identification[key];
+  counter.second = now;
+  return counter.first++;
+}
+
 Ipv4Header
 Ipv4L3Protocol::BuildHeader (
   Ipv4Address source,
@@ -879,16 +980,10 @@ Ipv4L3Protocol::BuildHeader (
   ipHeader.SetTtl (ttl);
   ipHeader.SetTos (tos);
 
-  uint64_t src = source.Get ();
-  uint64_t dst = destination.Get ();
-  uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
-
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (GetNextIdentification (source, destination, protocol));
     }
   else
     {
@@ -897,8 +992,7 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (GetNextIdentification (source, destination, protocol));
     }
   if (Node::ChecksumEnabled ())
     {
@@ -925,12 +1019,16 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // super-segments are sent as a whole to the device, which serializes them
+  SegmentOffloadTag offloadTag;
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+              && !packet->PeekPacketTag (offloadTag))
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +1055,8 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+              && !packet->PeekPacketTag (offloadTag))
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -1057,6 +1156,59 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+bool
+Ipv4L3Protocol::FlowKey::operator== (const FlowKey &other) const
+{
+  return source == other.source && destination == other.destination
+         && iif == other.iif && tos == other.tos;
+}
+
+bool
+Ipv4L3Protocol::FlowKey::operator!= (const FlowKey &other) const
+{
+  return !(*this == other);
+}
+
+std::size_t
+Ipv4L3Protocol::FlowKeyHash::operator() (const FlowKey &key) const
+{
+  uint64_t addresses = (static_cast<uint64_t> (key.source) << 32) | key.destination;
+  return std::hash<uint64_t> () (addresses) ^ (key.iif << 8 | key.tos) * 0x9e3779b1U;
+}
+
+void
+Ipv4L3Protocol::IpForwardAndCache (FlowKey key, Ptr<Ipv4Route> rtentry,
+                                   Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  if (m_flowCache.size () >= m_flowCacheSize)
+    {
+      // evict an arbitrary flow
+      m_flowCache.erase (m_flowCache.begin ());
+    }
+  m_flowCache[key] = rtentry;
+  IpForward (rtentry, p, header);
+}
+
+void
+Ipv4L3Protocol::FlushFlowCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowCache.clear ();
+}
+
+uint64_t
+Ipv4L3Protocol::GetFlowCacheHits (void) const
+{
+  return m_flowCacheHits;
+}
+
+uint64_t
+Ipv4L3Protocol::GetFlowCacheMisses (void) const
+{
+  return m_flowCacheMisses;
+}
+
 void
 Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uint32_t iif)
 {
@@ -1126,6 +1278,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  FlushFlowCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1157,6 +1310,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      FlushFlowCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1180,6 +1334,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      FlushFlowCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1314,6 +1469,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      FlushFlowCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1332,6 +1488,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  FlushFlowCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1354,6 +1511,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushFlowCache ();
 }
 
 Ptr<NetDevice>
@@ -1372,6 +1530,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  FlushFlowCache ();
 }
 
 bool 
@@ -1386,6 +1545,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  FlushFlowCache ();
 }
 
 bool 
@@ -1496,7 +1656,7 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 
   uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 | uint64_t (ipHeader.GetDestination ().Get ());
   uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 | uint32_t (ipHeader.GetProtocol ());
-  std::pair<uint64_t, uint32_t> key;
+  FragmentKey_t key;
   bool ret = false;
   Ptr<Packet> p = packet->Copy ();
 
@@ -1510,9 +1670,7 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
     {
       fragments = Create<Fragments> ();
       m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
+      fragments->SetTimeoutIter (SetTimeout (key, ipHeader, iif));
     }
   else
     {
@@ -1526,14 +1684,14 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
+      m_timeoutEventList.erase (fragments->GetTimeoutIter ());
       fragments = 0;
       m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
+      if (m_timeoutEventList.empty ())
         {
           NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
+          m_timeoutEvent.Cancel ();
         }
-      m_fragmentsTimers.erase (key);
       ret = true;
     }
 
@@ -1574,6 +1732,18 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
   m_fragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
 }
 
+void
+Ipv4L3Protocol::Fragments::SetTimeoutIter (FragmentsTimeoutsListI_t iter)
+{
+  m_timeoutIter = iter;
+}
+
+Ipv4L3Protocol::FragmentsTimeoutsListI_t
+Ipv4L3Protocol::Fragments::GetTimeoutIter (void) const
+{
+  return m_timeoutIter;
+}
+
 bool
 Ipv4L3Protocol::Fragments::IsEntire () const
 {
@@ -1697,6 +1867,45 @@ Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4H
   it->second = 0;
 
   m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
+}
+
+std::size_t
+Ipv4L3Protocol::FragmentKeyHash::operator() (const std::pair<uint64_t, uint32_t> &key) const
+{
+  return std::hash<uint64_t> () (key.first) ^ key.second * 0x9e3779b1U;
+}
+
+Ipv4L3Protocol::FragmentsTimeoutsListI_t
+Ipv4L3Protocol::SetTimeout (FragmentKey_t key, Ipv4Header ipHeader, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << ipHeader << iif);
+  // all the fragments have the same timeout: the list is sorted by
+  // expiration time, and a single event expires its head
+  if (m_timeoutEventList.empty ())
+    {
+      m_timeoutEvent = Simulator::Schedule (m_fragmentExpirationTimeout, &Ipv4L3Protocol::HandleTimeout, this);
+    }
+  m_timeoutEventList.push_back (std::make_tuple (Simulator::Now () + m_fragmentExpirationTimeout, key, ipHeader, iif));
+  FragmentsTimeoutsListI_t iter = m_timeoutEventList.end ();
+  return --iter;
+}
+
+void
+Ipv4L3Protocol::HandleTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  while (!m_timeoutEventList.empty () && std::get<0> (m_timeoutEventList.front ()) <= now)
+    {
+      HandleFragmentsTimeout (std::get<1> (m_timeoutEventList.front ()),
+                              std::get<2> (m_timeoutEventList.front ()),
+                              std::get<3> (m_timeoutEventList.front ()));
+      m_timeoutEventList.pop_front ();
+    }
+  if (!m_timeoutEventList.empty ())
+    {
+      m_timeoutEvent = Simulator::Schedule (std::get<0> (m_timeoutEventList.front ()) - now,
+                                            &Ipv4L3Protocol::HandleTimeout, this);
+    }
 }
 } // namespace ns3
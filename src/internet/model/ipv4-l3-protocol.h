@@ -24,6 +24,8 @@
 #include <list>
 #include <map>
 #include <vector>
+#include <tuple>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ptr.h"
@@ -104,6 +106,17 @@ public:
     DROP_FRAGMENT_TIMEOUT /**< Fragment timeout exceeded */
   };
 
+  /**
+   * \enum IdentificationMode
+   * \brief How the identification of the sent packets is chosen.
+   */
+  enum IdentificationMode
+  {
+    ID_PER_TUPLE,  /**< One counter per {source, destination, protocol} tuple */
+    ID_PER_SOURCE, /**< One counter per source address, i.e. per interface address */
+    ID_HASHED      /**< A fixed table of counters shared by the tuples with the same hash */
+  };
+
   /**
    * \brief Set node associated with this stack.
    * \param node node to set
@@ -221,6 +234,20 @@ public:
    */
   bool IsUnicast (Ipv4Address ad) const;
 
+  /**
+   * \brief Get the number of packets forwarded through the flow cache.
+   * \returns the number of forwarded packets whose route was found in
+   *          the flow cache
+   */
+  uint64_t GetFlowCacheHits (void) const;
+
+  /**
+   * \brief Get the number of flow cache misses.
+   * \returns the number of received packets routed by the routing
+   *          protocol while the flow cache was in use
+   */
+  uint64_t GetFlowCacheMisses (void) const;
+
   /**
    * TracedCallback signature for packet send, forward, or local deliver events.
    *
@@ -338,6 +365,55 @@ private:
              Ptr<const Packet> p, 
              const Ipv4Header &header);
 
+  /**
+   * \brief A flow of received packets, used as a flow cache key.
+   */
+  struct FlowKey
+  {
+    uint32_t source;      //!< the source address
+    uint32_t destination; //!< the destination address
+    uint32_t iif;         //!< the input interface
+    uint8_t tos;          //!< the TOS
+
+    /**
+     * \param other the other key
+     * \returns true if both keys identify the same flow
+     */
+    bool operator== (const FlowKey &other) const;
+    /**
+     * \param other the other key
+     * \returns true if the keys identify different flows
+     */
+    bool operator!= (const FlowKey &other) const;
+  };
+
+  /**
+   * \brief Hash function of the flow cache keys.
+   */
+  struct FlowKeyHash
+  {
+    /**
+     * \param key a key
+     * \returns the hash of the key
+     */
+    std::size_t operator() (const FlowKey &key) const;
+  };
+
+  /**
+   * \brief Forward a packet and cache its route for the flow.
+   * \param key the flow of the packet
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void IpForwardAndCache (FlowKey key, Ptr<Ipv4Route> rtentry,
+                          Ptr<const Packet> p, const Ipv4Header &header);
+
+  /**
+   * \brief Remove all the entries of the flow cache.
+   */
+  void FlushFlowCache (void);
+
   /**
    * \brief Forward a multicast packet.
    * \param mrtentry route
@@ -422,6 +498,52 @@ private:
    */
   void HandleFragmentsTimeout ( std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif);
 
+  /**
+   * \brief Key identifying the fragments of a packet:
+   * (src+dst addresses, identification+protocol)
+   */
+  typedef std::pair<uint64_t, uint32_t> FragmentKey_t;
+
+  /**
+   * \brief Hash function of the fragment and identification keys.
+   */
+  struct FragmentKeyHash
+  {
+    /**
+     * \param key a key
+     * \returns the hash of the key
+     */
+    std::size_t operator() (const std::pair<uint64_t, uint32_t> &key) const;
+  };
+
+  /// Fragment timeouts, sorted by expiration time: time, key, header, input interface
+  typedef std::list<std::tuple <Time, FragmentKey_t, Ipv4Header, uint32_t> > FragmentsTimeoutsList_t;
+  /// Iterator of the fragment timeouts
+  typedef FragmentsTimeoutsList_t::iterator FragmentsTimeoutsListI_t;
+
+  /**
+   * \brief Register the timeout of the fragments of a packet.
+   * \param key representing the packet fragments
+   * \param ipHeader the IP header of the original packet
+   * \param iif Input Interface
+   * \returns the timeout entry, to remove it if the packet is completed
+   */
+  FragmentsTimeoutsListI_t SetTimeout (FragmentKey_t key, Ipv4Header ipHeader, uint32_t iif);
+
+  /**
+   * \brief Expire the fragments whose timeout has elapsed.
+   */
+  void HandleTimeout (void);
+
+  /**
+   * \brief Get the identification of a new packet.
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the protocol
+   * \returns the identification
+   */
+  uint16_t GetNextIdentification (Ipv4Address source, Ipv4Address destination, uint8_t protocol);
+
   /**
    * \brief Make a copy of the packet, add the header and invoke the TX trace callback
    * \param ipHeader the IP header that will be added to the packet
@@ -463,7 +585,12 @@ private:
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   Ipv4InterfaceReverseContainer m_reverseInterfacesContainer; //!< Container of NetDevice / Interface index associations.
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  IdentificationMode m_identificationMode; //!< How the identification is chosen
+  /// Identification counters (for each tuple or source), and when they were last used
+  std::unordered_map<std::pair<uint64_t, uint32_t>, std::pair<uint16_t, Time>, FragmentKeyHash> m_identification;
+  Time m_identificationPurgeTime; //!< Next removal of the idle identification counters
+  uint32_t m_identificationTableSize;      //!< Number of counters in ID_HASHED mode
+  std::vector<uint16_t> m_identificationTable; //!< Identification counters in ID_HASHED mode
   Ptr<Node> m_node; //!< Node attached to stack.
 
   /// Trace of sent packets
@@ -492,6 +619,12 @@ private:
 
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
+  uint32_t m_flowCacheSize; //!< Maximum number of flows in the flow cache, 0 to disable it
+  std::unordered_map<FlowKey, Ptr<Ipv4Route>, FlowKeyHash> m_flowCache; //!< Routes of the forwarded flows
+  int64_t m_flowCacheGeneration; //!< Routing protocol generation of the cached routes
+  uint64_t m_flowCacheHits;      //!< Number of flow cache hits
+  uint64_t m_flowCacheMisses;    //!< Number of flow cache misses
+
   /**
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
    */
@@ -534,6 +667,18 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Set the timeout entry of the fragments.
+     * \param iter the timeout entry
+     */
+    void SetTimeoutIter (FragmentsTimeoutsListI_t iter);
+
+    /**
+     * \brief Get the timeout entry of the fragments.
+     * \returns the timeout entry
+     */
+    FragmentsTimeoutsListI_t GetTimeoutIter (void) const;
+
 private:
     /**
      * \brief True if other fragments will be sent.
@@ -545,16 +690,19 @@ private:
      */
     std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
 
+    /**
+     * \brief The timeout entry of the fragments.
+     */
+    FragmentsTimeoutsListI_t m_timeoutIter;
   };
 
-  /// Container of fragments, stored as pairs(src+dst addr, src+dst port) / fragment
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  /// Container of fragment timeout event, stored as pairs(src+dst addr, src+dst port) / EventId
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  /// Container of fragments, stored as pairs(src+dst addr, identification+proto) / fragment
+  typedef std::unordered_map<FragmentKey_t, Ptr<Fragments>, FragmentKeyHash> MapFragments_t;
 
   MapFragments_t       m_fragments; //!< Fragmented packets.
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
-  MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
+  FragmentsTimeoutsList_t m_timeoutEventList; //!< Timeouts of the fragmented packets
+  EventId              m_timeoutEvent; //!< Event of the first fragment timeout
 
 };
 
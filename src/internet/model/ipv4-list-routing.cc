@@ -43,7 +43,8 @@ Ipv4ListRouting::GetTypeId (void)
 
 
 Ipv4ListRouting::Ipv4ListRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_generation (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -69,6 +70,25 @@ Ipv4ListRouting::DoDispose (void)
   m_ipv4 = 0;
 }
 
+int64_t
+Ipv4ListRouting::GetGeneration (void) const
+{
+  // the generations of the protocols only increase: their sum changes
+  // whenever one of them does
+  int64_t generation = m_generation;
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      int64_t protocolGeneration = i->second->GetGeneration ();
+      if (protocolGeneration < 0)
+        {
+          return -1;
+        }
+      generation += protocolGeneration;
+    }
+  return generation;
+}
+
 void
 Ipv4ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
 {
@@ -255,6 +275,7 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  m_generation++;
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
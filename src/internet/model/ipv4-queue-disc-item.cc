@@ -121,20 +121,18 @@ Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
   uint8_t prot = m_header.GetProtocol ();
   uint16_t fragOffset = m_header.GetFragmentOffset ();
 
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
   uint16_t srcPort = 0;
   uint16_t destPort = 0;
 
   if (prot == 6 && fragOffset == 0) // TCP
     {
-      GetPacket ()->PeekHeader (tcpHdr);
+      TcpHeaderView tcpHdr (GetPacket ());
       srcPort = tcpHdr.GetSourcePort ();
       destPort = tcpHdr.GetDestinationPort ();
     }
   else if (prot == 17 && fragOffset == 0) // UDP
     {
-      GetPacket ()->PeekHeader (udpHdr);
+      UdpHeaderView udpHdr (GetPacket ());
       srcPort = udpHdr.GetSourcePort ();
       destPort = udpHdr.GetDestinationPort ();
     }
@@ -36,4 +36,10 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+int64_t
+Ipv4RoutingProtocol::GetGeneration (void) const
+{
+  return -1;
+}
+
 } // namespace ns3
@@ -171,6 +171,21 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the generation of the forwarding decisions
+   *
+   * A protocol whose RouteInput () forwards all the unicast packets of a
+   * flow (source, destination, TOS and input interface) through the same
+   * route, as long as its routes do not change, can return a counter
+   * incremented on each such change. Ipv4L3Protocol may then cache its
+   * forwarding decisions, and reuse the route objects it passed to the
+   * UnicastForwardCallback, until the generation changes. The changes of
+   * the interfaces and addresses of the node flush the cache.
+   *
+   * \returns the generation, or -1 if the forwarding decisions must not be
+   *          cached, which is the default
+   */
+  virtual int64_t GetGeneration (void) const;
 };
 
 } // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-fib.h"
 
 namespace ns3 {
 
@@ -86,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual int64_t GetGeneration (void) const;
 
 /**
  * \brief Add a network route to the static routing table.
@@ -418,6 +420,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the longest prefix match index of m_networkRoutes.
+   */
+  Ipv4Fib m_fib;
+
   /**
    * \brief the forwarding table for multicast.
    */
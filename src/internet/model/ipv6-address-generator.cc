@@ -17,7 +17,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <list>
+#include <map>
 #include "ns3/abort.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
@@ -177,16 +177,39 @@ public:
   NetworkState m_netTable[N_BITS]; //!< the available networks
 
   /**
-   * \brief This class holds the allocated addresses
+   * \brief An address as a 128-bit number: its 64 most and least
+   * significant bits
    */
-  class Entry
-  {
-public:
-    uint8_t addrLow[16];  //!< the lowest allocated address
-    uint8_t addrHigh[16]; //!< the highest allocated address
-  };
+  typedef std::pair<uint64_t, uint64_t> Number;
+
+  /**
+   * \brief Convert an address to a number
+   * \param bytes the address bytes
+   * \returns the number
+   */
+  static Number ToNumber (const uint8_t bytes[16]);
 
-  std::list<Entry> m_entries; //!< contained of allocated addresses
+  /**
+   * \brief Convert a number to an address
+   * \param number the number
+   * \returns the address
+   */
+  static Ipv6Address ToAddress (Number number);
+
+  /**
+   * \brief Get the next number
+   * \param number a number
+   * \returns the number plus one
+   */
+  static Number Increment (Number number);
+
+  /**
+   * \brief Blocks of allocated addresses: the highest address of each
+   * block, indexed by its lowest address
+   */
+  typedef std::map<Number, Number> Entries;
+
+  Entries m_entries; //!< container of allocated addresses
   Ipv6Address m_base; //!< base address
   bool m_test; //!< test mode (if true)
 };
@@ -466,112 +489,59 @@ Ipv6AddressGeneratorImpl::AddAllocated (const Ipv6Address address)
 {
   NS_LOG_FUNCTION (this << address);
 
-  uint8_t addr[16];
-  address.GetBytes (addr);
+  uint8_t bytes[16];
+  address.GetBytes (bytes);
+  Number addr = ToNumber (bytes);
 
-  std::list<Entry>::iterator i;
-
-  for (i = m_entries.begin (); i != m_entries.end (); ++i)
+  //
+  // Find the block starting just after the new address, and the block
+  // before it, which is the only one that can contain the new address.
+  //
+  Entries::iterator next = m_entries.upper_bound (addr);
+  Entries::iterator prev = m_entries.end ();
+  if (next != m_entries.begin ())
     {
-      NS_LOG_LOGIC ("examine entry: " << Ipv6Address ((*i).addrLow) <<
-                    " to " << Ipv6Address ((*i).addrHigh));
-      //
-      // First things first.  Is there an address collision -- that is, does the
-      // new address fall in a previously allocated block of addresses.
-      //
-      if (!(Ipv6Address (addr) < Ipv6Address ((*i).addrLow))
-          && ((Ipv6Address (addr) < Ipv6Address ((*i).addrHigh))
-              || (Ipv6Address (addr) == Ipv6Address ((*i).addrHigh))))
+      prev = next;
+      --prev;
+      NS_LOG_LOGIC ("examine entry: " << ToAddress (prev->first) <<
+                    " to " << ToAddress (prev->second));
+      if (!(prev->second < addr))
         {
-          NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
+          NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << address);
           if (!m_test)
             {
-              NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
+              NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << address);
             }
           return false;
         }
-      //
-      // If the new address is less than the lowest address in the current
-      // block and can't be merged into to the current block, then insert it
-      // as a new block before the current block.
-      //
-      uint8_t taddr[16];
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] -= 1;
-      if (Ipv6Address (addr) < Ipv6Address (taddr))
-        {
-          break;
-        }
-      //
-      // If the new address fits at the end of the block, look ahead to the next
-      // block and make sure it's not a collision there.  If we won't overlap,
-      // then just extend the current block by one address.  We expect that
-      // completely filled network ranges will be a fairly rare occurrence,
-      // so we don't worry about collapsing address range blocks.
-      //
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] += 1;
-      if (Ipv6Address (addr) == Ipv6Address (taddr))
-        {
-          std::list<Entry>::iterator j = i;
-          ++j;
-
-          if (j != m_entries.end ())
-            {
-              if (Ipv6Address (addr) == Ipv6Address ((*j).addrLow))
-                {
-                  NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): "
-                                "Address Collision: " << Ipv6Address (addr));
-                  if (!m_test)
-                    {
-                      NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
-                    }
-                  return false;
-                }
-            }
-
-          NS_LOG_LOGIC ("New addrHigh = " << Ipv6Address (addr));
-          for (uint32_t j = 0; j < 16; j++)
-            {
-              (*i).addrHigh[j] = addr[j];
-            }
-          return true;
-        }
-      //
-      // If we get here, we know that the next lower block of addresses
-      // couldn't have been extended to include this new address since the
-      // code immediately above would have been executed and that next lower
-      // block extended upward.  So we know it's safe to extend the current
-      // block down to includ the new address.
-      //
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] -= 1;
-      if ((Ipv6Address (addr) == Ipv6Address (taddr)))
-        {
-          NS_LOG_LOGIC ("New addrLow = " << Ipv6Address (addr));
-          for (uint32_t j = 0; j < 16; j++)
-            {
-              (*i).addrLow[j] = addr[j];
-            }
-          return true;
-        }
     }
-
-  Entry entry;
-  for (uint32_t j = 0; j < 16; j++)
+  //
+  // Extend the neighbor blocks to include the new address, merging them if
+  // the new address fills the gap between them.
+  //
+  bool extendPrev = prev != m_entries.end () && Increment (prev->second) == addr;
+  bool extendNext = next != m_entries.end () && Increment (addr) == next->first;
+  if (extendPrev && extendNext)
+    {
+      NS_LOG_LOGIC ("Merging " << ToAddress (prev->first) << " to " << ToAddress (next->second));
+      prev->second = next->second;
+      m_entries.erase (next);
+    }
+  else if (extendPrev)
+    {
+      NS_LOG_LOGIC ("New addrHigh = " << address);
+      prev->second = addr;
+    }
+  else if (extendNext)
     {
-      entry.addrLow[j] = entry.addrHigh[j] = addr[j];
+      NS_LOG_LOGIC ("New addrLow = " << address);
+      Number addrHigh = next->second;
+      m_entries.insert (m_entries.erase (next), std::make_pair (addr, addrHigh));
+    }
+  else
+    {
+      m_entries.insert (next, std::make_pair (addr, addr));
     }
-  m_entries.insert (i, entry);
   return true;
 }
 
@@ -580,21 +550,19 @@ Ipv6AddressGeneratorImpl::IsAddressAllocated (const Ipv6Address address)
 {
   NS_LOG_FUNCTION (this << address);
 
-  uint8_t addr[16];
-  address.GetBytes (addr);
-
-  std::list<Entry>::iterator i;
+  uint8_t bytes[16];
+  address.GetBytes (bytes);
+  Number addr = ToNumber (bytes);
 
-  for (i = m_entries.begin (); i != m_entries.end (); ++i)
+  Entries::const_iterator i = m_entries.upper_bound (addr);
+  if (i != m_entries.begin ())
     {
-      NS_LOG_LOGIC ("examine entry: " << Ipv6Address ((*i).addrLow) <<
-                    " to " << Ipv6Address ((*i).addrHigh));
-
-      if (!(Ipv6Address (addr) < Ipv6Address ((*i).addrLow))
-          && ((Ipv6Address (addr) < Ipv6Address ((*i).addrHigh))
-              || (Ipv6Address (addr) == Ipv6Address ((*i).addrHigh))))
+      --i;
+      NS_LOG_LOGIC ("examine entry: " << ToAddress (i->first) <<
+                    " to " << ToAddress (i->second));
+      if (!(i->second < addr))
         {
-          NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::IsAddressAllocated(): Address Collision: " << Ipv6Address (addr));
+          NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::IsAddressAllocated(): Address Collision: " << address);
           return false;
         }
     }
@@ -610,25 +578,70 @@ Ipv6AddressGeneratorImpl::IsNetworkAllocated (const Ipv6Address address, const I
   NS_ABORT_MSG_UNLESS (address == addr.CombinePrefix (prefix),
                        "Ipv6AddressGeneratorImpl::IsNetworkAllocated(): network address and mask don't match " << address << " " << prefix);
 
-  std::list<Entry>::iterator i;
-
-  for (i = m_entries.begin (); i != m_entries.end (); ++i)
+  //
+  // The network is allocated if the last block starting before its end
+  // overlaps it.
+  //
+  uint8_t bytes[16];
+  uint8_t prefixBytes[16];
+  address.GetBytes (bytes);
+  prefix.GetBytes (prefixBytes);
+  Number networkLow = ToNumber (bytes);
+  for (uint32_t j = 0; j < 16; j++)
     {
-      NS_LOG_LOGIC ("examine entry: " << Ipv6Address ((*i).addrLow) << " to " << Ipv6Address ((*i).addrHigh));
-      Ipv6Address low = Ipv6Address ((*i).addrLow);
-      Ipv6Address high = Ipv6Address ((*i).addrHigh);
+      bytes[j] |= ~prefixBytes[j];
+    }
+  Number networkHigh = ToNumber (bytes);
 
-      if (address == low.CombinePrefix (prefix) || address == high.CombinePrefix (prefix))
+  Entries::const_iterator i = m_entries.upper_bound (networkHigh);
+  if (i != m_entries.begin ())
+    {
+      --i;
+      NS_LOG_LOGIC ("examine entry: " << ToAddress (i->first) << " to " << ToAddress (i->second));
+      if (!(i->second < networkLow))
         {
           NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::IsNetworkAllocated(): Network already allocated: " <<
-                        address << " " << low << "-" << high);
+                        address << " " << ToAddress (i->first) << "-" << ToAddress (i->second));
           return false;
         }
-
     }
   return true;
 }
 
+Ipv6AddressGeneratorImpl::Number
+Ipv6AddressGeneratorImpl::ToNumber (const uint8_t bytes[16])
+{
+  Number number (0, 0);
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      number.first = (number.first << 8) | bytes[j];
+      number.second = (number.second << 8) | bytes[j + 8];
+    }
+  return number;
+}
+
+Ipv6Address
+Ipv6AddressGeneratorImpl::ToAddress (Number number)
+{
+  uint8_t bytes[16];
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      bytes[7 - j] = (number.first >> (8 * j)) & 0xff;
+      bytes[15 - j] = (number.second >> (8 * j)) & 0xff;
+    }
+  return Ipv6Address (bytes);
+}
+
+Ipv6AddressGeneratorImpl::Number
+Ipv6AddressGeneratorImpl::Increment (Number number)
+{
+  if (++number.second == 0)
+    {
+      ++number.first;
+    }
+  return number;
+}
+
 
 void
 Ipv6AddressGeneratorImpl::TestMode (void)
@@ -18,6 +18,7 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
@@ -29,17 +30,136 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+bool Ipv6EndPointDemux::Key::operator== (const Key &other) const
+{
+  return localAddress == other.localAddress && localPort == other.localPort
+         && peerAddress == other.peerAddress && peerPort == other.peerPort
+         && device == other.device;
+}
+
+size_t Ipv6EndPointDemux::KeyHash::operator() (const Key &key) const
+{
+  size_t hash = Ipv6AddressHash () (key.localAddress);
+  hash = hash * 31 + key.localPort;
+  hash = hash * 31 + Ipv6AddressHash () (key.peerAddress);
+  hash = hash * 31 + key.peerPort;
+  hash = hash * 31 + reinterpret_cast<size_t> (key.device);
+  return hash;
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Position position;
+  position.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  position.sequence = m_sequence++;
+  m_positions[endPoint] = position;
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.peerPort = endPoint->GetPeerPort ();
+  key.device = 0;
+  if (key.peerAddress != Ipv6Address::GetAny () && key.peerPort != 0)
+    {
+      m_connected[key].push_back (endPoint);
+    }
+  else
+    {
+      m_unconnected[key.localPort].push_back (endPoint);
+    }
+  key.peerAddress = Ipv6Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (endPoint->GetBoundNetDevice ());
+  m_bindings[key]++;
+  m_ports[key.localPort]++;
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key;
+  key.localAddress = endPoint->GetLocalAddress ();
+  key.localPort = endPoint->GetLocalPort ();
+  key.peerAddress = endPoint->GetPeerAddress ();
+  key.peerPort = endPoint->GetPeerPort ();
+  key.device = 0;
+  if (key.peerAddress != Ipv6Address::GetAny () && key.peerPort != 0)
+    {
+      std::unordered_map<Key, EndPointVector, KeyHash>::iterator i = m_connected.find (key);
+      NS_ASSERT (i != m_connected.end ());
+      i->second.erase (std::find (i->second.begin (), i->second.end (), endPoint));
+      if (i->second.empty ())
+        {
+          m_connected.erase (i);
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::iterator i = m_unconnected.find (key.localPort);
+      NS_ASSERT (i != m_unconnected.end ());
+      i->second.erase (std::find (i->second.begin (), i->second.end (), endPoint));
+      if (i->second.empty ())
+        {
+          m_unconnected.erase (i);
+        }
+    }
+  key.peerAddress = Ipv6Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (endPoint->GetBoundNetDevice ());
+  std::unordered_map<Key, uint32_t, KeyHash>::iterator binding = m_bindings.find (key);
+  NS_ASSERT (binding != m_bindings.end ());
+  if (--binding->second == 0)
+    {
+      m_bindings.erase (binding);
+    }
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_ports.find (key.localPort);
+  NS_ASSERT (port != m_ports.end ());
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
+    }
+}
+
+void Ipv6EndPointDemux::GetConnected (Ipv6Address localAddress, uint16_t localPort,
+                                      Ipv6Address peerAddress, uint16_t peerPort,
+                                      std::vector<Ipv6EndPoint *> &endPoints) const
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  key.device = 0;
+  std::unordered_map<Key, EndPointVector, KeyHash>::const_iterator i = m_connected.find (key);
+  if (i != m_connected.end ())
+    {
+      endPoints.insert (endPoints.end (), i->second.begin (), i->second.end ());
+    }
+}
+
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
@@ -48,29 +168,19 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
-        {
-          return true;
-        }
-    }
-  return false;
+  Key key;
+  key.localAddress = addr;
+  key.localPort = port;
+  key.peerAddress = Ipv6Address::GetAny ();
+  key.peerPort = 0;
+  key.device = PeekPointer (boundNetDevice);
+  return m_bindings.find (key) != m_bindings.end ();
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -82,10 +192,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -97,10 +204,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port)
@@ -118,10 +222,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
@@ -129,7 +230,20 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointVector sameTuple;
+  if (peerAddress != Ipv6Address::GetAny () && peerPort != 0)
+    {
+      GetConnected (localAddress, localPort, peerAddress, peerPort, sameTuple);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::const_iterator i = m_unconnected.find (localPort);
+      if (i != m_unconnected.end ())
+        {
+          sameTuple = i->second;
+        }
+    }
+  for (EndPointVector::iterator i = sameTuple.begin (); i != sameTuple.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -143,24 +257,20 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<Ipv6EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  if (i != m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (i->second.position);
+      m_positions.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -181,7 +291,23 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* Only the end points on the destination port, which either have no peer
+     or have the source as peer and the destination or any as local address,
+     can match.  The ones with a peer are found from their four-tuple. */
+  EndPointVector candidates;
+  std::unordered_map<uint16_t, EndPointVector>::const_iterator unconnected = m_unconnected.find (dport);
+  if (unconnected != m_unconnected.end ())
+    {
+      candidates = unconnected->second;
+    }
+  GetConnected (daddr, dport, saddr, sport, candidates);
+  if (daddr != Ipv6Address::GetAny ())
+    {
+      GetConnected (Ipv6Address::GetAny (), dport, saddr, sport, candidates);
+    }
+
+  for (EndPointVector::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -290,6 +416,41 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  /* An exact match is found from the indexes.  If there are several, the
+     first one allocated is returned. */
+  EndPointVector exact;
+  if (src != Ipv6Address::GetAny () && sport != 0)
+    {
+      GetConnected (dst, dport, src, sport, exact);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPointVector>::const_iterator i = m_unconnected.find (dport);
+      if (i != m_unconnected.end ())
+        {
+          for (EndPointVector::const_iterator j = i->second.begin (); j != i->second.end (); j++)
+            {
+              if ((*j)->GetLocalAddress () == dst && (*j)->GetPeerPort () == sport
+                  && (*j)->GetPeerAddress () == src)
+                {
+                  exact.push_back (*j);
+                }
+            }
+        }
+    }
+  Ipv6EndPoint *first = 0;
+  for (EndPointVector::const_iterator i = exact.begin (); i != exact.end (); i++)
+    {
+      if (first == 0 || m_positions[*i].sequence < m_positions[first].sequence)
+        {
+          first = *i;
+        }
+    }
+  if (first != 0)
+    {
+      return first;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
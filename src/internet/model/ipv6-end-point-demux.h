@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,12 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by hash tables, so that the lookups do not
+ * depend on the number of endpoints: the endpoints with a peer address and
+ * port (e.g., the connected TCP sockets) are indexed by their four-tuple,
+ * the other ones by their local port.  The endpoints update the indexes
+ * when their addresses, ports or bound NetDevice change.
  */
 class Ipv6EndPointDemux
 {
@@ -153,12 +161,93 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
    */
   uint16_t AllocateEphemeralPort ();
 
+  /**
+   * \brief Add a new end point to the demux.
+   * \param endPoint the end point
+   * \returns the end point
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the lookup indexes.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the lookup indexes.
+   *
+   * The end point must not have changed since it was indexed.
+   *
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add the end points of a four-tuple to a list.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \param endPoints the list
+   */
+  void GetConnected (Ipv6Address localAddress, uint16_t localPort,
+                     Ipv6Address peerAddress, uint16_t peerPort,
+                     std::vector<Ipv6EndPoint *> &endPoints) const;
+
+  /**
+   * \brief The four-tuple of an end point, or its local address, local port
+   * and bound NetDevice.
+   */
+  struct Key
+  {
+    Ipv6Address localAddress; //!< the local address
+    uint16_t localPort;       //!< the local port
+    Ipv6Address peerAddress;  //!< the peer address, any if unused
+    uint16_t peerPort;        //!< the peer port, 0 if unused
+    NetDevice *device;        //!< the bound NetDevice, 0 if unused
+
+    /**
+     * \param other another key
+     * \returns true if both keys are equal
+     */
+    bool operator== (const Key &other) const;
+  };
+
+  /**
+   * \brief Hash function of the keys.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key a key
+     * \returns the hash of the key
+     */
+    size_t operator() (const Key &key) const;
+  };
+
+  /**
+   * \brief The position of an end point in m_endPoints.
+   */
+  struct Position
+  {
+    EndPointsI position; //!< the iterator in m_endPoints
+    uint64_t sequence;   //!< the rank of the end point in m_endPoints
+  };
+
+  /**
+   * \brief Lists of end points.
+   */
+  typedef std::vector<Ipv6EndPoint *> EndPointVector;
+
   /**
    * \brief The ephemeral port.
    */
@@ -178,6 +267,30 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+  /**
+   * \brief The position of the end points in m_endPoints.
+   */
+  std::unordered_map<Ipv6EndPoint *, Position> m_positions;
+  /**
+   * \brief The sequence number of the next end point.
+   */
+  uint64_t m_sequence;
+  /**
+   * \brief The end points with a peer address and port, by four-tuple.
+   */
+  std::unordered_map<Key, EndPointVector, KeyHash> m_connected;
+  /**
+   * \brief The end points without a peer address or port, by local port.
+   */
+  std::unordered_map<uint16_t, EndPointVector> m_unconnected;
+  /**
+   * \brief The number of end points, by local address, port and bound NetDevice.
+   */
+  std::unordered_map<Key, uint32_t, KeyHash> m_bindings;
+  /**
+   * \brief The number of end points, by local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } /* namespace ns3 */
@@ -284,5 +284,64 @@ std::string Ipv6Header::EcnTypeToString (EcnType ecn) const
     };
 }
 
+Ipv6HeaderView::Ipv6HeaderView (Ptr<const Packet> packet)
+  : HeaderView<Ipv6Header> (packet, 40)
+{
+}
+
+uint8_t Ipv6HeaderView::GetTrafficClass (void) const
+{
+  if (IsDirect ())
+    {
+      return (uint8_t)((ReadNtohU32 (0) >> 20) & 0x000000ff);
+    }
+  return GetHeader ().GetTrafficClass ();
+}
+
+uint16_t Ipv6HeaderView::GetPayloadLength (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (4);
+    }
+  return GetHeader ().GetPayloadLength ();
+}
+
+uint8_t Ipv6HeaderView::GetNextHeader (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (6);
+    }
+  return GetHeader ().GetNextHeader ();
+}
+
+uint8_t Ipv6HeaderView::GetHopLimit (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (7);
+    }
+  return GetHeader ().GetHopLimit ();
+}
+
+Ipv6Address Ipv6HeaderView::GetSourceAddress (void) const
+{
+  if (IsDirect ())
+    {
+      return Ipv6Address::Deserialize (GetData (8));
+    }
+  return GetHeader ().GetSourceAddress ();
+}
+
+Ipv6Address Ipv6HeaderView::GetDestinationAddress (void) const
+{
+  if (IsDirect ())
+    {
+      return Ipv6Address::Deserialize (GetData (24));
+    }
+  return GetHeader ().GetDestinationAddress ();
+}
+
 } /* namespace ns3 */
 
@@ -22,6 +22,7 @@
 #define IPV6_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv6-address.h"
 
 namespace ns3 {
@@ -310,6 +311,50 @@ private:
   Ipv6Address m_destinationAddress;
 };
 
+/**
+ * \ingroup ipv6
+ *
+ * \brief Read-only view of an Ipv6Header stored at the start of a packet.
+ */
+class Ipv6HeaderView : public HeaderView<Ipv6Header>
+{
+public:
+  /**
+   * \param packet the packet which starts with the IPv6 header
+   */
+  Ipv6HeaderView (Ptr<const Packet> packet);
+  /**
+   * \brief Get the "Traffic class" field.
+   * \return the traffic class value
+   */
+  uint8_t GetTrafficClass (void) const;
+  /**
+   * \brief Get the "Payload length" field.
+   * \return the payload length
+   */
+  uint16_t GetPayloadLength (void) const;
+  /**
+   * \brief Get the next header.
+   * \return the next header number
+   */
+  uint8_t GetNextHeader (void) const;
+  /**
+   * \brief Get the "Hop limit" field (TTL).
+   * \return the hop limit value
+   */
+  uint8_t GetHopLimit (void) const;
+  /**
+   * \brief Get the "Source address" field.
+   * \return the source address
+   */
+  Ipv6Address GetSourceAddress (void) const;
+  /**
+   * \brief Get the "Destination address" field.
+   * \return the destination address
+   */
+  Ipv6Address GetDestinationAddress (void) const;
+};
+
 } /* namespace ns3 */
 
 #endif /* IPV6_HEADER_H */
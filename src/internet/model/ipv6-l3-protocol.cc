@@ -31,6 +31,7 @@
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "ipv6-l3-protocol.h"
@@ -1126,7 +1127,10 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  // super-segments are sent as a whole to the device, which serializes them
+  SegmentOffloadTag offloadTag;
+  if (packet->GetSize () > targetMtu + 40 /* 40 => size of IPv6 header */
+      && !packet->PeekPacketTag (offloadTag))
     {
       // Router => drop
 
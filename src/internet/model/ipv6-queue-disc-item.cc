@@ -119,20 +119,18 @@ Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
   Ipv6Address dest = m_header.GetDestinationAddress ();
   uint8_t prot = m_header.GetNextHeader ();
 
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
   uint16_t srcPort = 0;
   uint16_t destPort = 0;
 
   if (prot == 6) // TCP
     {
-      GetPacket ()->PeekHeader (tcpHdr);
+      TcpHeaderView tcpHdr (GetPacket ());
       srcPort = tcpHdr.GetSourcePort ();
       destPort = tcpHdr.GetDestinationPort ();
     }
   else if (prot == 17) // UDP
     {
-      GetPacket ()->PeekHeader (udpHdr);
+      UdpHeaderView udpHdr (GetPacket ());
       srcPort = udpHdr.GetSourcePort ();
       destPort = udpHdr.GetDestinationPort ();
     }
@@ -544,4 +544,79 @@ operator<< (std::ostream& os, TcpHeader const & tc)
   return os;
 }
 
+TcpHeaderView::TcpHeaderView (Ptr<const Packet> packet)
+  : HeaderView<TcpHeader> (packet, 20)
+{
+}
+
+uint16_t
+TcpHeaderView::GetSourcePort () const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (0);
+    }
+  return GetHeader ().GetSourcePort ();
+}
+
+uint16_t
+TcpHeaderView::GetDestinationPort () const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (2);
+    }
+  return GetHeader ().GetDestinationPort ();
+}
+
+SequenceNumber32
+TcpHeaderView::GetSequenceNumber () const
+{
+  if (IsDirect ())
+    {
+      return SequenceNumber32 (ReadNtohU32 (4));
+    }
+  return GetHeader ().GetSequenceNumber ();
+}
+
+SequenceNumber32
+TcpHeaderView::GetAckNumber () const
+{
+  if (IsDirect ())
+    {
+      return SequenceNumber32 (ReadNtohU32 (8));
+    }
+  return GetHeader ().GetAckNumber ();
+}
+
+uint8_t
+TcpHeaderView::GetLength () const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (12) >> 4;
+    }
+  return GetHeader ().GetLength ();
+}
+
+uint8_t
+TcpHeaderView::GetFlags () const
+{
+  if (IsDirect ())
+    {
+      return ReadU8 (13) & 0x3F;
+    }
+  return GetHeader ().GetFlags ();
+}
+
+uint16_t
+TcpHeaderView::GetWindowSize () const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (14);
+    }
+  return GetHeader ().GetWindowSize ();
+}
+
 } // namespace ns3
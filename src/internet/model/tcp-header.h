@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/tcp-option.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-socket-factory.h"
@@ -353,6 +354,64 @@ private:
   uint8_t m_optionsLen;        //!< Tcp options length.
 };
 
+/**
+ * \ingroup tcp
+ * \brief Read-only view of the fixed part of a TcpHeader stored at the
+ * start of a packet.
+ *
+ * Options are not accessible through the view.
+ */
+class TcpHeaderView : public HeaderView<TcpHeader>
+{
+public:
+  /**
+   * \param packet the packet which starts with the TCP header
+   */
+  TcpHeaderView (Ptr<const Packet> packet);
+
+  /**
+   * \brief Get the source port
+   * \return The source port for this TcpHeader
+   */
+  uint16_t GetSourcePort () const;
+
+  /**
+   * \brief Get the destination port
+   * \return the destination port for this TcpHeader
+   */
+  uint16_t GetDestinationPort () const;
+
+  /**
+   * \brief Get the sequence number
+   * \return the sequence number for this TcpHeader
+   */
+  SequenceNumber32 GetSequenceNumber () const;
+
+  /**
+   * \brief Get the ACK number
+   * \return the ACK number for this TcpHeader
+   */
+  SequenceNumber32 GetAckNumber () const;
+
+  /**
+   * \brief Get the length in words
+   * \return the length of this TcpHeader
+   */
+  uint8_t GetLength () const;
+
+  /**
+   * \brief Get the flags
+   * \return the flags for this TcpHeader
+   */
+  uint8_t GetFlags () const;
+
+  /**
+   * \brief Get the window size
+   * \return the window size for this TcpHeader
+   */
+  uint16_t GetWindowSize () const;
+};
+
 } // namespace ns3
 
 #endif /* TCP_HEADER */
@@ -374,9 +374,20 @@ TcpL4Protocol::PacketReceived (Ptr<Packet> packet, TcpHeader &incomingTcpHeader,
     {
       incomingTcpHeader.EnableChecksums ();
       incomingTcpHeader.InitializeChecksum (source, destination, PROT_NUMBER);
+      packet->PeekHeader (incomingTcpHeader);
+    }
+  else
+    {
+      // The demultiplexing only needs the fixed fields: the options are
+      // deserialized by the socket which gets the packet.
+      TcpHeaderView view (packet);
+      incomingTcpHeader.SetSourcePort (view.GetSourcePort ());
+      incomingTcpHeader.SetDestinationPort (view.GetDestinationPort ());
+      incomingTcpHeader.SetSequenceNumber (view.GetSequenceNumber ());
+      incomingTcpHeader.SetAckNumber (view.GetAckNumber ());
+      incomingTcpHeader.SetFlags (view.GetFlags ());
+      incomingTcpHeader.SetWindowSize (view.GetWindowSize ());
     }
-
-  packet->PeekHeader (incomingTcpHeader);
 
   NS_LOG_LOGIC ("TcpL4Protocol " << this
                                  << " receiving seq " << incomingTcpHeader.GetSequenceNumber ()
@@ -287,7 +287,8 @@ protected:
    * \brief Get the tcp header of the incoming packet and checks its checksum if needed
    *
    * \param packet Received packet
-   * \param incomingTcpHeader Overwritten with the tcp header of the packet
+   * \param incomingTcpHeader Overwritten with the tcp header of the packet,
+   *        without its options unless checksums are enabled
    * \param source Source address (an underlying Ipv4Address or Ipv6Address)
    * \param destination Destination address (an underlying Ipv4Address or Ipv6Address)
    *
@@ -155,8 +155,13 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The buffered segments do not
+  // overlap, so only the one before headSeq can contain it.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -194,29 +199,42 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
     }
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
-
-  if (headSeq > m_nextRxSeq)
-    {
-      // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
-    }
-
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  m_data.insert (std::make_pair (headSeq, p));
+
+  // Merge the segment with the ranges it overlaps (the segments it replaced)
+  // or touches
+  SequenceNumber32 rangeStart = headSeq;
+  SequenceNumber32 rangeEnd = tailSeq;
+  RangeIterator r = m_ranges.upper_bound (headSeq);
+  if (r != m_ranges.begin ())
     {
-      if (i->first < m_nextRxSeq)
+      --r;
+      if (r->second < headSeq)
         {
-          continue;
+          ++r;
         }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+    }
+  while (r != m_ranges.end () && r->first <= tailSeq)
+    {
+      rangeStart = std::min (rangeStart, r->first);
+      rangeEnd = std::max (rangeEnd, r->second);
+      m_ranges.erase (r++);
+    }
+  m_ranges.insert (std::make_pair (rangeStart, rangeEnd));
+
+  if (headSeq > m_nextRxSeq)
+    {
+      // Generate a new SACK block, for the whole range of the packet
+      UpdateSackList (rangeStart, rangeEnd);
+    }
+  else
+    {
+      // The range holds in-order data
+      NS_ASSERT (rangeStart <= m_nextRxSeq);
+      m_availBytes += rangeEnd - m_nextRxSeq.Get ();
+      m_nextRxSeq = rangeEnd;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -271,54 +289,24 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block is the whole range of contiguous data containing the segment,
+  // as stored in the buffer: the blocks reported before for a part of it
+  // (e.g., the blocks it has been merged with) are subsets of it.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (current.first <= it->first && it->second <= current.second)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          ++it;
         }
-
-      ++it;
     }
 
+  m_sackList.push_front (current);
+
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
   if (m_sackList.size () > 4)
@@ -326,10 +314,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
       m_sackList.pop_back ();
     }
 
-  // Please note that, if a block b is discarded and then a block contiguos
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -370,6 +354,16 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  // The extracted data is taken from the head of the in-order range
+  RangeIterator r = m_ranges.begin ();
+  NS_ASSERT (r != m_ranges.end () && r->first == m_data.begin ()->first);
+  SequenceNumber32 rangeStart = r->first + SequenceNumber32 (extractSize);
+  SequenceNumber32 rangeEnd = r->second;
+  m_ranges.erase (r);
+  if (rangeStart < rangeEnd)
+    {
+      m_ranges.insert (std::make_pair (rangeStart, rangeEnd));
+    }
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -53,6 +53,14 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The data is stored as one packet per received segment. The ranges of
+ * contiguous sequence numbers they form are tracked separately, with one
+ * entry per hole in the sequence space (plus the in-order data), whatever
+ * the number of segments received: the range containing a new segment,
+ * which is the first SACK block to report or the new in-order data, is
+ * found without walking the segments. The packets of the segments are
+ * only concatenated by Extract.
+ *
  * SACK list
  * ---------
  *
@@ -185,6 +193,10 @@ private:
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
+   * The block is the whole range of contiguous data containing the last
+   * received segment; the blocks previously reported for parts of it are
+   * removed.
+   *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accomodate header size; from RFC 2018:
    *
@@ -219,13 +231,16 @@ private:
 
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for the ranges of contiguous data
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator RangeIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Segments, by first sequence number
+  std::map<SequenceNumber32, SequenceNumber32> m_ranges; //!< End of each range of contiguous data, by first sequence number
 };
 
 } //namepsace ns3
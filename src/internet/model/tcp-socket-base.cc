@@ -42,6 +42,7 @@
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/object.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -68,6 +69,10 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+/// Largest payload of a super-segment: the IP and TCP headers, of up to
+/// 60 bytes each, must fit with it in the 16-bit IP length fields
+static const uint32_t MAX_OFFLOAD_SIZE = 65535 - 2 * 60;
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -141,6 +146,12 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("SegmentationOffload",
+                   "Send the new data allowed by the window as super-segments of up to 64 KB, "
+                   "serialized as back-to-back frames by the devices supporting it",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_segmentationOffload),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -304,6 +315,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_segmentationOffload (sock.m_segmentationOffload),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -1746,7 +1758,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
       else if (ackNumber < m_recover && m_tcb->m_congState == TcpSocketState::CA_LOSS)
         {
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          IncreaseWindow (segsAcked);
 
           NS_LOG_DEBUG (" Cong Control Called, cWnd=" << m_tcb->m_cWnd <<
                         " ssTh=" << m_tcb->m_ssThresh);
@@ -1839,7 +1851,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              IncreaseWindow (segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2621,6 +2633,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (sz > m_tcb->m_segmentSize)
+    {
+      uint32_t segments = (sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize;
+      p->AddPacketTag (SegmentOffloadTag (segments, sz));
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -2835,6 +2852,14 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_segmentationOffload && next == m_tcb->m_highTxMark
+              && availableWindow >= 2 * m_tcb->m_segmentSize)
+            {
+              // Send new data as a super-segment of whole segments. The
+              // retransmissions are made segment by segment.
+              s = std::min (availableWindow, MAX_OFFLOAD_SIZE);
+              s -= s % m_tcb->m_segmentSize;
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -2989,6 +3014,11 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // A super-segment counts as the segments it stands for in the delayed
+  // ACK count, which thus acknowledges it at once
+  SegmentOffloadTag offloadTag;
+  uint32_t segments = p->RemovePacketTag (offloadTag) ? offloadTag.GetSegments () : 1;
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -3024,7 +3054,8 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3097,6 +3128,25 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
     }
 }
 
+void
+TcpSocketBase::IncreaseWindow (uint32_t segsAcked)
+{
+  NS_LOG_FUNCTION (this << segsAcked);
+
+  uint32_t perAck = std::max (m_delAckMaxCount, 1U);
+  if (!m_segmentationOffload || segsAcked <= perAck)
+    {
+      m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+      return;
+    }
+  while (segsAcked > 0)
+    {
+      uint32_t acked = std::min (segsAcked, perAck);
+      m_congestionControl->IncreaseWindow (m_tcb, acked);
+      segsAcked -= acked;
+    }
+}
+
 // Called by the ReceivedAck() when new ACK received and by ProcessSynRcvd()
 // when the three-way handshake completed. This cancels retransmission timer
 // and advances Tx window
@@ -879,6 +879,17 @@ protected:
    */
   virtual void NewAck (SequenceNumber32 const& seq, bool resetRTO);
 
+  /**
+   * \brief Increase the congestion window for the segments acknowledged
+   *
+   * With segmentation offload, an ACK acknowledges a whole super-segment.
+   * It is passed to the congestion control as the delayed ACKs it stands
+   * for, so that the window grows as it would with single segments.
+   *
+   * \param segsAcked the number of segments acknowledged
+   */
+  void IncreaseWindow (uint32_t segsAcked);
+
   /**
    * \brief Dupack management
    */
@@ -1128,6 +1139,8 @@ protected:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  bool m_segmentationOffload {false}; //!< send new data as super-segments
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
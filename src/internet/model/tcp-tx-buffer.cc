@@ -169,6 +169,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_leftOutUpTo = seq;
 }
 
 bool
@@ -294,7 +295,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  AddToIndex (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,36 +309,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentIndex::iterator found = m_sentIndex.find (seq);
+  if (found != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = found->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -345,8 +343,11 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   if (! item->m_retrans)
     {
+      PacketList::iterator it = m_sentIndex[item->m_startSeq];
+      RemoveFromIndex (item);
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      AddToIndex (it);
     }
 
   return item;
@@ -398,7 +399,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +435,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool indexed = &list == &m_sentList;
+
+  if (indexed)
+    {
+      // Start from the item containing seq
+      SentIndex::iterator start = m_sentIndex.upper_bound (seq);
+      if (start != m_sentIndex.begin ())
+        {
+          --start;
+          it = start->second;
+          beginOfCurrentPacket = start->first;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!indexed || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -466,10 +480,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  RemoveFromIndex (currentItem);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  AddToIndex (firstIt);
+                  AddToIndex (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -513,12 +536,22 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   // current > outPacket in the list. Merge current with the
                   // previous, and recurse.
                   NS_ASSERT (it != list.begin ());
+                  PacketList::iterator current = it;
                   TcpTxItem *previous = *(--it);
 
-                  list.erase (it);
+                  if (indexed)
+                    {
+                      RemoveFromIndex (previous);
+                      RemoveFromIndex (currentItem);
+                    }
+                  list.erase (current);
 
                   MergeItems (previous, currentItem);
                   delete currentItem;
+                  if (indexed)
+                    {
+                      AddToIndex (it);
+                    }
                   if (listEdited)
                     {
                       *listEdited = true;
@@ -532,10 +565,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  RemoveFromIndex (currentItem);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  AddToIndex (firstIt);
+                  AddToIndex (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -563,10 +605,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
 
+          if (indexed)
+            {
+              RemoveFromIndex (currentItem);
+              RemoveFromIndex (next);
+            }
           MergeItems (currentItem, next);
-          list.erase (it);
+          it = list.erase (it);
 
           delete next;
+          if (indexed)
+            {
+              AddToIndex (--it);
+            }
 
           if (listEdited)
             {
@@ -648,6 +699,35 @@ TcpTxBuffer::RemoveFromCounts (TcpTxItem *item, uint32_t size)
       m_lostOut -= size;
     }
 }
+
+void
+TcpTxBuffer::AddToIndex (PacketList::iterator it)
+{
+  const TcpTxItem *item = *it;
+  m_sentIndex[item->m_startSeq] = it;
+  if (item->m_sacked || item->m_lost)
+    {
+      m_leftIndex[item->m_startSeq] = it;
+    }
+  if (!item->m_sacked && !item->m_retrans)
+    {
+      m_freshIndex[item->m_startSeq] = it;
+      if (item->m_lost)
+        {
+          m_lostIndex[item->m_startSeq] = it;
+        }
+    }
+}
+
+void
+TcpTxBuffer::RemoveFromIndex (const TcpTxItem *item)
+{
+  m_sentIndex.erase (item->m_startSeq);
+  m_leftIndex.erase (item->m_startSeq);
+  m_freshIndex.erase (item->m_startSeq);
+  m_lostIndex.erase (item->m_startSeq);
+}
+
 void
 TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 {
@@ -692,6 +772,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           m_firstByteSeq += pktSize;
 
           RemoveFromCounts (item, pktSize);
+          RemoveFromIndex (item);
 
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
@@ -703,6 +784,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          RemoveFromIndex (item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
@@ -711,6 +793,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           m_firstByteSeq += offset;
 
           RemoveFromCounts (item, offset);
+          AddToIndex (i);
 
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize << " resulting item is " <<
@@ -733,8 +816,11 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          RemoveFromIndex (head);
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          AddToIndex (m_sentList.begin ());
+          m_leftOutUpTo = head->m_startSeq;
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -768,15 +854,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // The items starting before the block cannot be sacked by it
+      SentIndex::iterator first = m_sentIndex.lower_bound ((*option_it).first);
+      if (first == m_sentIndex.end ())
+        {
+          continue;
+        }
+      PacketList::iterator item_it = first->second;
+      SequenceNumber32 beginOfCurrentPacket = first->first;
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -798,6 +890,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
                 }
               else
                 {
+                  RemoveFromIndex (*item_it);
                   if ((*item_it)->m_lost)
                     {
                       (*item_it)->m_lost = false;
@@ -806,6 +899,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
                   (*item_it)->m_sacked = true;
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
+                  AddToIndex (item_it);
 
                   if (m_highestSack.first == m_sentList.end()
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
@@ -865,32 +959,50 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
+  // Every item below m_leftOutUpTo is sacked or lost already: once the
+  // threshold is reached, the walk can stop there.
+  SequenceNumber32 leftOutUpTo = std::max (m_leftOutUpTo, m_firstByteSeq.Get ());
   for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
     {
       TcpTxItem *item = *it;
       if (item->m_sacked)
         {
           sacked++;
+          if (sacked == m_dupAckThresh)
+            {
+              // From here on, every item below is sacked or marked as lost
+              leftOutUpTo = std::max (leftOutUpTo, item->m_startSeq + item->m_packet->GetSize ());
+            }
         }
 
       if (sacked >= m_dupAckThresh)
         {
+          if (item->m_startSeq < m_leftOutUpTo)
+            {
+              break;
+            }
           if (!item->m_sacked && !item->m_lost)
             {
+              PacketList::iterator pos = m_sentIndex[item->m_startSeq];
+              RemoveFromIndex (item);
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              AddToIndex (pos);
             }
         }
       beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
+  m_leftOutUpTo = leftOutUpTo;
 
   if (sacked >= m_dupAckThresh)
     {
       TcpTxItem *item = *m_sentList.begin ();
       if (!item->m_lost)
         {
+          RemoveFromIndex (item);
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          AddToIndex (m_sentList.begin ());
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,35 +1014,22 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first item from seq which is either lost or sacked decides
+  SentIndex::const_iterator it = m_leftIndex.lower_bound (seq);
+  if (it != m_leftIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it->second)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
     }
 
   return false;
@@ -954,35 +1053,12 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Condition 1.a , 1.b , and 1.c: the head of the retransmission queue
+  if (!m_lostIndex.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << m_lostIndex.begin ()->first);
+      *seq = m_lostIndex.begin ()->first;
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,10 +1084,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_freshIndex.empty ())
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
+      NS_LOG_INFO ("Rule3 valid. " << m_freshIndex.begin ()->first);
+      *seq = m_freshIndex.begin ()->first;
       return true;
     }
 
@@ -1182,10 +1258,16 @@ TcpTxBuffer::ResetRenoSack ()
   m_sackedOut = 0;
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      (*it)->m_sacked = false;
+      if ((*it)->m_sacked)
+        {
+          RemoveFromIndex (*it);
+          (*it)->m_sacked = false;
+          AddToIndex (it);
+        }
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_leftOutUpTo = m_firstByteSeq;
 }
 
 void
@@ -1208,6 +1290,11 @@ TcpTxBuffer::ResetSentList ()
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_sentIndex.clear ();
+  m_leftIndex.clear ();
+  m_freshIndex.clear ();
+  m_lostIndex.clear ();
+  m_leftOutUpTo = m_firstByteSeq;
 }
 
 void
@@ -1218,6 +1305,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      RemoveFromIndex (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1248,6 +1336,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      RemoveFromIndex (*it);
       if (resetSack)
         {
           (*it)->m_sacked = false;
@@ -1269,7 +1358,9 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
         }
 
       (*it)->m_retrans = false;
+      AddToIndex (it);
     }
+  m_leftOutUpTo = m_firstByteSeq + m_sentSize;
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1301,8 +1392,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      RemoveFromIndex (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      AddToIndex (m_sentList.begin ());
     }
   ConsistencyCheck ();
 }
@@ -1312,6 +1405,7 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      RemoveFromIndex (m_sentList.front ());
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1332,6 +1426,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      AddToIndex (m_sentList.begin ());
     }
   ConsistencyCheck ();
 }
@@ -1356,8 +1451,10 @@ TcpTxBuffer::AddRenoSack (void)
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
+      RemoveFromIndex (*it);
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
+      AddToIndex (it);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1383,9 +1480,18 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t sacked = 0;
   uint32_t lost = 0;
   uint32_t retrans = 0;
+  uint32_t left = 0;
+  uint32_t fresh = 0;
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      SentIndex::const_iterator found = m_sentIndex.find ((*it)->m_startSeq);
+      NS_ASSERT_MSG (found != m_sentIndex.end () && found->second == it,
+                     "Item " << **it << " not indexed");
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_leftOutUpTo || (*it)->m_sacked || (*it)->m_lost,
+                     "Item " << **it << " below " << m_leftOutUpTo << " neither sacked nor lost");
+      left += ((*it)->m_sacked || (*it)->m_lost) ? 1 : 0;
+      fresh += (!(*it)->m_sacked && !(*it)->m_retrans) ? 1 : 0;
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
@@ -1406,6 +1512,9 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+  NS_ASSERT (m_sentIndex.size () == m_sentList.size ());
+  NS_ASSERT (m_leftIndex.size () == left);
+  NS_ASSERT (m_freshIndex.size () == fresh);
 }
 
 std::ostream &
@@ -22,6 +22,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -105,6 +106,16 @@ public:
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * With large windows the sent list holds tens of thousands of items, so the
+ * list is never walked from its head on the ACK path. The sent items are
+ * indexed by their starting sequence number, and further indexes keep
+ * the items which left the network (sacked or lost), the items which are
+ * neither sacked nor retransmitted, and the lost ones among them (the
+ * retransmission queue). Update, IsLost, NextSeg and GetTransmittedSegment
+ * locate the items they need in logarithmic time, and UpdateLostCount only
+ * walks the items above the highest sequence below which every item is
+ * already sacked or lost.
+ *
  * Item properties
  * ---------------
  *
@@ -426,12 +437,28 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. The walk stops at m_leftOutUpTo, below which
+   * every item is already sacked or lost.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Add an item of the sent list to the indexes
+   * \param it the item
+   */
+  void AddToIndex (PacketList::iterator it);
+
+  /**
+   * \brief Remove an item of the sent list from the indexes
+   *
+   * The item must be removed before changing its sequence number or flags,
+   * and added back afterwards.
+   *
+   * \param item the item
+   */
+  void RemoveFromIndex (const TcpTxItem *item);
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -542,6 +569,8 @@ private:
    * - fragment (seq + numBytes, end)
    *
    * After these operations, the requested block is exactly the resulting packet.
+   * In the sent list, the walk starts from the item containing seq, found
+   * through the index.
    * Merge operation is required when the requested block span over two (or more)
    * existing packets.
    *
@@ -560,7 +589,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -599,6 +628,9 @@ private:
   std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
   FindHighestSacked () const;
 
+  /// Items of the sent list indexed by their starting sequence number
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex;
+
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
@@ -608,6 +640,12 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  SentIndex m_sentIndex;   //!< All the items of the sent list
+  SentIndex m_leftIndex;   //!< Sacked or lost items
+  SentIndex m_freshIndex;  //!< Items neither sacked nor retransmitted
+  SentIndex m_lostIndex;   //!< Lost items neither sacked nor retransmitted
+  SequenceNumber32 m_leftOutUpTo {0}; //!< Every item starting below is sacked or lost
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
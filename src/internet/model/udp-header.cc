@@ -243,4 +243,29 @@ UdpHeader::GetChecksum ()
   return m_checksum;
 }
 
+UdpHeaderView::UdpHeaderView (Ptr<const Packet> packet)
+  : HeaderView<UdpHeader> (packet, 8)
+{
+}
+
+uint16_t
+UdpHeaderView::GetSourcePort (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (0);
+    }
+  return GetHeader ().GetSourcePort ();
+}
+
+uint16_t
+UdpHeaderView::GetDestinationPort (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (2);
+    }
+  return GetHeader ().GetDestinationPort ();
+}
+
 } // namespace ns3
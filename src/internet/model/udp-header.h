@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <string>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 
@@ -185,6 +186,27 @@ private:
   bool m_goodChecksum;        //!< Flag to indicate that checksum is correct
 };
 
+/**
+ * \ingroup udp
+ * \brief Read-only view of an UdpHeader stored at the start of a packet.
+ */
+class UdpHeaderView : public HeaderView<UdpHeader>
+{
+public:
+  /**
+   * \param packet the packet which starts with the UDP header
+   */
+  UdpHeaderView (Ptr<const Packet> packet);
+  /**
+   * \return The source port for this UdpHeader
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \return the destination port for this UdpHeader
+   */
+  uint16_t GetDestinationPort (void) const;
+};
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
@@ -329,6 +329,12 @@ AddressCollisionTestCase::DoRun (void)
 
   added = Ipv4AddressGenerator::AddAllocated ("0.0.0.21");
   NS_TEST_EXPECT_MSG_EQ (added, false, "404");
+
+  // the blocks merged into 0.0.0.1-0.0.0.21
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressGenerator::IsAddressAllocated ("0.0.0.10"), false, "405");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressGenerator::IsAddressAllocated ("0.0.0.22"), true, "406");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressGenerator::IsNetworkAllocated ("0.0.0.8", "255.255.255.252"), false, "407");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressGenerator::IsNetworkAllocated ("0.0.0.24", "255.255.255.252"), true, "408");
 }
 
 
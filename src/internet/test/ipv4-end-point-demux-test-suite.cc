@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 end point demux Test
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the end point lookups and their index updates")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4Address local ("10.1.1.1");
+  Ipv4Address peer ("10.1.1.2");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  Ipv4EndPoint *listener = demux.Allocate (0, Ipv4Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Allocation failed");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, Ipv4Address::GetAny (), 80), 0, "Duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "Port not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv4Address::GetAny (), 80), true, "Binding not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, local, 80), false, "Unexpected binding");
+
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+
+  // connected end points take precedence over the listening one
+  Ipv4EndPoint *connected = demux.Allocate (0, local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Allocation failed");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1234), 0, "Duplicated end point allocated");
+  endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "Exact end point not preferred");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), connected, "Exact end point not found");
+  endPoints = demux.Lookup (local, 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+
+  // the demux follows the changes of the end points
+  Ipv4EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Allocation failed");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "Ephemeral port not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 22, interface).size (), 1, "End point not found");
+  client->SetPeer (peer, 22);
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 23, interface).size (), 0, "Unexpected end point");
+  endPoints = demux.Lookup (local, port, peer, 22, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), client, "Connected end point not found");
+  client->SetLocalAddress (Ipv4Address ("10.1.1.3"));
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 22, interface).size (), 0, "Unexpected end point");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv4Address ("10.1.1.3"), port), true, "Binding not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, local, port), false, "Stale binding");
+
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (local)->GetLocalPort (), port + 1, "Wrong ephemeral port");
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 2, "Wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 end point demux TestSuite
+ */
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite ();
+};
+
+Ipv4EndPointDemuxTestSuite::Ipv4EndPointDemuxTestSuite ()
+  : TestSuite ("ipv4-end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static Ipv4EndPointDemuxTestSuite g_ipv4EndPointDemuxTestSuite; //!< Static variable for test initialization
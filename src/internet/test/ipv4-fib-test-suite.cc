@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-fib.h"
+#include "ns3/ipv4-routing-table-entry.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 longest prefix match index Test
+ */
+class Ipv4FibTestCase : public TestCase
+{
+public:
+  Ipv4FibTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4FibTestCase::Ipv4FibTestCase ()
+  : TestCase ("Check longest prefix match and equal-cost route sets")
+{
+}
+
+void
+Ipv4FibTestCase::DoRun (void)
+{
+  Ipv4RoutingTableEntry def = Ipv4RoutingTableEntry::CreateDefaultRoute (Ipv4Address ("10.0.0.1"), 1);
+  Ipv4RoutingTableEntry net8 = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.0.0.0"),
+                                                                           Ipv4Mask ("255.0.0.0"), 1);
+  Ipv4RoutingTableEntry net24a = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.2.0"),
+                                                                             Ipv4Mask ("255.255.255.0"), 2);
+  // not normalized: matches the same destinations as net24a
+  Ipv4RoutingTableEntry net24b = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.2.7"),
+                                                                             Ipv4Mask ("255.255.255.0"), 3);
+  Ipv4RoutingTableEntry host = Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address ("10.1.2.3"), 4);
+
+  Ipv4Fib fib;
+  NS_TEST_EXPECT_MSG_EQ (fib.Lookup (Ipv4Address ("10.1.2.3")), 0, "Empty index matches");
+  fib.Add (&def);
+  fib.Add (&net8, 5);
+  fib.Add (&net24a);
+  fib.Add (&net24b, 7);
+  fib.Add (&host);
+  NS_TEST_EXPECT_MSG_EQ (fib.GetNRoutes (), 5, "Wrong number of routes");
+
+  Ipv4Fib::Routes const *routes = fib.Lookup (Ipv4Address ("10.1.2.3"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_ASSERT_MSG_EQ (routes->size (), 1, "Wrong route set");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &host, "Host route not preferred");
+
+  routes = fib.Lookup (Ipv4Address ("10.1.2.4"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_ASSERT_MSG_EQ (routes->size (), 2, "Wrong equal-cost route set");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &net24a, "Wrong route order");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[1].first, &net24b, "Wrong route order");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[1].second, 7, "Wrong metric");
+
+  routes = fib.Lookup (Ipv4Address ("10.9.9.9"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &net8, "/8 route not selected");
+
+  routes = fib.Lookup (Ipv4Address ("192.168.0.1"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &def, "Default route not selected");
+
+  // prefixes with no route through the interface are skipped
+  routes = fib.Lookup (Ipv4Address ("10.1.2.3"), 3);
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[1].first, &net24b, "/24 routes not selected");
+  routes = fib.Lookup (Ipv4Address ("10.1.2.3"), 1);
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &net8, "/8 route not selected");
+  NS_TEST_EXPECT_MSG_EQ (fib.Lookup (Ipv4Address ("10.1.2.3"), 9), 0, "Unexpected match");
+
+  fib.Remove (&host);
+  fib.Remove (&net24a);
+  routes = fib.Lookup (Ipv4Address ("10.1.2.3"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_ASSERT_MSG_EQ (routes->size (), 1, "Wrong route set");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &net24b, "Wrong route after removal");
+  fib.Remove (&net24b);
+  routes = fib.Lookup (Ipv4Address ("10.1.2.3"));
+  NS_TEST_ASSERT_MSG_NE (routes, 0, "No match");
+  NS_TEST_EXPECT_MSG_EQ ((*routes)[0].first, &net8, "Wrong route after removal");
+  NS_TEST_EXPECT_MSG_EQ (fib.GetNRoutes (), 2, "Wrong number of routes");
+
+  fib.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (fib.Lookup (Ipv4Address ("10.1.2.3")), 0, "Cleared index matches");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 longest prefix match index TestSuite
+ */
+class Ipv4FibTestSuite : public TestSuite
+{
+public:
+  Ipv4FibTestSuite ();
+};
+
+Ipv4FibTestSuite::Ipv4FibTestSuite ()
+  : TestSuite ("ipv4-fib", UNIT)
+{
+  AddTestCase (new Ipv4FibTestCase, TestCase::QUICK);
+}
+
+static Ipv4FibTestSuite g_ipv4FibTestSuite; //!< Static variable for test initialization
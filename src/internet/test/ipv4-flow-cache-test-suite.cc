@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/udp-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 forwarding flow cache Test
+ */
+class Ipv4FlowCacheTestCase : public TestCase
+{
+public:
+  Ipv4FlowCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send a packet.
+   * \param socket the sending socket
+   */
+  void SendPacket (Ptr<Socket> socket);
+  /**
+   * \brief Receive the pending packets.
+   * \param socket the receiving socket
+   */
+  void ReceivePacket (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< Number of received packets
+};
+
+Ipv4FlowCacheTestCase::Ipv4FlowCacheTestCase ()
+  : TestCase ("Check the forwarding flow cache and its invalidation"),
+    m_received (0)
+{
+}
+
+void
+Ipv4FlowCacheTestCase::SendPacket (Ptr<Socket> socket)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (Ipv4Address ("192.168.1.1"), 1234));
+}
+
+void
+Ipv4FlowCacheTestCase::ReceivePacket (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+// A<--10.1.1.0/30-->B<--10.1.1.4/30-->C(192.168.1.1/32)
+void
+Ipv4FlowCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer dAdB = devHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer dBdC = devHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  ipv4.Assign (dAdB);
+  ipv4.SetBase ("10.1.1.4", "255.255.255.252");
+  ipv4.Assign (dBdC);
+
+  Ptr<SimpleNetDevice> deviceC = CreateObject<SimpleNetDevice> ();
+  deviceC->SetAddress (Mac48Address::Allocate ());
+  nodes.Get (2)->AddDevice (deviceC);
+  Ptr<Ipv4> ipv4C = nodes.Get (2)->GetObject<Ipv4> ();
+  uint32_t ifIndexC = ipv4C->AddInterface (deviceC);
+  ipv4C->AddAddress (ifIndexC, Ipv4InterfaceAddress (Ipv4Address ("192.168.1.1"), Ipv4Mask ("/32")));
+  ipv4C->SetUp (ifIndexC);
+
+  Ipv4StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (nodes.Get (0)->GetObject<Ipv4> ())
+  ->SetDefaultRoute (Ipv4Address ("10.1.1.2"), 1);
+  Ptr<Ipv4StaticRouting> routingB = routingHelper.GetStaticRouting (nodes.Get (1)->GetObject<Ipv4> ());
+  routingB->AddHostRouteTo (Ipv4Address ("192.168.1.1"), Ipv4Address ("10.1.1.6"), 2);
+  Ptr<Ipv4L3Protocol> ipv4B = nodes.Get (1)->GetObject<Ipv4L3Protocol> ();
+  ipv4B->SetAttribute ("FlowCacheSize", UintegerValue (4));
+
+  Ptr<Socket> rxSocket = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4FlowCacheTestCase::ReceivePacket, this));
+  Ptr<Socket> txSocket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Simulator::Schedule (Seconds (i), &Ipv4FlowCacheTestCase::SendPacket, this, txSocket);
+    }
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "Packets not forwarded");
+  NS_TEST_EXPECT_MSG_EQ (ipv4B->GetFlowCacheMisses (), 1, "Wrong number of misses");
+  NS_TEST_EXPECT_MSG_EQ (ipv4B->GetFlowCacheHits (), 2, "Wrong number of hits");
+
+  // removing the route invalidates the cached one
+  routingB->RemoveRoute (routingB->GetNRoutes () - 1);
+  Simulator::Schedule (Seconds (1), &Ipv4FlowCacheTestCase::SendPacket, this, txSocket);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "Packet forwarded through a stale route");
+  NS_TEST_EXPECT_MSG_EQ (ipv4B->GetFlowCacheMisses (), 2, "Wrong number of misses");
+
+  routingB->AddHostRouteTo (Ipv4Address ("192.168.1.1"), Ipv4Address ("10.1.1.6"), 2);
+  for (uint32_t i = 1; i <= 2; i++)
+    {
+      Simulator::Schedule (Seconds (i), &Ipv4FlowCacheTestCase::SendPacket, this, txSocket);
+    }
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 5, "Packets not forwarded");
+  NS_TEST_EXPECT_MSG_EQ (ipv4B->GetFlowCacheMisses (), 3, "Wrong number of misses");
+  NS_TEST_EXPECT_MSG_EQ (ipv4B->GetFlowCacheHits (), 3, "Wrong number of hits");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 forwarding flow cache TestSuite
+ */
+class Ipv4FlowCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4FlowCacheTestSuite ();
+};
+
+Ipv4FlowCacheTestSuite::Ipv4FlowCacheTestSuite ()
+  : TestSuite ("ipv4-flow-cache", UNIT)
+{
+  AddTestCase (new Ipv4FlowCacheTestCase, TestCase::QUICK);
+}
+
+static Ipv4FlowCacheTestSuite g_ipv4FlowCacheTestSuite; //!< Static variable for test initialization
@@ -15,6 +15,8 @@
  */
 
 #include <vector>
+#include <sstream>
+#include <algorithm>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -1244,6 +1246,126 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting route update test
+ *
+ * Checks that the routes computed with several SPF threads, and the routes
+ * updated after links go down, are the routes computed from scratch, on a
+ * 3x3 grid of routers connected by point-to-point links, with a LAN
+ * connecting the routers of the first row.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param nodes the routers
+   * \param sorted whether to sort the routes of each router
+   * \returns the routes of the routers
+   */
+  std::string GetRoutes (NodeContainer nodes, bool sorted);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Global routing with SPF threads and incremental route updates")
+{
+}
+
+std::string
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (NodeContainer nodes, bool sorted)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing =
+        nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (j);
+          routes.push_back (route.str ());
+        }
+      if (sorted)
+        {
+          std::sort (routes.begin (), routes.end ());
+        }
+      os << "node " << i << std::endl;
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          os << routes[j] << std::endl;
+        }
+    }
+  return os.str ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (9);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2p;
+  p2p.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      uint32_t neighbors[2] = { i % 3 < 2 ? i + 1 : 9, i + 3 };
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          if (neighbors[j] < 9)
+            {
+              Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+              NetDeviceContainer link = p2p.Install (nodes.Get (i), channel);
+              link.Add (p2p.Install (nodes.Get (neighbors[j]), channel));
+              ipv4.Assign (link);
+              ipv4.NewNetwork ();
+              links.push_back (link);
+            }
+        }
+    }
+  SimpleNetDeviceHelper lan;
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer lanDevices = lan.Install (NodeContainer (nodes.Get (0), nodes.Get (1), nodes.Get (2)), channel);
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lanDevices);
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string threaded = GetRoutes (nodes, false);
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (threaded, GetRoutes (nodes, false), "Routes differ with SPF threads");
+
+  // both ends of a link go down, then one end of another link, then the
+  // interfaces of a third link and of the LAN
+  Ptr<NetDevice> down[6] = { links[2].Get (0), links[2].Get (1), links[7].Get (0),
+                             links[6].Get (0), links[6].Get (1), lanDevices.Get (2) };
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<Ipv4> ip = down[i]->GetNode ()->GetObject<Ipv4> ();
+      ip->SetDown (ip->GetInterfaceForDevice (down[i]));
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+      std::string updated = GetRoutes (nodes, true);
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      NS_TEST_EXPECT_MSG_EQ (updated, GetRoutes (nodes, true), "Updated routes differ from recomputed routes (step " << i << ")");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1389,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -39,6 +39,8 @@
 #include "ns3/ipv4-static-routing.h"
 #include "ns3/traffic-control-layer.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
 
 #include <string>
 #include <sstream>
@@ -265,6 +267,86 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header View Test
+ */
+class Ipv4HeaderViewTest : public TestCase
+{
+public:
+  Ipv4HeaderViewTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the fields read through a view against the original headers.
+   * \param p the packet holding the headers
+   * \param ipHeader the IPv4 header
+   * \param udpHeader the UDP header
+   */
+  void CheckView (Ptr<const Packet> p, const Ipv4Header &ipHeader, const UdpHeader &udpHeader);
+};
+
+Ipv4HeaderViewTest::Ipv4HeaderViewTest ()
+  : TestCase ("IPv4 header view test")
+{
+}
+
+void
+Ipv4HeaderViewTest::CheckView (Ptr<const Packet> p, const Ipv4Header &ipHeader, const UdpHeader &udpHeader)
+{
+  Ipv4HeaderView ipView (p);
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetSource (), ipHeader.GetSource (), "Wrong source");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetDestination (), ipHeader.GetDestination (), "Wrong destination");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetProtocol (), ipHeader.GetProtocol (), "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetTtl (), ipHeader.GetTtl (), "Wrong TTL");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetTos (), ipHeader.GetTos (), "Wrong TOS");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetIdentification (), ipHeader.GetIdentification (), "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetFragmentOffset (), ipHeader.GetFragmentOffset (), "Wrong fragment offset");
+  NS_TEST_EXPECT_MSG_EQ (ipView.IsLastFragment (), ipHeader.IsLastFragment (), "Wrong MF flag");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetPayloadSize (), ipHeader.GetPayloadSize (), "Wrong payload size");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetSerializedSize (), ipHeader.GetSerializedSize (), "Wrong header size");
+
+  Ptr<Packet> copy = p->Copy ();
+  Ipv4Header tmp;
+  copy->RemoveHeader (tmp);
+  UdpHeaderView udpView (copy);
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetSourcePort (), udpHeader.GetSourcePort (), "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetDestinationPort (), udpHeader.GetDestinationPort (), "Wrong destination port");
+}
+
+void
+Ipv4HeaderViewTest::DoRun (void)
+{
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (1234);
+  udpHeader.SetDestinationPort (80);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (17);
+  ipHeader.SetTtl (23);
+  ipHeader.SetTos (0xb8);
+  ipHeader.SetIdentification (4321);
+  ipHeader.SetMoreFragments ();
+  ipHeader.SetFragmentOffset (1480);
+  ipHeader.SetPayloadSize (100 + udpHeader.GetSerializedSize ());
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (udpHeader);
+  p->AddHeader (ipHeader);
+  Ipv4HeaderView direct (p);
+  NS_TEST_EXPECT_MSG_EQ (direct.IsDirect (), true, "Headers should be read in place");
+  CheckView (p, ipHeader, udpHeader);
+
+  // a packet which is made only of virtual zero bytes falls back to deserialization
+  Ptr<Packet> zeroes = Create<Packet> (100);
+  Ipv4HeaderView fallback (zeroes);
+  NS_TEST_EXPECT_MSG_EQ (fallback.IsDirect (), false, "Zero area should not be read in place");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +359,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderViewTest, TestCase::QUICK);
   }
 };
 
@@ -24,6 +24,8 @@
 #include "ns3/log.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/node.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/arp-l3-protocol.h"
@@ -131,6 +133,33 @@ Ipv4L3ProtocolTestCase::DoRun (void)
   num = interface->GetNAddresses ();
   NS_TEST_ASSERT_MSG_EQ (num, 1, "Should find 1 addresses??");
 
+  /* Identification counters */
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  Ipv4Address c ("10.0.0.3");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 17), 0, "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 17), 1, "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, c, 17), 0, "Counter shared by destinations");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 6), 0, "Counter shared by protocols");
+
+  ipv4->SetAttribute ("IdentificationMode", EnumValue (Ipv4L3Protocol::ID_PER_SOURCE));
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 17), 0, "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, c, 6), 1, "Counter not shared by destinations");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (c, b, 17), 0, "Counter shared by sources");
+
+  ipv4->SetAttribute ("IdentificationMode", EnumValue (Ipv4L3Protocol::ID_HASHED));
+  ipv4->SetAttribute ("IdentificationTableSize", UintegerValue (1));
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 17), 0, "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (c, b, 6), 1, "Counter not shared");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->m_identification.size (), 5, "Hashed counters stored per tuple");
+
+  // the idle counters are removed after the fragment expiration timeout
+  ipv4->SetAttribute ("IdentificationMode", EnumValue (Ipv4L3Protocol::ID_PER_TUPLE));
+  Simulator::Stop (Seconds (31));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (ipv4->GetNextIdentification (a, b, 17), 0, "Idle counter not removed");
+  NS_TEST_EXPECT_MSG_EQ (ipv4->m_identification.size (), 1, "Idle counters not removed");
+
   Simulator::Destroy ();
 }
 
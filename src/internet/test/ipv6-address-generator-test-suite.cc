@@ -300,6 +300,12 @@ AddressCollision6TestCase::DoRun (void)
 
   added = Ipv6AddressGenerator::AddAllocated ("0::0:21");
   NS_TEST_EXPECT_MSG_EQ (added, false, "address should not get allocated");
+
+  // the blocks merged into ::1-::9, ::10-::19 and ::20-::21
+  NS_TEST_EXPECT_MSG_EQ (Ipv6AddressGenerator::IsAddressAllocated ("0::0:15"), false, "address should be allocated");
+  NS_TEST_EXPECT_MSG_EQ (Ipv6AddressGenerator::IsAddressAllocated ("0::0:1a"), true, "address should not be allocated");
+  NS_TEST_EXPECT_MSG_EQ (Ipv6AddressGenerator::IsNetworkAllocated ("0::0:14", Ipv6Prefix (126)), false, "network should be allocated");
+  NS_TEST_EXPECT_MSG_EQ (Ipv6AddressGenerator::IsNetworkAllocated ("0::0:1c", Ipv6Prefix (126)), true, "network should not be allocated");
 }
 
 
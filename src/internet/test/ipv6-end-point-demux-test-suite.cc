@@ -0,0 +1,321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv6-interface.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 end point demux Test
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the end point lookups and their index updates")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listener = demux.Allocate (0, Ipv6Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Allocation failed");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, Ipv6Address::GetAny (), 80), 0, "Duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "Port not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv6Address::GetAny (), 80), true, "Binding not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, local, 80), false, "Unexpected binding");
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+
+  // connected end points take precedence over the listening one
+  Ipv6EndPoint *connected = demux.Allocate (0, local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Allocation failed");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1234), 0, "Duplicated end point allocated");
+  endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "Exact end point not preferred");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), connected, "Exact end point not found");
+  endPoints = demux.Lookup (local, 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+
+  // the demux follows the changes of the end points
+  Ipv6EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Allocation failed");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "Ephemeral port not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 22, interface).size (), 1, "End point not found");
+  client->SetPeer (peer, 22);
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 23, interface).size (), 0, "Unexpected end point");
+  endPoints = demux.Lookup (local, port, peer, 22, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), client, "Connected end point not found");
+  client->SetLocalAddress (Ipv6Address ("2001:1::3"));
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, port, peer, 22, interface).size (), 0, "Unexpected end point");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv6Address ("2001:1::3"), port), true, "Binding not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, local, port), false, "Stale binding");
+
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (local)->GetLocalPort (), port + 1, "Wrong ephemeral port");
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "Wildcard end point not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 2, "Wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 end point demux indexes Test
+ *
+ * Check that the indexed lookups return the end points found by a scan of
+ * all the end points, for wildcard, exact and connected end points, bound
+ * or not to a NetDevice, while they are bound and removed.
+ */
+class Ipv6EndPointDemuxScanTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxScanTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Look up the end points by scanning all of them.
+   * \param demux the demux
+   * \param daddr the destination address
+   * \param dport the destination port
+   * \param saddr the source address
+   * \param sport the source port
+   * \param incomingInterface the incoming interface, 0 if unknown
+   * \returns the most exact matches
+   */
+  Ipv6EndPointDemux::EndPoints Scan (const Ipv6EndPointDemux &demux,
+                                     Ipv6Address daddr, uint16_t dport,
+                                     Ipv6Address saddr, uint16_t sport,
+                                     Ptr<Ipv6Interface> incomingInterface);
+  /**
+   * Compare the indexed lookups and the scans for all the combinations of
+   * the test addresses, ports and interfaces.
+   * \param demux the demux
+   * \param step the description of the current step of the test
+   */
+  void CheckLookups (Ipv6EndPointDemux &demux, std::string step);
+
+  std::vector<Ipv6Address> m_addresses;            //!< the addresses looked up
+  std::vector<uint16_t> m_ports;                   //!< the ports looked up
+  std::vector<Ptr<Ipv6Interface> > m_interfaces;   //!< the incoming interfaces
+};
+
+Ipv6EndPointDemuxScanTestCase::Ipv6EndPointDemuxScanTestCase ()
+  : TestCase ("Check the indexed end point lookups against a scan")
+{
+}
+
+Ipv6EndPointDemux::EndPoints
+Ipv6EndPointDemuxScanTestCase::Scan (const Ipv6EndPointDemux &demux,
+                                     Ipv6Address daddr, uint16_t dport,
+                                     Ipv6Address saddr, uint16_t sport,
+                                     Ptr<Ipv6Interface> incomingInterface)
+{
+  Ipv6EndPointDemux::EndPoints exact;
+  Ipv6EndPointDemux::EndPoints remote;
+  Ipv6EndPointDemux::EndPoints local;
+  Ipv6EndPointDemux::EndPoints wildcard;
+  Ipv6EndPointDemux::EndPoints endPoints = demux.GetEndPoints ();
+  for (Ipv6EndPointDemux::EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv6EndPoint *endP = *i;
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice ()
+          && (!incomingInterface || endP->GetBoundNetDevice () != incomingInterface->GetDevice ()))
+        {
+          continue;
+        }
+      bool localWildcard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == daddr;
+      bool peerWildcard = endP->GetPeerPort () == 0 && endP->GetPeerAddress () == Ipv6Address::GetAny ();
+      bool peerExact = endP->GetPeerPort () == sport && endP->GetPeerAddress () == saddr;
+      if (localExact && peerExact)
+        {
+          exact.push_back (endP);
+        }
+      else if (localWildcard && peerExact)
+        {
+          remote.push_back (endP);
+        }
+      else if (localExact && peerWildcard)
+        {
+          local.push_back (endP);
+        }
+      else if (localWildcard && peerWildcard)
+        {
+          wildcard.push_back (endP);
+        }
+    }
+  if (!exact.empty ())
+    {
+      return exact;
+    }
+  if (!remote.empty ())
+    {
+      return remote;
+    }
+  if (!local.empty ())
+    {
+      return local;
+    }
+  return wildcard;
+}
+
+void
+Ipv6EndPointDemuxScanTestCase::CheckLookups (Ipv6EndPointDemux &demux, std::string step)
+{
+  for (std::vector<Ipv6Address>::const_iterator daddr = m_addresses.begin (); daddr != m_addresses.end (); daddr++)
+    {
+      for (std::vector<uint16_t>::const_iterator dport = m_ports.begin (); dport != m_ports.end (); dport++)
+        {
+          for (std::vector<Ipv6Address>::const_iterator saddr = m_addresses.begin (); saddr != m_addresses.end (); saddr++)
+            {
+              for (uint16_t sport = 1234; sport <= 1235; sport++)
+                {
+                  for (uint32_t i = 0; i < m_interfaces.size (); i++)
+                    {
+                      Ipv6EndPointDemux::EndPoints found = demux.Lookup (*daddr, *dport, *saddr, sport, m_interfaces[i]);
+                      Ipv6EndPointDemux::EndPoints expected = Scan (demux, *daddr, *dport, *saddr, sport, m_interfaces[i]);
+                      NS_TEST_EXPECT_MSG_EQ ((found == expected), true,
+                                             step << ": wrong end points for " << *daddr << " " << *dport
+                                                  << " from " << *saddr << " " << sport << " on interface " << i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+Ipv6EndPointDemuxScanTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+  m_addresses.push_back (local);
+  m_addresses.push_back (peer);
+  m_addresses.push_back (Ipv6Address ("2001:1::3"));
+  m_ports.push_back (80);
+  m_ports.push_back (81);
+  m_ports.push_back (82);
+
+  Ptr<SimpleNetDevice> deviceA = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> deviceB = CreateObject<SimpleNetDevice> ();
+  Ptr<Ipv6Interface> interfaceA = CreateObject<Ipv6Interface> ();
+  interfaceA->SetDevice (deviceA);
+  Ptr<Ipv6Interface> interfaceB = CreateObject<Ipv6Interface> ();
+  interfaceB->SetDevice (deviceB);
+  m_interfaces.push_back (0);
+  m_interfaces.push_back (interfaceA);
+  m_interfaces.push_back (interfaceB);
+
+  // the end points are bound to their device after their allocation, as
+  // the sockets do
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *wildcardA = demux.Allocate (deviceA, 80);
+  NS_TEST_ASSERT_MSG_NE (wildcardA, 0, "Allocation failed");
+  wildcardA->BindToNetDevice (deviceA);
+  Ipv6EndPoint *wildcardB = demux.Allocate (deviceB, 80);
+  NS_TEST_ASSERT_MSG_NE (wildcardB, 0, "Allocation failed");
+  wildcardB->BindToNetDevice (deviceB);
+  Ipv6EndPoint *exact = demux.Allocate (0, local, 80);
+  Ipv6EndPoint *connected = demux.Allocate (0, local, 80, peer, 1234);
+  Ipv6EndPoint *wildcard = demux.Allocate (0, 81);
+  Ipv6EndPoint *connectedA = demux.Allocate (deviceA, local, 81, peer, 1234);
+  Ipv6EndPoint *disabled = demux.Allocate (0, local, 82);
+  NS_TEST_ASSERT_MSG_EQ ((exact && connected && wildcard && connectedA && disabled), true, "Allocation failed");
+  connectedA->BindToNetDevice (deviceA);
+  disabled->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (deviceA, 80), 0, "Duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (deviceB, Ipv6Address::GetAny (), 80), true, "Binding not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv6Address::GetAny (), 80), false, "Unexpected binding");
+
+  CheckLookups (demux, "allocation");
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (peer, 80, local, 1234, interfaceB);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), wildcardB, "Bound wildcard end point not found");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (peer, 80, local, 1234, 0).size (), 0, "Bound end point found without interface");
+  endPoints = demux.Lookup (local, 81, peer, 1234, interfaceB);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), wildcard, "End point bound to another device not skipped");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, 82, peer, 1234, interfaceA).size (), 0, "Disabled end point found");
+
+  exact->BindToNetDevice (deviceB);
+  CheckLookups (demux, "binding");
+  endPoints = demux.Lookup (local, 80, peer, 1235, interfaceA);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), wildcardA, "End point bound to another device not skipped");
+
+  demux.DeAllocate (connected);
+  demux.DeAllocate (wildcardA);
+  CheckLookups (demux, "removal");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (peer, 80, local, 1234, interfaceA).size (), 0, "Removed end point found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (deviceA, Ipv6Address::GetAny (), 80), false, "Stale binding");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 5, "Wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 end point demux TestSuite
+ */
+class Ipv6EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv6EndPointDemuxTestSuite ();
+};
+
+Ipv6EndPointDemuxTestSuite::Ipv6EndPointDemuxTestSuite ()
+  : TestSuite ("ipv6-end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxScanTestCase, TestCase::QUICK);
+}
+
+static Ipv6EndPointDemuxTestSuite g_ipv6EndPointDemuxTestSuite; //!< Static variable for test initialization
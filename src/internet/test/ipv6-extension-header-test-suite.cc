@@ -19,6 +19,9 @@
 #include "ns3/test.h"
 #include "ns3/ipv6-extension-header.h"
 #include "ns3/ipv6-option-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -250,6 +253,72 @@ public:
   }
 };
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 header view, followed by an extension header.
+ */
+class TestIpv6HeaderView : public TestCase
+{
+public:
+  TestIpv6HeaderView () : TestCase ("TestIpv6HeaderView") {}
+
+  virtual void DoRun ()
+  {
+    TcpHeader tcpHeader;
+    tcpHeader.SetSourcePort (1234);
+    tcpHeader.SetDestinationPort (80);
+    tcpHeader.SetFlags (TcpHeader::SYN);
+
+    Ipv6ExtensionHopByHopHeader hopByHopHeader;
+    hopByHopHeader.SetNextHeader (6);
+    hopByHopHeader.AddOption (Ipv6OptionJumbogramHeader ());
+
+    Ipv6Header ipHeader;
+    ipHeader.SetSourceAddress (Ipv6Address ("2001:db8::1"));
+    ipHeader.SetDestinationAddress (Ipv6Address ("2001:db8::2"));
+    ipHeader.SetNextHeader (Ipv6Header::IPV6_EXT_HOP_BY_HOP);
+    ipHeader.SetHopLimit (17);
+    ipHeader.SetTrafficClass (0xb8);
+    ipHeader.SetPayloadLength (100 + hopByHopHeader.GetSerializedSize () + tcpHeader.GetSerializedSize ());
+
+    Ptr<Packet> p = Create<Packet> (100);
+    p->AddHeader (tcpHeader);
+    p->AddHeader (hopByHopHeader);
+    p->AddHeader (ipHeader);
+
+    Ipv6HeaderView view (p);
+    NS_TEST_EXPECT_MSG_EQ (view.IsDirect (), true, "header should be read in place");
+    NS_TEST_EXPECT_MSG_EQ (view.GetSourceAddress (), ipHeader.GetSourceAddress (), "wrong source address");
+    NS_TEST_EXPECT_MSG_EQ (view.GetDestinationAddress (), ipHeader.GetDestinationAddress (), "wrong destination address");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (view.GetNextHeader ()), uint32_t (Ipv6Header::IPV6_EXT_HOP_BY_HOP), "wrong next header");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (view.GetHopLimit ()), 17, "wrong hop limit");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (view.GetTrafficClass ()), 0xb8, "wrong traffic class");
+    NS_TEST_EXPECT_MSG_EQ (view.GetPayloadLength (), ipHeader.GetPayloadLength (), "wrong payload length");
+
+    // the view of the transport header follows the extension header
+    Ptr<Packet> copy = p->Copy ();
+    copy->RemoveHeader (ipHeader);
+    Ipv6ExtensionHopByHopHeader tmp;
+    copy->RemoveHeader (tmp);
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (tmp.GetNextHeader ()), 6, "wrong extension next header");
+    TcpHeaderView tcpView (copy);
+    NS_TEST_EXPECT_MSG_EQ (tcpView.IsDirect (), true, "TCP header should be read in place");
+    NS_TEST_EXPECT_MSG_EQ (tcpView.GetSourcePort (), 1234, "wrong source port");
+    NS_TEST_EXPECT_MSG_EQ (tcpView.GetDestinationPort (), 80, "wrong destination port");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (tcpView.GetFlags ()), uint32_t (TcpHeader::SYN), "wrong flags");
+
+    // a truncated header returns the default fields
+    Ipv6HeaderView truncated (p->CreateFragment (0, 30));
+    Ipv6Header defaults;
+    NS_TEST_EXPECT_MSG_EQ (truncated.IsTruncated (), true, "header should be truncated");
+    NS_TEST_EXPECT_MSG_EQ (truncated.GetSourceAddress (), defaults.GetSourceAddress (), "wrong default source address");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (truncated.GetNextHeader ()), uint32_t (defaults.GetNextHeader ()), "wrong default next header");
+    NS_TEST_EXPECT_MSG_EQ (truncated.GetPayloadLength (), defaults.GetPayloadLength (), "wrong default payload length");
+  }
+};
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -266,6 +335,7 @@ public:
     AddTestCase (new TestOptionWithoutAlignment, TestCase::QUICK);
     AddTestCase (new TestOptionWithAlignment, TestCase::QUICK);
     AddTestCase (new TestFulfilledAlignment, TestCase::QUICK);
+    AddTestCase (new TestIpv6HeaderView, TestCase::QUICK);
 
   }
 };
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/udp-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor cache population Test
+ *
+ * Three dual-stack nodes share a channel. The caches of the first node
+ * must hold the addresses of the two others, and the packets it sends
+ * must be delivered after a single channel delay, without any address
+ * resolution.
+ */
+class NeighborCachePopulateTestCase : public TestCase
+{
+public:
+  /**
+   * \param permanent whether the helper adds permanent entries
+   */
+  NeighborCachePopulateTestCase (bool permanent);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send a packet.
+   * \param socket the sending socket
+   * \param to the destination
+   */
+  void SendPacket (Ptr<Socket> socket, Address to);
+  /**
+   * \brief Receive the pending packets.
+   * \param socket the receiving socket
+   */
+  void ReceivePacket (Ptr<Socket> socket);
+
+  bool m_permanent;                 //!< Whether the helper adds permanent entries
+  std::vector<Time> m_receiveTimes; //!< Reception times of the packets
+};
+
+NeighborCachePopulateTestCase::NeighborCachePopulateTestCase (bool permanent)
+  : TestCase (permanent ? "Check the permanent neighbor cache entries"
+              : "Check the dynamic neighbor cache entries"),
+    m_permanent (permanent)
+{
+}
+
+void
+NeighborCachePopulateTestCase::SendPacket (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, to);
+}
+
+void
+NeighborCachePopulateTestCase::ReceivePacket (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_receiveTimes.push_back (Simulator::Now ());
+    }
+}
+
+void
+NeighborCachePopulateTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (devices);
+
+  NeighborCacheHelper neighborCache;
+  neighborCache.SetPermanent (m_permanent);
+  neighborCache.PopulateNeighborCache (devices);
+
+  Ptr<ArpCache> arpCache = nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->GetInterface (1)->GetArpCache ();
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      Ipv4Address address = nodes.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+      ArpCache::Entry *entry = arpCache->Lookup (address);
+      NS_TEST_ASSERT_MSG_NE (entry, 0, "No ARP entry for " << address);
+      NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (i)->GetAddress (), "Wrong MAC address");
+      NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), m_permanent, "Wrong entry state");
+      NS_TEST_EXPECT_MSG_EQ (entry->IsAlive (), !m_permanent, "Wrong entry state");
+    }
+  NS_TEST_EXPECT_MSG_EQ (arpCache->Lookup (Ipv4Address ("10.1.1.1")), 0, "Own address in the cache");
+
+  Ptr<Ipv6Interface> ipv6Interface = nodes.Get (0)->GetObject<Ipv6L3Protocol> ()->GetInterface (1);
+  Ptr<Ipv6L3Protocol> ipv6Peer = nodes.Get (2)->GetObject<Ipv6L3Protocol> ();
+  NS_TEST_EXPECT_MSG_EQ (ipv6Peer->GetNAddresses (1), 2, "Wrong number of addresses");
+  for (uint32_t i = 0; i < ipv6Peer->GetNAddresses (1); i++)
+    {
+      Ipv6Address address = ipv6Peer->GetAddress (1, i).GetAddress ();
+      NdiscCache::Entry *entry = ipv6Interface->GetNdiscCache ()->Lookup (address);
+      NS_TEST_ASSERT_MSG_NE (entry, 0, "No NDISC entry for " << address);
+      NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (2)->GetAddress (), "Wrong MAC address");
+      NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), m_permanent, "Wrong entry state");
+      NS_TEST_EXPECT_MSG_EQ (entry->IsReachable (), !m_permanent, "Wrong entry state");
+    }
+
+  Ptr<Socket> rxSocket = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&NeighborCachePopulateTestCase::ReceivePacket, this));
+  Ptr<Socket> rxSocket6 = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  rxSocket6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  rxSocket6->SetRecvCallback (MakeCallback (&NeighborCachePopulateTestCase::ReceivePacket, this));
+
+  Ptr<Socket> txSocket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  Address to = InetSocketAddress (nodes.Get (2)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal (), 1234);
+  Simulator::Schedule (Seconds (1), &NeighborCachePopulateTestCase::SendPacket, this, txSocket, to);
+  Ptr<Socket> txSocket6 = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  Address to6 = Inet6SocketAddress (ipv6Peer->GetAddress (1, 1).GetAddress (), 1234);
+  Simulator::Schedule (Seconds (2), &NeighborCachePopulateTestCase::SendPacket, this, txSocket6, to6);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_receiveTimes.size (), 2, "Packets not received");
+  NS_TEST_EXPECT_MSG_EQ (m_receiveTimes[0], Seconds (1) + MilliSeconds (1), "IPv4 address resolved again");
+  NS_TEST_EXPECT_MSG_EQ (m_receiveTimes[1], Seconds (2) + MilliSeconds (1), "IPv6 address resolved again");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor cache population TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite ();
+};
+
+NeighborCacheTestSuite::NeighborCacheTestSuite ()
+  : TestSuite ("neighbor-cache", UNIT)
+{
+  AddTestCase (new NeighborCachePopulateTestCase (true), TestCase::QUICK);
+  AddTestCase (new NeighborCachePopulateTestCase (false), TestCase::QUICK);
+}
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
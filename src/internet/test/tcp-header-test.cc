@@ -24,6 +24,9 @@
 #include "ns3/tcp-header.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-option-rfc793.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/tcp-option-winscale.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -420,6 +423,99 @@ TcpHeaderFlagsToString::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (str, target, "str " << str <<  " does not equal target " << target);
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP header view test.
+ */
+class TcpHeaderViewTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name Test description.
+   */
+  TcpHeaderViewTestCase (std::string name);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the fields read through a view against the original header.
+   * \param p the packet holding the header
+   * \param header the TCP header
+   * \param direct true if the view must read the packet bytes in place
+   */
+  void CheckView (Ptr<const Packet> p, const TcpHeader &header, bool direct);
+};
+
+TcpHeaderViewTestCase::TcpHeaderViewTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+TcpHeaderViewTestCase::CheckView (Ptr<const Packet> p, const TcpHeader &header, bool direct)
+{
+  TcpHeaderView view (p);
+  NS_TEST_EXPECT_MSG_EQ (view.IsDirect (), direct, "Wrong view access");
+  NS_TEST_EXPECT_MSG_EQ (view.IsTruncated (), false, "Header should be complete");
+  NS_TEST_EXPECT_MSG_EQ (view.GetSourcePort (), header.GetSourcePort (), "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (view.GetDestinationPort (), header.GetDestinationPort (), "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (view.GetSequenceNumber (), header.GetSequenceNumber (), "Wrong sequence number");
+  NS_TEST_EXPECT_MSG_EQ (view.GetAckNumber (), header.GetAckNumber (), "Wrong ack number");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (view.GetLength ()), uint32_t (header.GetLength ()), "Wrong length");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (view.GetFlags ()), uint32_t (header.GetFlags ()), "Wrong flags");
+  NS_TEST_EXPECT_MSG_EQ (view.GetWindowSize (), header.GetWindowSize (), "Wrong window size");
+}
+
+void
+TcpHeaderViewTestCase::DoRun (void)
+{
+  TcpHeader header;
+  header.SetSourcePort (49152);
+  header.SetDestinationPort (80);
+  header.SetSequenceNumber (SequenceNumber32 (0x80000001));
+  header.SetAckNumber (SequenceNumber32 (12345));
+  header.SetFlags (TcpHeader::SYN | TcpHeader::ACK | TcpHeader::PSH);
+  header.SetWindowSize (0xfedc);
+
+  // without options, read in place
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (header);
+  CheckView (p, header, true);
+
+  // the options only change the length field
+  TcpHeader withOptions = header;
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (1000);
+  ts->SetEcho (999);
+  withOptions.AppendOption (ts);
+  Ptr<TcpOptionWinScale> winScale = CreateObject<TcpOptionWinScale> ();
+  winScale->SetScale (7);
+  withOptions.AppendOption (winScale);
+  NS_TEST_ASSERT_MSG_GT (uint32_t (withOptions.GetLength ()), 5, "Options should extend the header");
+  p = Create<Packet> (100);
+  p->AddHeader (withOptions);
+  CheckView (p, withOptions, true);
+
+  // a header ending in a zero area falls back to deserialization
+  Ptr<Packet> headerOnly = Create<Packet> ();
+  headerOnly->AddHeader (header);
+  p = headerOnly->CreateFragment (0, 16);
+  p->AddAtEnd (Create<Packet> (4));
+  CheckView (p, header, false);
+
+  // a truncated header is not deserialized
+  p = headerOnly->CreateFragment (0, 12);
+  TcpHeaderView truncated (p);
+  TcpHeader defaults;
+  NS_TEST_EXPECT_MSG_EQ (truncated.IsTruncated (), true, "Header should be truncated");
+  NS_TEST_EXPECT_MSG_EQ (truncated.IsDirect (), false, "Truncated header should not be read in place");
+  NS_TEST_EXPECT_MSG_EQ (truncated.GetSourcePort (), defaults.GetSourcePort (), "Wrong default source port");
+  NS_TEST_EXPECT_MSG_EQ (truncated.GetSequenceNumber (), defaults.GetSequenceNumber (), "Wrong default sequence number");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (truncated.GetFlags ()), uint32_t (defaults.GetFlags ()), "Wrong default flags");
+}
 
 /**
  * \ingroup internet-test
@@ -436,6 +532,7 @@ public:
     AddTestCase (new TcpHeaderGetSetTestCase ("GetSet test cases"), TestCase::QUICK);
     AddTestCase (new TcpHeaderWithRFC793OptionTestCase ("Test for options in RFC 793"), TestCase::QUICK);
     AddTestCase (new TcpHeaderFlagsToString ("Test flags to string function"), TestCase::QUICK);
+    AddTestCase (new TcpHeaderViewTestCase ("Test the read-only header view"), TestCase::QUICK);
   }
 
 };
@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of reordered segments.
+   */
+  void TestReassembly ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReassembly ();
 }
 
 void
@@ -338,6 +344,86 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReassembly ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = static_cast<uint8_t> (i);
+    }
+  rxBuf.SetMaxBufferSize (sizeof (data));
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Ten segments of 100 bytes: the odd ones first, then the even ones
+  // but the first one, then a segment overlapping the first two
+  std::vector<Ptr<Packet> > segments;
+  for (uint32_t i = 1; i < 10; i += 2)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * 100));
+      segments.push_back (Create<Packet> (data + i * 100, 100));
+      rxBuf.Add (segments.back (), h);
+    }
+  TcpOptionSack::SackList sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4, "SACK list should contain four elements");
+  for (uint32_t i = 2; i < 10; i += 2)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * 100));
+      rxBuf.Add (Create<Packet> (data + i * 100, 100), h);
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "Data available with a hole at the head");
+  for (uint32_t i = 0; i < segments.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (segments[i]->GetSize (), 100, "Added packet modified");
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 900, "Wrong buffer occupancy");
+
+  // The whole received range is reported, including the blocks which were
+  // not in the SACK list anymore
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1, "SACK list should contain one element");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (101),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (1001),
+                         "SACK block different than expected");
+
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (data, 200), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1001),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 1000, "Wrong available data");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should be empty");
+
+  uint8_t out[1000];
+  Ptr<Packet> p = rxBuf.Extract (150);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 150, "Wrong extracted size");
+  p->CopyData (out, 150);
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 850, "Wrong extracted size");
+  p->CopyData (out + 150, 850);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Data left in the buffer");
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (out[i]), static_cast<uint32_t> (data[i]),
+                             "Data differs at byte " << i);
+    }
+
+  // A new hole after the extracted data
+  h.SetSequenceNumber (SequenceNumber32 (1101));
+  rxBuf.Add (Create<Packet> (data, 100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "Data available with a hole at the head");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 1, "SACK list should contain one element");
+  h.SetSequenceNumber (SequenceNumber32 (1001));
+  rxBuf.Add (Create<Packet> (data, 100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1201),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 200, "Wrong available data");
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 200, "Wrong extracted size");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
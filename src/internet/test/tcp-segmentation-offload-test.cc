@@ -0,0 +1,157 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/tcp-header.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentationOffloadTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the transfer of data with segmentation offload
+ *
+ * The sender sends the new data as super-segments, each one acknowledged
+ * at once by the receiver. The checks, performed in FinalChecks, are that
+ * super-segments have been sent, that the receiver sent fewer ACKs than it
+ * would have for single segments, and that the application received all
+ * the data, even when a super-segment is lost.
+ */
+class TcpSegmentationOffloadTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param desc Test description.
+   * \param seqToKill Sequence number of the super-segment to drop, or 0
+   */
+  TcpSegmentationOffloadTest (const std::string &desc, uint32_t seqToKill);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureEnvironment ();
+  virtual void ReceivePacket (Ptr<Socket> socket);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  uint32_t m_seqToKill;     //!< Sequence number to drop
+  uint32_t m_superSegments; //!< Number of super-segments sent
+  uint32_t m_acks;          //!< Number of pure ACKs sent by the receiver
+  uint32_t m_rxBytes;       //!< Bytes received by the application
+};
+
+TcpSegmentationOffloadTest::TcpSegmentationOffloadTest (const std::string &desc, uint32_t seqToKill)
+  : TcpGeneralTest (desc),
+    m_seqToKill (seqToKill),
+    m_superSegments (0),
+    m_acks (0),
+    m_rxBytes (0)
+{
+}
+
+void
+TcpSegmentationOffloadTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (200);
+  SetAppPktSize (500);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpSegmentationOffloadTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("SegmentationOffload", BooleanValue (true));
+
+  return socket;
+}
+
+Ptr<ErrorModel>
+TcpSegmentationOffloadTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  if (m_seqToKill != 0)
+    {
+      errorModel->AddSeqToKill (SequenceNumber32 (m_seqToKill));
+    }
+
+  return errorModel;
+}
+
+void
+TcpSegmentationOffloadTest::ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+
+  while ((packet = socket->RecvFrom (from)))
+    {
+      m_rxBytes += packet->GetSize ();
+    }
+}
+
+void
+TcpSegmentationOffloadTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && p->GetSize () > GetSegSize (SENDER))
+    {
+      NS_LOG_INFO ("\tSENDER super-segment " << h << " size " << p->GetSize ());
+      m_superSegments++;
+    }
+  else if (who == RECEIVER && p->GetSize () == 0 && h.GetFlags () == TcpHeader::ACK)
+    {
+      m_acks++;
+    }
+}
+
+void
+TcpSegmentationOffloadTest::FinalChecks ()
+{
+  uint32_t segments = GetPktSize () * GetPktCount () / GetSegSize (SENDER);
+  NS_TEST_EXPECT_MSG_GT (m_superSegments, 0, "No super-segment sent");
+  NS_TEST_EXPECT_MSG_LT (m_acks, segments / 4, "Super-segments not acknowledged at once");
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, GetPktSize () * GetPktCount (), "Data not received");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite: segmentation offload
+ */
+class TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentationOffloadTestSuite ()
+    : TestSuite ("tcp-segmentation-offload", UNIT)
+  {
+    AddTestCase (new TcpSegmentationOffloadTest ("Transfer with super-segments", 0), TestCase::QUICK);
+    // with an initial window of 1 segment, the third flight is a
+    // super-segment of 4 segments starting at 1501
+    AddTestCase (new TcpSegmentationOffloadTest ("Transfer with a lost super-segment", 1501), TestCase::QUICK);
+  }
+};
+
+static TcpSegmentationOffloadTestSuite g_tcpSegmentationOffloadTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard with a window of thousands of segments */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -342,6 +346,72 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 1000;
+  uint32_t segments = 2000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segmentSize * segments);
+  txBuf.Add (Create<Packet> (segmentSize * segments));
+
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every even segment but the first one is received
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t i = 2; i < segments; i += 2)
+    {
+      sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * i),
+                                                    head + (segmentSize * (i + 1))));
+      txBuf.Update (sack->GetSackList ());
+      sack->ClearSackList ();
+    }
+
+  // The first segment and the odd ones with 3 sacked segments above are lost
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * (segments / 2 - 1),
+                         "Wrong sacked count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * (segments / 2 - 2),
+                         "Wrong lost count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 3,
+                         "Wrong bytes in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 3)), true,
+                         "Segment not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 4)), false,
+                         "Sacked segment lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * (segments - 5))), false,
+                         "Segment lost without enough sacked segments above");
+
+  // The lost segments are retransmitted in order
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head, "Wrong segment to retransmit");
+  txBuf.CopyFromSequence (segmentSize, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + segmentSize, "Wrong segment to retransmit");
+  txBuf.CopyFromSequence (segmentSize, ret);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 3), "Wrong segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 5,
+                         "Wrong bytes in flight after retransmissions");
+
+  // The cumulative ACK of the first retransmission leaves the next one as head
+  txBuf.DiscardUpTo (head + segmentSize);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsHeadRetransmitted (), true, "Head not retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No segment to retransmit");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 3), "Wrong segment to retransmit");
+
+  txBuf.DiscardUpTo (head + (segmentSize * segments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0, "Bytes in flight with empty buffer");
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
@@ -152,6 +152,9 @@ private:
 
   Ptr<const SpectrumValue> m_noise; ///< the noise value
 
+  SpectrumValue m_interf; ///< the interference of the last chunk, reused by the chunks to avoid allocations
+  SpectrumValue m_sinr; ///< the SINR of the last chunk, reused by the chunks to avoid allocations
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
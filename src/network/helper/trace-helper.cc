@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/compressed-file-buf.h"
 
 #include "trace-helper.h"
 
@@ -55,6 +56,10 @@ PcapHelper::CreateFile (
 {
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
+  CompressedFileBuf::Format format = CompressedFileBuf::ResolveFormat (filename, filemode | std::ios::out);
+  NS_ABORT_MSG_UNLESS (CompressedFileBuf::IsSupported (format), "Unable to Open " << filename << ": " <<
+                       CompressedFileBuf::GetLibraryName (format) << " was not found at configure time");
+
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
@@ -208,6 +213,17 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, std::ios::openmode filemode)
+{
+  NS_LOG_FUNCTION (filename << filemode);
+
+  Ptr<BinaryTraceFile> file = Create<BinaryTraceFile> (filename, filemode);
+  NS_ABORT_MSG_IF (file->Fail (), "AsciiTraceHelper::CreateBinaryFileStream():  " <<
+                   "Unable to Open " << filename << " for mode " << filemode);
+  return Create<OutputStreamWrapper> (file);
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -310,6 +326,11 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('+', "", p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +338,11 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('+', context, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +362,11 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('d', "", p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +374,11 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('d', context, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +399,11 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('-', "", p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +411,11 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('-', context, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +433,11 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('r', "", p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,6 +445,11 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (stream->GetBinaryTraceFile () != 0)
+    {
+      stream->GetBinaryTraceFile ()->WriteEvent ('r', context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -222,6 +222,22 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create an output stream object which writes a binary trace file.
+   *
+   * The default trace sinks hooked to this stream write compact binary
+   * records instead of printing the packets, which is much faster. Text
+   * written to the stream by other trace sinks is kept verbatim. The
+   * ascii trace is rendered on demand with BinaryTraceFile::Decode or the
+   * decode-binary-trace program.
+   *
+   * @param filename file name (compressed if it ends with ".gz" or ".zst")
+   * @param filemode file mode
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename,
+                                                   std::ios::openmode filemode = std::ios::out);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -400,9 +400,7 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
+  if (m_end == m_zeroAreaEnd &&
       o.m_start == o.m_zeroAreaStart &&
       o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
@@ -411,6 +409,14 @@ Buffer::AddAtEnd (const Buffer &o)
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
+      if (m_data->m_count != 1 || m_end != m_data->m_dirtyEnd)
+        {
+          /* The data is shared with other buffers (typically other
+           * fragments of the same packet): detach the real bytes only,
+           * so that the zero area can grow without being materialized.
+           */
+          *this = CreateDetachedCopy ();
+        }
       uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
       m_zeroAreaEnd += zeroSize;
       m_end = m_zeroAreaEnd;
@@ -426,6 +432,33 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
+  if (o.m_data != m_data && o.m_zeroAreaEnd == o.m_zeroAreaStart)
+    {
+      /* o contains only real bytes: append them after our own end
+       * and leave our zero area virtual.
+       */
+      uint32_t size = o.GetSize ();
+      AddAtEnd (size);
+      Buffer::Iterator dst = End ();
+      dst.Prev (size);
+      dst.Write (o.Begin (), o.End ());
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (o.m_data != m_data && m_zeroAreaEnd == m_zeroAreaStart)
+    {
+      /* we contain only real bytes: prepend them to o
+       * and leave the zero area of o virtual.
+       */
+      Buffer dst = o;
+      uint32_t size = GetSize ();
+      dst.AddAtStart (size);
+      dst.Begin ().Write (Begin (), End ());
+      *this = dst;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
   Buffer dst = CreateFullCopy ();
   Buffer src = o.CreateFullCopy ();
 
@@ -555,6 +588,24 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::CreateDetachedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  Buffer tmp (m_zeroAreaEnd - m_zeroAreaStart);
+  uint32_t dataStart = m_zeroAreaStart - m_start;
+  tmp.AddAtStart (dataStart);
+  tmp.Begin ().Write (m_data->m_data + m_start, dataStart);
+  uint32_t dataEnd = m_end - m_zeroAreaEnd;
+  tmp.AddAtEnd (dataEnd);
+  Buffer::Iterator i = tmp.End ();
+  i.Prev (dataEnd);
+  i.Write (m_data->m_data + m_zeroAreaStart, dataEnd);
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
@@ -714,6 +765,22 @@ Buffer::PeekData (void) const
   return m_data->m_data + m_start;
 }
 
+uint8_t const*
+Buffer::PeekContiguousData (uint32_t start, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << start << size);
+  NS_ASSERT (CheckInternalState ());
+  if (start + size <= m_zeroAreaStart - m_start)
+    {
+      return m_data->m_data + m_start + start;
+    }
+  if (start >= m_zeroAreaEnd - m_start && start + size <= m_end - m_start)
+    {
+      return m_data->m_data + m_start + start - (m_zeroAreaEnd - m_zeroAreaStart);
+    }
+  return 0;
+}
+
 void
 Buffer::CopyData (std::ostream *os, uint32_t size) const
 {
@@ -846,10 +913,17 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the written area does not overlap our zero area: if it is located
+  // after it, the real bytes are stored at a shifted offset.
+  uint32_t shift = 0;
+  if (m_current > m_zeroStart)
+    {
+      shift = m_zeroEnd - m_zeroStart;
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (&m_data[m_current - shift], &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
       size -= toCopy;
@@ -857,15 +931,14 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (&m_data[m_current - shift], 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
-  memcpy (to, from, toCopy);
+  memcpy (&m_data[m_current - shift], from, toCopy);
   m_current += toCopy;
 }
 
@@ -500,6 +500,20 @@ private:
    */
   uint8_t const*PeekData (void) const;
 
+  /**
+   * \param start offset from the start of the buffer
+   * \param size number of bytes requested
+   * \return a pointer to the requested bytes if they are stored
+   * contiguously in the real byte buffer, 0 otherwise.
+   *
+   * Unlike PeekData, this method never transforms the "virtual zero
+   * area" into real bytes: it is meant for read-only accessors which
+   * fall back to the Iterator API when it returns 0. The returned
+   * pointer is invalidated by any call to a method which modifies
+   * this Buffer.
+   */
+  uint8_t const*PeekContiguousData (uint32_t start, uint32_t size) const;
+
   /**
    * \param start size to reserve
    *
@@ -693,6 +707,15 @@ private:
    */
   Buffer CreateFullCopy (void) const;
 
+  /**
+   * \brief Create a copy of the buffer which owns its data storage.
+   *
+   * Only the real bytes are copied: the virtual zero area is preserved.
+   *
+   * \returns a copy of the buffer
+   */
+  Buffer CreateDetachedCopy (void) const;
+
   /**
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
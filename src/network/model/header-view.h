@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef HEADER_VIEW_H
+#define HEADER_VIEW_H
+
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Read-only access to the fields of a header stored at the
+ * start of a packet, without deserializing it.
+ *
+ * When the first \c size bytes of the packet are stored contiguously
+ * (see Packet::PeekContiguousData), the accessors of the derived
+ * classes read the fields straight from the packet bytes. Otherwise,
+ * the header is deserialized once with Packet::PeekHeader and the
+ * accessors read the fields of the deserialized header.
+ *
+ * A packet shorter than \c size bytes is truncated: it is not
+ * deserialized, and the accessors return the fields of a default
+ * constructed header.
+ *
+ * A view keeps a reference to the packet but does not protect the
+ * packet bytes against modifications: the packet must not be modified
+ * while the view is in use.
+ *
+ * \tparam T the header type
+ */
+template <typename T>
+class HeaderView
+{
+public:
+  /**
+   * \param packet the packet which starts with the header
+   * \param size the number of bytes read by the direct accessors
+   */
+  HeaderView (Ptr<const Packet> packet, uint32_t size);
+
+  /**
+   * \returns true if the fields are read straight from the packet bytes,
+   *          false if the header had to be deserialized.
+   */
+  bool IsDirect (void) const;
+  /**
+   * \returns true if the packet is shorter than the header, in which
+   *          case the accessors return the default header fields.
+   */
+  bool IsTruncated (void) const;
+
+protected:
+  /**
+   * \param offset offset of the field from the start of the header
+   * \returns the byte at the given offset
+   */
+  uint8_t ReadU8 (uint32_t offset) const;
+  /**
+   * \param offset offset of the field from the start of the header
+   * \returns the 16-bit value in network order at the given offset
+   */
+  uint16_t ReadNtohU16 (uint32_t offset) const;
+  /**
+   * \param offset offset of the field from the start of the header
+   * \returns the 32-bit value in network order at the given offset
+   */
+  uint32_t ReadNtohU32 (uint32_t offset) const;
+  /**
+   * \param offset offset of the field from the start of the header
+   * \returns a pointer to the bytes at the given offset
+   */
+  uint8_t const *GetData (uint32_t offset) const;
+  /**
+   * \returns the deserialized header, used when the view is not direct,
+   *          or a default header if the packet is truncated
+   */
+  const T & GetHeader (void) const;
+
+private:
+  Ptr<const Packet> m_packet; //!< the packet holding the header
+  uint8_t const *m_data;      //!< the header bytes, 0 if not contiguous
+  mutable T m_header;         //!< the deserialized header (fallback)
+  mutable bool m_deserialized; //!< true if m_header has been deserialized
+  bool m_truncated;           //!< true if the packet is shorter than the header
+};
+
+} // namespace ns3
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+HeaderView<T>::HeaderView (Ptr<const Packet> packet, uint32_t size)
+  : m_packet (packet),
+    m_data (packet->PeekContiguousData (size)),
+    m_deserialized (false),
+    m_truncated (packet->GetSize () < size)
+{
+}
+
+template <typename T>
+bool
+HeaderView<T>::IsDirect (void) const
+{
+  return m_data != 0;
+}
+
+template <typename T>
+bool
+HeaderView<T>::IsTruncated (void) const
+{
+  return m_truncated;
+}
+
+template <typename T>
+uint8_t
+HeaderView<T>::ReadU8 (uint32_t offset) const
+{
+  return m_data[offset];
+}
+
+template <typename T>
+uint16_t
+HeaderView<T>::ReadNtohU16 (uint32_t offset) const
+{
+  uint16_t retval = m_data[offset];
+  retval <<= 8;
+  retval |= m_data[offset + 1];
+  return retval;
+}
+
+template <typename T>
+uint32_t
+HeaderView<T>::ReadNtohU32 (uint32_t offset) const
+{
+  uint32_t retval = m_data[offset];
+  retval <<= 8;
+  retval |= m_data[offset + 1];
+  retval <<= 8;
+  retval |= m_data[offset + 2];
+  retval <<= 8;
+  retval |= m_data[offset + 3];
+  return retval;
+}
+
+template <typename T>
+uint8_t const *
+HeaderView<T>::GetData (uint32_t offset) const
+{
+  return m_data + offset;
+}
+
+template <typename T>
+const T &
+HeaderView<T>::GetHeader (void) const
+{
+  if (!m_deserialized && !m_truncated)
+    {
+      m_packet->PeekHeader (m_header);
+      m_deserialized = true;
+    }
+  return m_header;
+}
+
+} // namespace ns3
+
+#endif /* HEADER_VIEW_H */
@@ -386,6 +386,16 @@ Packet::CopyData (std::ostream *os, uint32_t size) const
   return m_buffer.CopyData (os, size);
 }
 
+uint8_t const *
+Packet::PeekContiguousData (uint32_t size) const
+{
+  if (size > m_buffer.GetSize ())
+    {
+      return 0;
+    }
+  return m_buffer.PeekContiguousData (0, size);
+}
+
 uint64_t 
 Packet::GetUid (void) const
 {
@@ -442,6 +442,19 @@ public:
    */
   void CopyData (std::ostream *os, uint32_t size) const;
 
+  /**
+   * \brief Get a read-only pointer to the first bytes of the packet.
+   *
+   * \param size the number of bytes requested
+   * \returns a pointer to the first \b size bytes of the packet if
+   *          they are stored contiguously, 0 otherwise.
+   *
+   * No copy is ever made: callers must fall back to CopyData or
+   * PeekHeader when 0 is returned. The pointer is invalidated by
+   * any modification of the packet.
+   */
+  uint8_t const *PeekContiguousData (uint32_t size) const;
+
   /**
    * \brief performs a COW copy of the packet.
    *
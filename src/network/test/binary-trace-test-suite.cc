@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/trace-helper.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that decoding a binary trace gives the ascii trace written
+ * by the default ascii trace sinks.
+ */
+class BinaryTraceDecodeTestCase : public TestCase
+{
+public:
+  BinaryTraceDecodeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Trace the packets to both streams.
+   * \param ascii the ascii trace stream
+   * \param binary the binary trace stream
+   */
+  void TracePackets (Ptr<OutputStreamWrapper> ascii, Ptr<OutputStreamWrapper> binary);
+};
+
+BinaryTraceDecodeTestCase::BinaryTraceDecodeTestCase ()
+  : TestCase ("Check that binary traces decode to the ascii traces")
+{
+}
+
+void
+BinaryTraceDecodeTestCase::TracePackets (Ptr<OutputStreamWrapper> ascii, Ptr<OutputStreamWrapper> binary)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  LlcSnapHeader llc;
+  llc.SetType (0x0800);
+  p->AddHeader (llc);
+  EthernetHeader eth;
+  eth.SetSource (Mac48Address ("00:00:00:00:00:01"));
+  eth.SetDestination (Mac48Address ("00:00:00:00:00:02"));
+  eth.SetLengthType (p->GetSize ());
+  p->AddHeader (eth);
+  EthernetTrailer fcs;
+  p->AddTrailer (fcs);
+  Ptr<Packet> fragment = p->CreateFragment (4, 20);
+
+  std::string context = "/NodeList/1/DeviceList/2/$ns3::CsmaNetDevice/TxQueue/Enqueue";
+  Ptr<OutputStreamWrapper> streams[2] = { ascii, binary };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      AsciiTraceHelper::DefaultEnqueueSinkWithContext (streams[i], context, p);
+      AsciiTraceHelper::DefaultDequeueSinkWithoutContext (streams[i], p);
+      *streams[i]->GetStream () << "custom " << p->GetSize () << std::endl;
+      AsciiTraceHelper::DefaultDropSinkWithContext (streams[i], context, fragment);
+      AsciiTraceHelper::DefaultReceiveSinkWithoutContext (streams[i], Create<Packet> (10));
+    }
+}
+
+void
+BinaryTraceDecodeTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+  std::ostringstream ascii;
+  std::string filename = CreateTempDirFilename ("trace.trb");
+  {
+    AsciiTraceHelper helper;
+    Ptr<OutputStreamWrapper> binary = helper.CreateBinaryFileStream (filename);
+    NS_TEST_ASSERT_MSG_NE (binary->GetBinaryTraceFile (), 0, "Not a binary trace stream");
+    Simulator::Schedule (Seconds (1.25), &BinaryTraceDecodeTestCase::TracePackets, this,
+                         Create<OutputStreamWrapper> (&ascii), binary);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceFile::Decode (filename, decoded), true, "Cannot decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), ascii.str (), "Decoded trace differs from ascii trace");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a binary trace holds more contexts than fit in 16 bits,
+ * and that event times are stored as little-endian time steps.
+ */
+class BinaryTraceFormatTestCase : public TestCase
+{
+public:
+  BinaryTraceFormatTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Trace a packet with a new context per node to both streams.
+   * \param ascii the ascii trace stream
+   * \param binary the binary trace stream
+   */
+  void TracePackets (Ptr<OutputStreamWrapper> ascii, Ptr<OutputStreamWrapper> binary);
+};
+
+/// Number of contexts traced, more than 16-bit identifiers can tell apart
+static const uint32_t N_CONTEXTS = 70000;
+
+BinaryTraceFormatTestCase::BinaryTraceFormatTestCase ()
+  : TestCase ("Check the context identifiers and times of binary traces")
+{
+}
+
+void
+BinaryTraceFormatTestCase::TracePackets (Ptr<OutputStreamWrapper> ascii, Ptr<OutputStreamWrapper> binary)
+{
+  Ptr<Packet> p = Create<Packet> (10);
+  for (uint32_t node = 0; node < N_CONTEXTS; node++)
+    {
+      std::ostringstream context;
+      context << "/NodeList/" << node << "/DeviceList/0/$ns3::CsmaNetDevice/MacRx";
+      AsciiTraceHelper::DefaultReceiveSinkWithContext (ascii, context.str (), p);
+      AsciiTraceHelper::DefaultReceiveSinkWithContext (binary, context.str (), p);
+    }
+  //the first context again, which must not have been confused with a later one
+  std::string context = "/NodeList/0/DeviceList/0/$ns3::CsmaNetDevice/MacRx";
+  AsciiTraceHelper::DefaultReceiveSinkWithContext (ascii, context, p);
+  AsciiTraceHelper::DefaultReceiveSinkWithContext (binary, context, p);
+}
+
+void
+BinaryTraceFormatTestCase::DoRun (void)
+{
+  std::ostringstream ascii;
+  std::string filename = CreateTempDirFilename ("contexts.trb");
+  Time now = Seconds (2) + NanoSeconds (1);
+  {
+    AsciiTraceHelper helper;
+    Ptr<OutputStreamWrapper> binary = helper.CreateBinaryFileStream (filename);
+    Simulator::Schedule (now, &BinaryTraceFormatTestCase::TracePackets, this,
+                         Create<OutputStreamWrapper> (&ascii), binary);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  std::vector<uint8_t> bytes ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  file.close ();
+  //magic, resolution, then the first context record and the first event
+  //record, whose time follows the kind, the event, the context, the node
+  //and the device
+  NS_TEST_ASSERT_MSG_GT (bytes.size (), 100, "Trace too short");
+  NS_TEST_EXPECT_MSG_EQ (+bytes[8], Time::GetResolution (), "Wrong resolution");
+  NS_TEST_ASSERT_MSG_EQ (+bytes[9], 1, "The first record is not a context");
+  uint32_t event = 9 + 15 + bytes[9 + 13];
+  NS_TEST_ASSERT_MSG_EQ (+bytes[event], 4, "The second record is not an event");
+  uint64_t time = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      time |= static_cast<uint64_t> (bytes[event + 14 + i]) << (8 * i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (time, static_cast<uint64_t> (now.GetTimeStep ()), "Wrong time");
+
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceFile::Decode (filename, decoded), true, "Cannot decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ ((decoded.str () == ascii.str ()), true, "Decoded trace differs from ascii trace");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceDecodeTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceFormatTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
@@ -321,6 +321,39 @@ BufferTest::DoRun (void)
   ENSURE_WRITTEN_BYTES (buffer, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
   ENSURE_WRITTEN_BYTES (frag0, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
 
+  // aggregating fragments of a zero-filled buffer keeps the zero area virtual
+  buffer = Buffer (3000);
+  frag0 = buffer.CreateFragment (0, 1000);
+  frag1 = buffer.CreateFragment (1000, 2000);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetSize (), 3000, "Bad aggregated size");
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetSerializedSize (), 12, "Zero area was materialized");
+  frag0.AddAtStart (2);
+  i = frag0.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  frag1 = Buffer ();
+  frag1.AddAtStart (2);
+  i = frag1.Begin ();
+  i.WriteU8 (0x5);
+  i.WriteU8 (0x6);
+  frag1.AddAtEnd (frag0.CreateFragment (0, 4));
+  NS_TEST_EXPECT_MSG_EQ (frag1.GetSerializedSize (), 16, "Zero area was materialized");
+  ENSURE_WRITTEN_BYTES (frag1, 6, 0x5, 0x6, 0x1, 0x2, 0x00, 0x00);
+  frag0.AddAtEnd (buffer.CreateFragment (0, 2));
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetSerializedSize (), 16, "Zero area was materialized");
+  frag1 = Buffer ();
+  frag1.AddAtEnd (2);
+  i = frag1.Begin ();
+  i.WriteU8 (0x3);
+  i.WriteU8 (0x4);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetSize (), 3006, "Bad aggregated size");
+  NS_TEST_EXPECT_MSG_EQ (frag0.GetSerializedSize (), 20, "Zero area was materialized");
+  i = frag0.End ();
+  i.Prev (4);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU32 (), 0x00000304, "Bad aggregated content");
+
   buffer = Buffer (5);
   buffer.AddAtStart (2);
   i = buffer.Begin ();
@@ -21,10 +21,15 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/compressed-file-buf.h"
+#include "ns3/output-stream-wrapper.h"
 
 using namespace ns3;
 
@@ -1144,6 +1149,280 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that block-buffered writing produces
+ * the same file as direct writing.
+ */
+class BlockBufferingTestCase : public TestCase
+{
+public:
+  BlockBufferingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the known packets to files open at the same time.
+   * \param filenames the file names
+   * \param blockSize the size of the blocks, 0 to write records directly
+   */
+  void WriteKnownPackets (std::vector<std::string> const &filenames, uint32_t blockSize);
+  /**
+   * \param filename the file name
+   * \returns the content of the file
+   */
+  std::string ReadFile (std::string const &filename);
+
+  std::string m_expected; //!< content of the directly written file
+};
+
+BlockBufferingTestCase::BlockBufferingTestCase ()
+  : TestCase ("Check that block-buffered writing produces identical files")
+{
+}
+
+std::string
+BlockBufferingTestCase::ReadFile (std::string const &filename)
+{
+  std::ifstream f (filename.c_str (), std::ios::binary);
+  return std::string ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+}
+
+void
+BlockBufferingTestCase::WriteKnownPackets (std::vector<std::string> const &filenames, uint32_t blockSize)
+{
+  std::vector<PcapFile *> files;
+  for (uint32_t j = 0; j < filenames.size (); ++j)
+    {
+      PcapFile *f = new PcapFile ();
+      f->Open (filenames[j], std::ios::out);
+      NS_TEST_EXPECT_MSG_EQ (f->Fail (), false, "Open (" << filenames[j] << ", \"std::ios::out\") returns error");
+      if (blockSize > 0)
+        {
+          // two small blocks force records to be split and writes to wait
+          f->SetBlockBuffering (blockSize, 2);
+        }
+      f->Init (1, N_PACKET_BYTES);
+      files.push_back (f);
+    }
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      for (uint32_t j = 0; j < files.size (); ++j)
+        {
+          files[j]->Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+          NS_TEST_EXPECT_MSG_EQ (files[j]->Fail (), false, "Write must not fail");
+        }
+    }
+  for (uint32_t j = 0; j < files.size (); ++j)
+    {
+      files[j]->Flush ();
+      if (!m_expected.empty () && filenames[j].find (".gz") == std::string::npos)
+        {
+          // the records are in the file as soon as Flush returns
+          NS_TEST_EXPECT_MSG_EQ ((ReadFile (filenames[j]) == m_expected), true,
+                                 "Flush did not write all the records of " << filenames[j]);
+        }
+      if (j % 2 == 0)
+        {
+          files[j]->Close ();
+        }
+      // the other files are closed by their destructor
+      delete files[j];
+    }
+}
+
+void
+BlockBufferingTestCase::DoRun (void)
+{
+  std::vector<std::string> direct;
+  direct.push_back (CreateTempDirFilename ("direct.pcap"));
+  WriteKnownPackets (direct, 0);
+  m_expected = ReadFile (direct[0]);
+  NS_TEST_EXPECT_MSG_GT (m_expected.size (), 0, "Empty pcap file");
+
+  // the files share the background thread of the block writers
+  std::vector<std::string> buffered;
+  for (uint32_t j = 0; j < 4; ++j)
+    {
+      std::ostringstream oss;
+      oss << "buffered-" << j << ".pcap";
+      buffered.push_back (CreateTempDirFilename (oss.str ()));
+    }
+  if (CompressedFileBuf::IsSupported (CompressedFileBuf::GZIP))
+    {
+      // the blocks of the pcap file are compressed by the same thread
+      buffered.push_back (CreateTempDirFilename ("buffered.pcap.gz"));
+    }
+  WriteKnownPackets (buffered, 64);
+
+  for (uint32_t j = 0; j < buffered.size (); ++j)
+    {
+      if (buffered[j].find (".gz") == std::string::npos)
+        {
+          NS_TEST_EXPECT_MSG_EQ ((ReadFile (buffered[j]) == m_expected), true,
+                                 "Block-buffered file " << buffered[j] << " differs from direct file");
+        }
+      else
+        {
+          uint32_t sec (0), usec (0), packets (0);
+          bool diff = PcapFile::Diff (direct[0], buffered[j], sec, usec, packets);
+          NS_TEST_EXPECT_MSG_EQ (diff, false, "Block-buffered compressed file differs from direct file");
+          NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "Bad number of packets read from compressed file");
+        }
+      remove (buffered[j].c_str ());
+    }
+  remove (direct[0].c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that compressed pcap and ascii files
+ * can be written and read back.
+ */
+class CompressedFileTestCase : public TestCase
+{
+public:
+  /**
+   * \param format the compression format
+   * \param extension the file name extension of the format
+   */
+  CompressedFileTestCase (CompressedFileBuf::Format format, std::string const &extension);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the known packets to a file.
+   * \param filename the file name
+   */
+  void WriteKnownPackets (std::string const &filename);
+  /**
+   * Check that the lines of a compressed file are the expected ones.
+   * \param filename the file name
+   * \param nLines the expected number of lines
+   */
+  void CheckLines (std::string const &filename, uint32_t nLines);
+
+  CompressedFileBuf::Format m_format; //!< the compression format
+  std::string m_extension;            //!< the file name extension
+};
+
+CompressedFileTestCase::CompressedFileTestCase (CompressedFileBuf::Format format, std::string const &extension)
+  : TestCase ("Check that " + extension + " compressed files can be written and read back"),
+    m_format (format),
+    m_extension (extension)
+{
+}
+
+void
+CompressedFileTestCase::WriteKnownPackets (std::string const &filename)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, N_PACKET_BYTES);
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+      NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+    }
+  f.Close ();
+}
+
+void
+CompressedFileTestCase::CheckLines (std::string const &filename, uint32_t nLines)
+{
+  CompressedFileBuf buf;
+  NS_TEST_ASSERT_MSG_EQ (buf.Open (filename, std::ios::in, m_format), true, "Cannot open " << filename);
+  std::istream in (&buf);
+  std::string line;
+  uint32_t lines = 0;
+  while (lines < nLines && std::getline (in, line))
+    {
+      std::ostringstream expected;
+      expected << "+ " << lines << " ns3::Packet";
+      NS_TEST_EXPECT_MSG_EQ (line, expected.str (), "Bad line read from " << filename);
+      lines++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (lines, nLines, "Bad number of lines read from " << filename);
+  buf.Close ();
+}
+
+void
+CompressedFileTestCase::DoRun (void)
+{
+  std::string plain = CreateTempDirFilename ("plain.pcap");
+  std::string compressed = CreateTempDirFilename ("compressed.pcap" + m_extension);
+  if (!CompressedFileBuf::IsSupported (m_format))
+    {
+      // a build without the library fails to open the files cleanly
+      CompressedFileBuf buf;
+      NS_TEST_EXPECT_MSG_EQ (buf.Open (compressed, std::ios::out, m_format), false,
+                             "Unsupported format must not open");
+      NS_TEST_EXPECT_MSG_EQ (buf.IsOpen (), false, "Unsupported format must not open");
+      PcapFile f;
+      f.Open (compressed, std::ios::out, m_format);
+      NS_TEST_EXPECT_MSG_EQ (f.Fail (), true, "Unsupported format must fail");
+      f.Close ();
+      remove (compressed.c_str ());
+      return;
+    }
+  WriteKnownPackets (plain);
+  WriteKnownPackets (compressed);
+
+  NS_TEST_EXPECT_MSG_EQ (CompressedFileBuf::ResolveFormat (compressed, std::ios::in), m_format,
+                         "File is not " << m_extension << " compressed");
+
+  uint32_t sec (0), usec (0), packets (0);
+  bool diff = PcapFile::Diff (plain, compressed, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "Compressed file differs from plain file");
+  NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "Bad number of packets read from compressed file");
+
+  // std::endl, used by the ascii trace sinks, must not flush the compressor
+  std::string ascii = CreateTempDirFilename ("trace.tr" + m_extension);
+  {
+    OutputStreamWrapper stream (ascii, std::ios::out);
+    for (uint32_t i = 0; i < 10000; ++i)
+      {
+        *stream.GetStream () << "+ " << i << " ns3::Packet" << std::endl;
+      }
+  }
+  CheckLines (ascii, 10000);
+  std::ifstream asciiFile (ascii.c_str (), std::ios::binary | std::ios::ate);
+  NS_TEST_EXPECT_MSG_LT (uint32_t (asciiFile.tellg ()), 10000 * 4, "Lines compressed one by one");
+  asciiFile.close ();
+
+  // Flush makes the data written so far readable while the file is still
+  // open
+  std::string synced = CreateTempDirFilename ("synced.tr" + m_extension);
+  {
+    CompressedFileBuf buf;
+    NS_TEST_ASSERT_MSG_EQ (buf.Open (synced, std::ios::out, m_format), true, "Cannot open " << synced);
+    std::ostream out (&buf);
+    for (uint32_t i = 0; i < 100000; ++i)
+      {
+        out << "+ " << i << " ns3::Packet\n";
+        if (i == 4999 || i == 99999)
+          {
+            NS_TEST_EXPECT_MSG_EQ (buf.Flush (), true, "Flush failed");
+            CheckLines (synced, i + 1);
+          }
+      }
+    NS_TEST_EXPECT_MSG_EQ (buf.Close (), true, "Close failed");
+  }
+  CheckLines (synced, 100000);
+
+  remove (plain.c_str ());
+  remove (compressed.c_str ());
+  remove (ascii.c_str ());
+  remove (synced.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1446,9 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BlockBufferingTestCase, TestCase::QUICK);
+  AddTestCase (new CompressedFileTestCase (CompressedFileBuf::GZIP, ".gz"), TestCase::QUICK);
+  AddTestCase (new CompressedFileTestCase (CompressedFileBuf::ZSTD, ".zst"), TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,660 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <streambuf>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/chunk.h"
+#include "ns3/buffer.h"
+#include "ns3/type-id.h"
+#include "binary-trace-file.h"
+#include "compressed-file-buf.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+const uint32_t BinaryTraceFile::HEAD_SNAPSHOT_SIZE;
+const uint32_t BinaryTraceFile::TAIL_SNAPSHOT_SIZE;
+const uint32_t BinaryTraceFile::MAX_ITEMS;
+
+/// Magic bytes at the start of binary trace files, ending with the format version
+static const char BINARY_TRACE_MAGIC[8] = { 'n', 's', '3', 't', 'r', 'b', 0, 2 };
+
+/// Kinds of records
+enum RecordKind
+{
+  CONTEXT_RECORD = 1, //!< a context string
+  TYPE_RECORD = 2,    //!< a header or trailer type name
+  TEXT_RECORD = 3,    //!< text written verbatim
+  EVENT_RECORD = 4    //!< a packet event
+};
+
+/// Kinds of packet items, as stored in event records
+enum ItemKind
+{
+  ITEM_PAYLOAD = 0,   //!< payload
+  ITEM_HEADER = 1,    //!< header
+  ITEM_TRAILER = 2,   //!< trailer
+  ITEM_FRAGMENT = 0x80 //!< flag set for fragments of items
+};
+
+/// Identifier of the missing context
+static const uint32_t NO_CONTEXT = 0xffffffff;
+/// Identifier of the missing type
+static const uint16_t NO_TYPE = 0xffff;
+/// Size of an item description in event records
+static const uint32_t ITEM_SIZE = 12;
+/// Size of the fixed fields of event records, including the record kind
+static const uint32_t EVENT_FIELDS_SIZE = 38;
+/// Size of event records
+static const uint32_t EVENT_SIZE = EVENT_FIELDS_SIZE
+  + BinaryTraceFile::MAX_ITEMS * ITEM_SIZE
+  + BinaryTraceFile::HEAD_SNAPSHOT_SIZE
+  + BinaryTraceFile::TAIL_SNAPSHOT_SIZE;
+/// Number of buffered bytes which triggers a write to the file
+static const uint32_t BLOCK_SIZE = 1 << 16;
+
+/**
+ * \param buffer where to write
+ * \param data the value to write in little-endian order
+ * \returns the position after the value
+ */
+static uint8_t *
+WriteU16 (uint8_t *buffer, uint16_t data)
+{
+  buffer[0] = data & 0xff;
+  buffer[1] = (data >> 8) & 0xff;
+  return buffer + 2;
+}
+
+/**
+ * \param buffer where to write
+ * \param data the value to write in little-endian order
+ * \returns the position after the value
+ */
+static uint8_t *
+WriteU32 (uint8_t *buffer, uint32_t data)
+{
+  buffer = WriteU16 (buffer, data & 0xffff);
+  return WriteU16 (buffer, data >> 16);
+}
+
+/**
+ * \param buffer where to write
+ * \param data the value to write in little-endian order
+ * \returns the position after the value
+ */
+static uint8_t *
+WriteU64 (uint8_t *buffer, uint64_t data)
+{
+  buffer = WriteU32 (buffer, data & 0xffffffff);
+  return WriteU32 (buffer, data >> 32);
+}
+
+/**
+ * \param buffer where to read
+ * \returns the little-endian value at \p buffer
+ */
+static uint16_t
+ReadU16 (uint8_t const *buffer)
+{
+  return buffer[0] | (buffer[1] << 8);
+}
+
+/**
+ * \param buffer where to read
+ * \returns the little-endian value at \p buffer
+ */
+static uint32_t
+ReadU32 (uint8_t const *buffer)
+{
+  return ReadU16 (buffer) | (static_cast<uint32_t> (ReadU16 (buffer + 2)) << 16);
+}
+
+/**
+ * \param buffer where to read
+ * \returns the little-endian value at \p buffer
+ */
+static uint64_t
+ReadU64 (uint8_t const *buffer)
+{
+  return ReadU32 (buffer) | (static_cast<uint64_t> (ReadU32 (buffer + 4)) << 32);
+}
+
+/**
+ * \ingroup network
+ *
+ * \brief Stream buffer which turns text into text records.
+ *
+ * The text is written as a record when the stream is flushed, which
+ * trace sinks typically do at the end of each line with std::endl, or
+ * before the next packet event.
+ */
+class BinaryTraceTextBuf : public std::streambuf
+{
+public:
+  /**
+   * \param file the binary trace file
+   */
+  BinaryTraceTextBuf (BinaryTraceFile *file)
+    : m_file (file)
+  {
+  }
+protected:
+  virtual int_type overflow (int_type c)
+  {
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        m_text += traits_type::to_char_type (c);
+      }
+    return traits_type::not_eof (c);
+  }
+  virtual std::streamsize xsputn (const char *s, std::streamsize n)
+  {
+    m_text.append (s, n);
+    return n;
+  }
+  virtual int sync (void)
+  {
+    m_file->WriteText ();
+    return 0;
+  }
+private:
+  friend class BinaryTraceFile;
+  BinaryTraceFile *m_file; //!< the binary trace file
+  std::string m_text;      //!< text not written yet
+};
+
+BinaryTraceFile::BinaryTraceFile (std::string const &filename, std::ios::openmode filemode)
+  : m_compressedBuf (0),
+    m_file (0)
+{
+  NS_LOG_FUNCTION (this << filename << filemode);
+  filemode |= std::ios::out | std::ios::binary;
+  CompressedFileBuf::Format format = CompressedFileBuf::ResolveFormat (filename, filemode);
+  bool empty = true;
+  if (format != CompressedFileBuf::NONE)
+    {
+      m_compressedBuf = new CompressedFileBuf ();
+      if (!m_compressedBuf->Open (filename, filemode, format))
+        {
+          NS_LOG_WARN ("Unable to open " << filename);
+        }
+      m_file = new std::ostream (m_compressedBuf);
+      if (!m_compressedBuf->IsOpen ())
+        {
+          m_file->setstate (std::ios::failbit);
+        }
+    }
+  else
+    {
+      std::ofstream *file = new std::ofstream (filename.c_str (), filemode);
+      if (filemode & std::ios::app)
+        {
+          file->seekp (0, std::ios::end);
+          empty = file->tellp () == 0;
+        }
+      m_file = file;
+    }
+  m_textBuf = new BinaryTraceTextBuf (this);
+  m_text = new std::ostream (m_textBuf);
+  m_block.reserve (BLOCK_SIZE + EVENT_SIZE);
+  if (empty || !(filemode & std::ios::app))
+    {
+      uint8_t *buffer = Reserve (sizeof (BINARY_TRACE_MAGIC) + 1);
+      std::memcpy (buffer, BINARY_TRACE_MAGIC, sizeof (BINARY_TRACE_MAGIC));
+      buffer[sizeof (BINARY_TRACE_MAGIC)] = Time::GetResolution ();
+    }
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  delete m_file;
+  m_file = 0;
+  delete m_compressedBuf;
+  m_compressedBuf = 0;
+  delete m_text;
+  m_text = 0;
+  delete m_textBuf;
+  m_textBuf = 0;
+}
+
+std::ostream *
+BinaryTraceFile::GetTextStream (void)
+{
+  return m_text;
+}
+
+bool
+BinaryTraceFile::Fail (void) const
+{
+  return m_file->fail ();
+}
+
+void
+BinaryTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteText ();
+  m_file->write (reinterpret_cast<const char *> (m_block.data ()), m_block.size ());
+  m_block.clear ();
+  // also flushes the compressed file, if any
+  m_file->flush ();
+}
+
+uint8_t *
+BinaryTraceFile::Reserve (uint32_t size)
+{
+  if (m_block.size () + size > BLOCK_SIZE && !m_block.empty ())
+    {
+      m_file->write (reinterpret_cast<const char *> (m_block.data ()), m_block.size ());
+      m_block.clear ();
+    }
+  uint32_t used = m_block.size ();
+  m_block.resize (used + size);
+  return &m_block[used];
+}
+
+void
+BinaryTraceFile::WriteText (void)
+{
+  std::string &text = m_textBuf->m_text;
+  if (text.empty ())
+    {
+      return;
+    }
+  uint8_t *buffer = Reserve (5 + text.size ());
+  *buffer++ = TEXT_RECORD;
+  buffer = WriteU32 (buffer, text.size ());
+  std::memcpy (buffer, text.data (), text.size ());
+  text.clear ();
+}
+
+uint32_t
+BinaryTraceFile::GetContextId (std::string const &context)
+{
+  std::map<std::string, uint32_t>::const_iterator it = m_contexts.find (context);
+  if (it != m_contexts.end ())
+    {
+      return it->second;
+    }
+  uint32_t id = m_contexts.size ();
+  m_contexts[context] = id;
+
+  uint32_t node = 0xffffffff;
+  uint32_t device = 0xffffffff;
+  std::sscanf (context.c_str (), "/NodeList/%u/DeviceList/%u", &node, &device);
+  uint8_t *buffer = Reserve (15 + context.size ());
+  *buffer++ = CONTEXT_RECORD;
+  buffer = WriteU32 (buffer, id);
+  buffer = WriteU32 (buffer, node);
+  buffer = WriteU32 (buffer, device);
+  buffer = WriteU16 (buffer, context.size ());
+  std::memcpy (buffer, context.data (), context.size ());
+  return id;
+}
+
+uint16_t
+BinaryTraceFile::GetTypeNameId (TypeId tid)
+{
+  uint16_t uid = tid.GetUid ();
+  std::map<uint16_t, uint16_t>::const_iterator it = m_types.find (uid);
+  if (it != m_types.end ())
+    {
+      return it->second;
+    }
+  uint16_t id = m_types.size ();
+  m_types[uid] = id;
+
+  std::string name = tid.GetName ();
+  uint8_t *buffer = Reserve (5 + name.size ());
+  *buffer++ = TYPE_RECORD;
+  buffer = WriteU16 (buffer, id);
+  buffer = WriteU16 (buffer, name.size ());
+  std::memcpy (buffer, name.data (), name.size ());
+  return id;
+}
+
+void
+BinaryTraceFile::WriteEvent (char event, std::string const &context, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << event << context << p);
+  WriteText ();
+
+  uint32_t contextId = NO_CONTEXT;
+  uint32_t node = 0xffffffff;
+  uint32_t device = 0xffffffff;
+  if (!context.empty ())
+    {
+      contextId = GetContextId (context);
+    }
+
+  // describe the items first: this may write type records
+  uint8_t items[MAX_ITEMS * ITEM_SIZE];
+  std::memset (items, 0, sizeof (items));
+  uint8_t nItems = 0;
+  bool truncated = false;
+  bool hasTrailer = false;
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      PacketMetadata::Item item = i.Next ();
+      if (nItems == MAX_ITEMS)
+        {
+          truncated = true;
+          break;
+        }
+      uint8_t *buffer = items + nItems * ITEM_SIZE;
+      uint8_t kind = ITEM_PAYLOAD;
+      uint16_t type = NO_TYPE;
+      if (item.type != PacketMetadata::Item::PAYLOAD)
+        {
+          kind = item.type == PacketMetadata::Item::HEADER ? ITEM_HEADER : ITEM_TRAILER;
+          type = GetTypeNameId (item.tid);
+          hasTrailer = hasTrailer || item.type == PacketMetadata::Item::TRAILER;
+        }
+      if (item.isFragment)
+        {
+          kind |= ITEM_FRAGMENT;
+        }
+      buffer = WriteU16 (buffer, type);
+      *buffer++ = kind;
+      *buffer++ = 0;
+      buffer = WriteU32 (buffer, item.currentSize);
+      buffer = WriteU32 (buffer, item.currentTrimedFromStart);
+      nItems++;
+    }
+
+  if (contextId != NO_CONTEXT)
+    {
+      std::sscanf (context.c_str (), "/NodeList/%u/DeviceList/%u", &node, &device);
+    }
+  uint32_t size = p->GetSize ();
+  uint8_t headLen = std::min (size, HEAD_SNAPSHOT_SIZE);
+  uint8_t tailLen = hasTrailer ? std::min (size, TAIL_SNAPSHOT_SIZE) : 0;
+
+  uint8_t *buffer = Reserve (EVENT_SIZE);
+  std::memset (buffer, 0, EVENT_SIZE);
+  uint8_t *start = buffer;
+  *buffer++ = EVENT_RECORD;
+  *buffer++ = event;
+  buffer = WriteU32 (buffer, contextId);
+  buffer = WriteU32 (buffer, node);
+  buffer = WriteU32 (buffer, device);
+  buffer = WriteU64 (buffer, Simulator::Now ().GetTimeStep ());
+  buffer = WriteU64 (buffer, p->GetUid ());
+  buffer = WriteU32 (buffer, size);
+  *buffer++ = nItems;
+  *buffer++ = truncated ? 1 : 0;
+  *buffer++ = headLen;
+  *buffer++ = tailLen;
+  NS_ASSERT (buffer == start + EVENT_FIELDS_SIZE);
+  std::memcpy (buffer, items, sizeof (items));
+  buffer += sizeof (items);
+  p->CopyData (buffer, headLen);
+  buffer += HEAD_SNAPSHOT_SIZE;
+  if (tailLen > 0)
+    {
+      p->CreateFragment (size - tailLen, tailLen)->CopyData (buffer, tailLen);
+    }
+}
+
+/**
+ * \brief Print a header or trailer deserialized from a snapshot.
+ *
+ * \param os the stream to print to
+ * \param name the type name of the chunk
+ * \param snapshot the bytes of the snapshot
+ * \param offset the offset of the chunk in the snapshot
+ * \param size the size of the chunk
+ */
+static void
+PrintChunk (std::ostream &os, std::string const &name,
+            std::vector<uint8_t> const &snapshot, int64_t offset, uint32_t size)
+{
+  os << name << " (";
+  TypeId tid;
+  if (offset < 0 || offset + size > static_cast<int64_t> (snapshot.size ())
+      || !TypeId::LookupByNameFailSafe (name, &tid) || !tid.HasConstructor ())
+    {
+      os << "truncated)";
+      return;
+    }
+  Buffer buffer;
+  buffer.AddAtStart (snapshot.size ());
+  buffer.Begin ().Write (snapshot.data (), snapshot.size ());
+  Buffer::Iterator start = buffer.Begin ();
+  start.Next (offset);
+  Buffer::Iterator end = start;
+  end.Next (size);
+  ObjectBase *instance = tid.GetConstructor () ();
+  Chunk *chunk = dynamic_cast<Chunk *> (instance);
+  if (chunk == 0)
+    {
+      delete instance;
+      os << "truncated)";
+      return;
+    }
+  chunk->Deserialize (start, end);
+  chunk->Print (os);
+  delete chunk;
+  os << ")";
+}
+
+bool
+BinaryTraceFile::Decode (std::istream &is, std::ostream &os)
+{
+  NS_LOG_FUNCTION (&is << &os);
+  char magic[sizeof (BINARY_TRACE_MAGIC)];
+  is.read (magic, sizeof (magic));
+  if (!is || std::memcmp (magic, BINARY_TRACE_MAGIC, sizeof (magic)) != 0)
+    {
+      return false;
+    }
+  int resolution = is.get ();
+  if (resolution < Time::Y || resolution >= Time::LAST)
+    {
+      return false;
+    }
+  Time::Unit unit = static_cast<Time::Unit> (resolution);
+  std::vector<std::string> contexts;
+  std::vector<std::string> types;
+  std::vector<uint8_t> record (EVENT_SIZE);
+  while (true)
+    {
+      int kind = is.get ();
+      if (kind == std::istream::traits_type::eof ())
+        {
+          return true;
+        }
+      uint8_t *buffer = record.data ();
+      switch (kind)
+        {
+        case CONTEXT_RECORD:
+          {
+            if (!is.read (reinterpret_cast<char *> (buffer), 14))
+              {
+                return false;
+              }
+            uint32_t id = ReadU32 (buffer);
+            std::string context (ReadU16 (buffer + 12), ' ');
+            if (!is.read (&context[0], context.size ()))
+              {
+                return false;
+              }
+            if (id > contexts.size ())
+              {
+                return false;
+              }
+            if (id == contexts.size ())
+              {
+                contexts.push_back (context);
+              }
+            else
+              {
+                contexts[id] = context;
+              }
+            break;
+          }
+        case TYPE_RECORD:
+          {
+            if (!is.read (reinterpret_cast<char *> (buffer), 4))
+              {
+                return false;
+              }
+            uint16_t id = ReadU16 (buffer);
+            std::string name (ReadU16 (buffer + 2), ' ');
+            if (!is.read (&name[0], name.size ()))
+              {
+                return false;
+              }
+            types.resize (std::max<size_t> (types.size (), id + 1));
+            types[id] = name;
+            break;
+          }
+        case TEXT_RECORD:
+          {
+            if (!is.read (reinterpret_cast<char *> (buffer), 4))
+              {
+                return false;
+              }
+            std::string text (ReadU32 (buffer), ' ');
+            if (!is.read (&text[0], text.size ()))
+              {
+                return false;
+              }
+            os << text;
+            break;
+          }
+        case EVENT_RECORD:
+          {
+            if (!is.read (reinterpret_cast<char *> (buffer) + 1, EVENT_SIZE - 1))
+              {
+                return false;
+              }
+            char event = buffer[1];
+            uint32_t contextId = ReadU32 (buffer + 2);
+            Time time = Time::FromInteger (ReadU64 (buffer + 14), unit);
+            uint32_t size = ReadU32 (buffer + 30);
+            uint8_t nItems = buffer[34];
+            bool truncated = buffer[35] != 0;
+            uint8_t headLen = buffer[36];
+            uint8_t tailLen = buffer[37];
+            if (nItems > MAX_ITEMS || headLen > HEAD_SNAPSHOT_SIZE || tailLen > TAIL_SNAPSHOT_SIZE)
+              {
+                return false;
+              }
+            uint8_t const *items = buffer + EVENT_FIELDS_SIZE;
+            uint8_t const *head = items + MAX_ITEMS * ITEM_SIZE;
+            std::vector<uint8_t> headSnapshot (head, head + headLen);
+            uint8_t const *tail = head + HEAD_SNAPSHOT_SIZE;
+            std::vector<uint8_t> tailSnapshot (tail, tail + tailLen);
+
+            os << event << " " << time.GetSeconds () << " ";
+            if (contextId != NO_CONTEXT)
+              {
+                if (contextId >= contexts.size ())
+                  {
+                    return false;
+                  }
+                os << contexts[contextId] << " ";
+              }
+            uint32_t offset = 0;
+            for (uint8_t j = 0; j < nItems; j++)
+              {
+                uint8_t const *item = items + j * ITEM_SIZE;
+                uint16_t type = ReadU16 (item);
+                uint8_t itemKind = item[2];
+                uint32_t itemSize = ReadU32 (item + 4);
+                uint32_t trimmed = ReadU32 (item + 8);
+                std::string name = "Payload";
+                if ((itemKind & ~ITEM_FRAGMENT) != ITEM_PAYLOAD)
+                  {
+                    if (type >= types.size ())
+                      {
+                        return false;
+                      }
+                    name = types[type];
+                  }
+                if (itemKind & ITEM_FRAGMENT)
+                  {
+                    os << name << " Fragment [" << trimmed << ":" << (trimmed + itemSize) << "]";
+                  }
+                else if (itemKind == ITEM_PAYLOAD)
+                  {
+                    os << "Payload (size=" << itemSize << ")";
+                  }
+                else if (itemKind == ITEM_HEADER)
+                  {
+                    PrintChunk (os, name, headSnapshot, offset, itemSize);
+                  }
+                else
+                  {
+                    PrintChunk (os, name, tailSnapshot,
+                                static_cast<int64_t> (offset) - (size - tailLen), itemSize);
+                  }
+                offset += itemSize;
+                if (j + 1 < nItems)
+                  {
+                    os << " ";
+                  }
+              }
+            if (truncated)
+              {
+                os << " ...";
+              }
+            os << std::endl;
+            break;
+          }
+        default:
+          return false;
+        }
+    }
+}
+
+bool
+BinaryTraceFile::Decode (std::string const &filename, std::ostream &os)
+{
+  NS_LOG_FUNCTION (filename << &os);
+  std::ios::openmode mode = std::ios::in | std::ios::binary;
+  CompressedFileBuf::Format format = CompressedFileBuf::ResolveFormat (filename, mode);
+  if (format != CompressedFileBuf::NONE)
+    {
+      CompressedFileBuf buf;
+      if (!buf.Open (filename, mode, format))
+        {
+          return false;
+        }
+      std::istream is (&buf);
+      return Decode (is, os);
+    }
+  std::ifstream is (filename.c_str (), mode);
+  if (!is)
+    {
+      return false;
+    }
+  return Decode (is, os);
+}
+
+} // namespace ns3
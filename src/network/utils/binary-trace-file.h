@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <istream>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/type-id.h"
+
+namespace ns3 {
+
+class Packet;
+class CompressedFileBuf;
+class BinaryTraceTextBuf;
+
+/**
+ * \ingroup network
+ *
+ * \brief A compact binary alternative to ascii trace files.
+ *
+ * The default ascii trace sinks print each packet with Packet::Print,
+ * which formats every header as text. When they write to a binary trace
+ * file instead (see AsciiTraceHelper::CreateBinaryFileStream), each event is
+ * stored as a fixed-size record holding the time, the trace context (and
+ * the node and device parsed from it), the event type, the packet uid and
+ * size, the layout of the packet headers, payload and trailers and a raw
+ * snapshot of the first and last bytes of the packet.
+ *
+ * Text written to the stream returned by GetTextStream (for example by
+ * custom trace sinks) is stored verbatim in the file.
+ *
+ * Decode renders a binary trace file as the ascii trace file which the
+ * default sinks would have written: the headers are deserialized from the
+ * snapshot and printed. Headers which do not fit in the snapshot are
+ * printed as "(truncated)". The decode-binary-trace program in utils
+ * decodes a file from the command line.
+ *
+ * A file name ending with ".gz" or ".zst" is compressed (see
+ * CompressedFileBuf).
+ *
+ * File format (version 2). All integers are unsigned and little-endian.
+ * The file starts with the 8 magic bytes "ns3trb", 0, 2 followed by one
+ * byte holding the Time::Unit of the simulator resolution. The records
+ * follow, each starting with a one-byte kind:
+ *   - 1, context: u32 id, u32 node, u32 device, u16 length, then the
+ *     context string. The node and device are 0xffffffff when the context
+ *     is not a device path. Identifiers are allocated from 0 in order of
+ *     first use; a file appended to by a new writer redefines them.
+ *   - 2, type: u16 id, u16 length, then the type name of a header or
+ *     trailer.
+ *   - 3, text: u32 length, then the text.
+ *   - 4, event: the event character, u32 context id (0xffffffff without
+ *     context), u32 node, u32 device, u64 time in time steps of the file
+ *     resolution (see Time::GetTimeStep), u64 packet uid, u32 packet size,
+ *     u8 number of items, u8 set if there were more than MAX_ITEMS items,
+ *     u8 head snapshot length, u8 tail snapshot length; then MAX_ITEMS item
+ *     descriptions, each of u16 type id (0xffff for payloads), u8 kind
+ *     (0 payload, 1 header, 2 trailer, plus 0x80 for fragments), u8 padding,
+ *     u32 size and u32 bytes trimmed from the start of the item; then
+ *     HEAD_SNAPSHOT_SIZE bytes of head snapshot and TAIL_SNAPSHOT_SIZE bytes
+ *     of tail snapshot, the tail one being only filled for packets with
+ *     trailers.
+ */
+class BinaryTraceFile : public SimpleRefCount<BinaryTraceFile>
+{
+public:
+  /**
+   * \param filename the name of the file to write
+   * \param filemode std::ios::openmode flags
+   */
+  BinaryTraceFile (std::string const &filename, std::ios::openmode filemode = std::ios::out);
+  ~BinaryTraceFile ();
+
+  /**
+   * \brief Write a packet event.
+   *
+   * \param event the event type, as printed in ascii traces ('+', '-', 'd', 'r', 't')
+   * \param context the trace context, empty if the trace source was
+   *        connected without context
+   * \param p the packet
+   */
+  void WriteEvent (char event, std::string const &context, Ptr<const Packet> p);
+
+  /**
+   * \returns a stream which writes text records to the file
+   */
+  std::ostream *GetTextStream (void);
+
+  /**
+   * \brief Write the buffered records to the file.
+   */
+  void Flush (void);
+
+  /**
+   * \returns true if the file could not be opened or written
+   */
+  bool Fail (void) const;
+
+  /**
+   * \brief Render a binary trace as ascii trace lines.
+   *
+   * \param is the binary trace
+   * \param os the stream to write the ascii trace to
+   * \returns false if \p is is not a valid binary trace
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+  /**
+   * \brief Render a binary trace file as ascii trace lines.
+   *
+   * \param filename the binary trace file, possibly compressed
+   * \param os the stream to write the ascii trace to
+   * \returns false if the file cannot be read or is not a valid binary trace
+   */
+  static bool Decode (std::string const &filename, std::ostream &os);
+
+  /// Size of the raw snapshot of the first bytes of the packets
+  static const uint32_t HEAD_SNAPSHOT_SIZE = 96;
+  /// Size of the raw snapshot of the last bytes of the packets
+  static const uint32_t TAIL_SNAPSHOT_SIZE = 32;
+  /// Maximum number of headers, trailers and payloads described per packet
+  static const uint32_t MAX_ITEMS = 8;
+
+private:
+  friend class BinaryTraceTextBuf;
+
+  /**
+   * \param context the trace context
+   * \returns the identifier of the context, written to the file on first use
+   */
+  uint32_t GetContextId (std::string const &context);
+  /**
+   * \param tid the type of a header or trailer
+   * \returns the identifier of the type name, written to the file on first use
+   */
+  uint16_t GetTypeNameId (TypeId tid);
+  /**
+   * \param size the size of a record
+   * \returns a pointer to \p size bytes at the end of the record block
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \brief Write the text written to the text stream so far as a text record.
+   */
+  void WriteText (void);
+
+  CompressedFileBuf *m_compressedBuf;         //!< compressed file, if any
+  std::ostream *m_file;                       //!< the output stream
+  std::vector<uint8_t> m_block;               //!< records not written yet
+  std::map<std::string, uint32_t> m_contexts; //!< context identifiers
+  std::map<uint16_t, uint16_t> m_types;       //!< type name identifiers, indexed by TypeId uid
+  BinaryTraceTextBuf *m_textBuf;              //!< buffer of the text stream
+  std::ostream *m_text;                       //!< the text stream
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
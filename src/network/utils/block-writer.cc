@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "block-writer.h"
+#ifdef HAVE_PTHREAD_H
+#include <mutex>
+#include <condition_variable>
+#include "ns3/system-thread.h"
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BlockWriter");
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup network
+ *
+ * \brief The background thread shared by the block writers.
+ */
+struct BlockWriter::Thread
+{
+  Thread ()
+    : m_nWriters (0),
+      m_stop (false),
+      m_running (false)
+  {
+  }
+
+  /// Protects the queue, the block lists, counters and failure flags of the writers
+  std::mutex m_mutex;
+  /// Notified when a block is queued or when the thread must exit
+  std::condition_variable m_pendingCondition;
+  std::condition_variable m_freeCondition; //!< notified when a block is written
+  std::list<Block *> m_pending;       //!< blocks waiting to be written, in order
+  uint32_t m_nWriters;                //!< number of block writers
+  Ptr<SystemThread> m_thread;         //!< the thread
+  bool m_stop;                        //!< true when the thread must exit
+  bool m_running;                     //!< true once the thread has set m_id
+  SystemThread::ThreadId m_id;        //!< identifier of the thread
+};
+
+BlockWriter::Thread *
+BlockWriter::GetThread (void)
+{
+  // never deleted, so that the writers destroyed at exit can still use it
+  static Thread *thread = new Thread ();
+  return thread;
+}
+#endif /* HAVE_PTHREAD_H */
+
+BlockWriter::BlockWriter (Callback<bool, uint8_t const *, uint32_t> write, uint32_t blockSize, uint32_t maxBlocks)
+  : m_write (write),
+    m_blockSize (blockSize),
+    m_maxBlocks (std::max (maxBlocks, 2U)),
+    m_nBlocks (1),
+    m_nPending (0),
+    m_current (new Block),
+    m_fail (false)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  m_current->m_writer = this;
+  m_current->m_data.resize (m_blockSize);
+  m_current->m_used = 0;
+#ifdef HAVE_PTHREAD_H
+  Thread *thread = GetThread ();
+  std::lock_guard<std::mutex> lock (thread->m_mutex);
+  if (thread->m_nWriters++ == 0)
+    {
+      thread->m_stop = false;
+      thread->m_thread = Create<SystemThread> (MakeCallback (&BlockWriter::Run));
+      thread->m_thread->Start ();
+    }
+#endif
+}
+
+BlockWriter::~BlockWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  NS_ASSERT (m_nPending == 0);
+  delete m_current;
+  for (std::list<Block *>::iterator i = m_free.begin (); i != m_free.end (); ++i)
+    {
+      delete *i;
+    }
+#ifdef HAVE_PTHREAD_H
+  Thread *thread = GetThread ();
+  Ptr<SystemThread> stopped;
+  {
+    std::lock_guard<std::mutex> lock (thread->m_mutex);
+    if (--thread->m_nWriters == 0)
+      {
+        thread->m_stop = true;
+        stopped = thread->m_thread;
+        thread->m_thread = 0;
+        thread->m_pendingCondition.notify_one ();
+      }
+  }
+  if (stopped != 0)
+    {
+      stopped->Join ();
+    }
+#endif
+}
+
+uint8_t *
+BlockWriter::Reserve (uint32_t size)
+{
+  if (m_current->m_used + size > m_current->m_data.size () && m_current->m_used > 0)
+    {
+      Submit ();
+    }
+  if (size > m_current->m_data.size ())
+    {
+      // a record larger than a block gets a block of its own
+      m_current->m_data.resize (size);
+    }
+  uint8_t *data = m_current->m_data.data () + m_current->m_used;
+  m_current->m_used += size;
+  return data;
+}
+
+void
+BlockWriter::Write (uint8_t const *data, uint32_t size)
+{
+  while (size > 0)
+    {
+      if (m_current->m_used == m_current->m_data.size ())
+        {
+          Submit ();
+        }
+      uint32_t n = std::min<uint32_t> (size, m_current->m_data.size () - m_current->m_used);
+      std::memcpy (m_current->m_data.data () + m_current->m_used, data, n);
+      m_current->m_used += n;
+      data += n;
+      size -= n;
+    }
+}
+
+bool
+BlockWriter::WriteBlock (Block *block)
+{
+  bool ok = m_write (block->m_data.data (), block->m_used);
+  block->m_used = 0;
+  return ok;
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+BlockWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  Thread *thread = GetThread ();
+  std::unique_lock<std::mutex> lock (thread->m_mutex);
+  if (thread->m_running && SystemThread::Equals (thread->m_id))
+    {
+      // already in the background thread, which writes its blocks in order
+      lock.unlock ();
+      bool ok = WriteBlock (m_current);
+      lock.lock ();
+      m_fail = m_fail || !ok;
+      return;
+    }
+  thread->m_pending.push_back (m_current);
+  m_nPending++;
+  thread->m_pendingCondition.notify_one ();
+  if (m_free.empty () && m_nBlocks < m_maxBlocks)
+    {
+      m_current = new Block;
+      m_current->m_writer = this;
+      m_current->m_data.resize (m_blockSize);
+      m_current->m_used = 0;
+      m_nBlocks++;
+      return;
+    }
+  // when all the blocks wait to be written, apply backpressure
+  while (m_free.empty ())
+    {
+      thread->m_freeCondition.wait (lock);
+    }
+  m_current = m_free.front ();
+  m_free.pop_front ();
+}
+
+bool
+BlockWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  Thread *thread = GetThread ();
+  std::unique_lock<std::mutex> lock (thread->m_mutex);
+  while (m_nPending > 0)
+    {
+      thread->m_freeCondition.wait (lock);
+    }
+  lock.unlock ();
+  // no block of this writer is left in the thread: write the last one here
+  bool ok = m_current->m_used == 0 || WriteBlock (m_current);
+  lock.lock ();
+  m_fail = m_fail || !ok;
+  return !m_fail;
+}
+
+bool
+BlockWriter::Fail (void) const
+{
+  std::lock_guard<std::mutex> lock (GetThread ()->m_mutex);
+  return m_fail;
+}
+
+void
+BlockWriter::Run (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Thread *thread = GetThread ();
+  std::unique_lock<std::mutex> lock (thread->m_mutex);
+  thread->m_id = SystemThread::Self ();
+  thread->m_running = true;
+  while (true)
+    {
+      while (thread->m_pending.empty () && !thread->m_stop)
+        {
+          thread->m_pendingCondition.wait (lock);
+        }
+      if (thread->m_pending.empty ())
+        {
+          thread->m_running = false;
+          return;
+        }
+      Block *block = thread->m_pending.front ();
+      thread->m_pending.pop_front ();
+      lock.unlock ();
+
+      BlockWriter *writer = block->m_writer;
+      bool ok = writer->WriteBlock (block);
+
+      lock.lock ();
+      writer->m_fail = writer->m_fail || !ok;
+      writer->m_free.push_back (block);
+      writer->m_nPending--;
+      thread->m_freeCondition.notify_all ();
+    }
+}
+#else /* HAVE_PTHREAD_H */
+void
+BlockWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fail = !WriteBlock (m_current) || m_fail;
+}
+
+bool
+BlockWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current->m_used > 0)
+    {
+      Submit ();
+    }
+  return !m_fail;
+}
+
+bool
+BlockWriter::Fail (void) const
+{
+  return m_fail;
+}
+
+void
+BlockWriter::Run (void)
+{
+}
+#endif /* HAVE_PTHREAD_H */
+
+} // namespace ns3
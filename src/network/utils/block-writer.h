@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BLOCK_WRITER_H
+#define BLOCK_WRITER_H
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Buffers data in blocks written to a file by a shared background
+ * thread.
+ *
+ * The trace files which buffer their output (pcap files with block
+ * buffering, compressed files) append their data to the current block of
+ * a BlockWriter. Full blocks are queued to a single background thread,
+ * shared by all the block writers of the process, which hands them in
+ * order to the write callback of their writer. The thread starts with the
+ * first writer and is joined when the last one is destroyed.
+ *
+ * The number of blocks of a writer is bounded: when all of them wait to
+ * be written, queuing a block waits until the thread has written one.
+ *
+ * Flush, and the destructor, return once all the data given to the writer
+ * has been handed to the write callback. Once the queued blocks are
+ * written, the last partial block is written by the calling thread.
+ *
+ * Blocks queued from the background thread itself, for example by a
+ * compressed file receiving the blocks of a pcap file, are written
+ * directly. Without threading support, all the blocks are written
+ * directly when they are full.
+ */
+class BlockWriter
+{
+public:
+  /**
+   * \param write the callback which writes a block to the file and
+   *        returns true on success
+   * \param blockSize the size of a block, in bytes
+   * \param maxBlocks the maximum number of blocks of this writer
+   */
+  BlockWriter (Callback<bool, uint8_t const *, uint32_t> write, uint32_t blockSize, uint32_t maxBlocks);
+  /**
+   * Write all the data and release the background thread.
+   */
+  ~BlockWriter ();
+
+  /**
+   * \param size the number of bytes to reserve
+   * \returns a pointer to \p size contiguous bytes at the end of the
+   *          current block, to be filled before the next call
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \param data the data to append
+   * \param size the number of bytes to append
+   */
+  void Write (uint8_t const *data, uint32_t size);
+  /**
+   * \brief Write all the data given to the writer so far.
+   * \returns false if writing a block failed
+   */
+  bool Flush (void);
+  /**
+   * \returns true if writing a block failed
+   */
+  bool Fail (void) const;
+
+private:
+  /// A block of data
+  struct Block
+  {
+    BlockWriter *m_writer;       //!< the writer of the block
+    std::vector<uint8_t> m_data; //!< block storage
+    uint32_t m_used;             //!< number of bytes used in m_data
+  };
+
+  /// State of the background thread
+  struct Thread;
+  /**
+   * \returns the state of the background thread
+   */
+  static Thread *GetThread (void);
+  /// Queue the current block and get an empty one
+  void Submit (void);
+  /**
+   * Write a block with the write callback.
+   * \param block the block to write
+   * \returns true on success
+   */
+  bool WriteBlock (Block *block);
+  /// Background thread loop
+  static void Run (void);
+
+  Callback<bool, uint8_t const *, uint32_t> m_write; //!< the write callback
+  uint32_t m_blockSize;         //!< size of a block
+  uint32_t m_maxBlocks;         //!< maximum number of blocks
+  uint32_t m_nBlocks;           //!< number of allocated blocks
+  uint32_t m_nPending;          //!< number of blocks queued or being written
+  Block *m_current;             //!< block being filled
+  std::list<Block *> m_free;    //!< empty blocks
+  bool m_fail;                  //!< true if a write failed
+};
+
+} // namespace ns3
+
+#endif /* BLOCK_WRITER_H */
@@ -0,0 +1,565 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "compressed-file-buf.h"
+#include "block-writer.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressedFileBuf");
+
+/// Size of the blocks of uncompressed data
+static const uint32_t BLOCK_SIZE = 1 << 16;
+/// Maximum number of blocks of uncompressed data
+static const uint32_t MAX_BLOCKS = 8;
+
+/**
+ * \ingroup network
+ *
+ * \brief Compresses data to, or decompresses data from, a file.
+ */
+class CompressedFileCodec
+{
+public:
+  virtual ~CompressedFileCodec ()
+  {
+  }
+  /**
+   * \param filename the file name
+   * \param mode the open mode
+   * \returns true on success
+   */
+  virtual bool Open (std::string const &filename, std::ios::openmode mode) = 0;
+  /**
+   * \param data the buffer to fill with uncompressed data
+   * \param size the size of the buffer
+   * \returns the number of bytes read, 0 at the end of the file and -1 on error
+   */
+  virtual int32_t Read (char *data, uint32_t size) = 0;
+  /**
+   * \param data the uncompressed data
+   * \param size the number of bytes to compress
+   * \returns true on success
+   */
+  virtual bool Write (uint8_t const *data, uint32_t size) = 0;
+  /**
+   * Write all the data compressed so far to the file, so that it can be
+   * decompressed up to this point.
+   * \returns true on success
+   */
+  virtual bool Flush (void) = 0;
+  /**
+   * Finish the compressed stream, if any, and close the file.
+   * \returns true on success
+   */
+  virtual bool Close (void) = 0;
+};
+
+#ifdef HAVE_ZLIB
+/**
+ * \ingroup network
+ *
+ * \brief Gzip codec based on the zlib gzFile interface.
+ */
+class GzipCodec : public CompressedFileCodec
+{
+public:
+  GzipCodec ()
+    : m_file (0)
+  {
+  }
+  virtual bool Open (std::string const &filename, std::ios::openmode mode)
+  {
+    const char *gzMode = "rb";
+    if (mode & std::ios::out)
+      {
+        gzMode = (mode & std::ios::app) ? "ab" : "wb";
+      }
+    m_file = gzopen (filename.c_str (), gzMode);
+    if (m_file == 0)
+      {
+        return false;
+      }
+    gzbuffer (m_file, BLOCK_SIZE);
+    return true;
+  }
+  virtual int32_t Read (char *data, uint32_t size)
+  {
+    return gzread (m_file, data, size);
+  }
+  virtual bool Write (uint8_t const *data, uint32_t size)
+  {
+    return gzwrite (m_file, data, size) == static_cast<int> (size);
+  }
+  virtual bool Flush (void)
+  {
+    return gzflush (m_file, Z_SYNC_FLUSH) == Z_OK;
+  }
+  virtual bool Close (void)
+  {
+    int status = gzclose (m_file);
+    m_file = 0;
+    return status == Z_OK;
+  }
+
+private:
+  gzFile m_file; //!< the gzip file
+};
+#endif /* HAVE_ZLIB */
+
+#ifdef HAVE_ZSTD
+/**
+ * \ingroup network
+ *
+ * \brief Zstandard codec based on the zstd streaming interface.
+ */
+class ZstdCodec : public CompressedFileCodec
+{
+public:
+  ZstdCodec ()
+    : m_file (0),
+      m_cstream (0),
+      m_dstream (0)
+  {
+  }
+  virtual bool Open (std::string const &filename, std::ios::openmode mode)
+  {
+    if (mode & std::ios::out)
+      {
+        m_file = std::fopen (filename.c_str (), (mode & std::ios::app) ? "ab" : "wb");
+        m_cstream = ZSTD_createCStream ();
+        m_buffer.resize (ZSTD_CStreamOutSize ());
+        if (m_cstream == 0 || ZSTD_isError (ZSTD_initCStream (m_cstream, 3)))
+          {
+            return false;
+          }
+      }
+    else
+      {
+        m_file = std::fopen (filename.c_str (), "rb");
+        m_dstream = ZSTD_createDStream ();
+        m_buffer.resize (ZSTD_DStreamInSize ());
+        m_input.src = &m_buffer[0];
+        m_input.size = 0;
+        m_input.pos = 0;
+        if (m_dstream == 0 || ZSTD_isError (ZSTD_initDStream (m_dstream)))
+          {
+            return false;
+          }
+      }
+    return m_file != 0;
+  }
+  virtual int32_t Read (char *data, uint32_t size)
+  {
+    ZSTD_outBuffer output = { data, size, 0 };
+    while (output.pos == 0)
+      {
+        if (m_input.pos == m_input.size)
+          {
+            m_input.size = std::fread (&m_buffer[0], 1, m_buffer.size (), m_file);
+            m_input.pos = 0;
+            if (m_input.size == 0)
+              {
+                return std::ferror (m_file) ? -1 : 0;
+              }
+          }
+        if (ZSTD_isError (ZSTD_decompressStream (m_dstream, &output, &m_input)))
+          {
+            return -1;
+          }
+      }
+    return output.pos;
+  }
+  virtual bool Write (uint8_t const *data, uint32_t size)
+  {
+    ZSTD_inBuffer input = { data, size, 0 };
+    while (input.pos < input.size)
+      {
+        ZSTD_outBuffer output = { &m_buffer[0], m_buffer.size (), 0 };
+        if (ZSTD_isError (ZSTD_compressStream (m_cstream, &output, &input))
+            || std::fwrite (&m_buffer[0], 1, output.pos, m_file) != output.pos)
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+  virtual bool Flush (void)
+  {
+    size_t remaining = 1;
+    while (remaining != 0)
+      {
+        ZSTD_outBuffer output = { &m_buffer[0], m_buffer.size (), 0 };
+        remaining = ZSTD_flushStream (m_cstream, &output);
+        if (ZSTD_isError (remaining)
+            || std::fwrite (&m_buffer[0], 1, output.pos, m_file) != output.pos)
+          {
+            return false;
+          }
+      }
+    return std::fflush (m_file) == 0;
+  }
+  virtual bool Close (void)
+  {
+    bool ok = m_file != 0;
+    if (m_cstream != 0)
+      {
+        size_t remaining = 1;
+        while (ok && remaining != 0)
+          {
+            ZSTD_outBuffer output = { &m_buffer[0], m_buffer.size (), 0 };
+            remaining = ZSTD_endStream (m_cstream, &output);
+            ok = !ZSTD_isError (remaining)
+              && std::fwrite (&m_buffer[0], 1, output.pos, m_file) == output.pos;
+          }
+        ZSTD_freeCStream (m_cstream);
+        m_cstream = 0;
+      }
+    if (m_dstream != 0)
+      {
+        ZSTD_freeDStream (m_dstream);
+        m_dstream = 0;
+      }
+    if (m_file != 0)
+      {
+        ok = std::fclose (m_file) == 0 && ok;
+        m_file = 0;
+      }
+    return ok;
+  }
+
+private:
+  std::FILE *m_file;          //!< the file
+  ZSTD_CStream *m_cstream;    //!< the compression context, when writing
+  ZSTD_DStream *m_dstream;    //!< the decompression context, when reading
+  std::vector<char> m_buffer; //!< compressed data
+  ZSTD_inBuffer m_input;      //!< compressed data not decompressed yet
+};
+#endif /* HAVE_ZSTD */
+
+/**
+ * \param format GZIP or ZSTD
+ * \returns a new codec for this format, or 0 if it is not supported
+ */
+static CompressedFileCodec *
+CreateCodec (CompressedFileBuf::Format format)
+{
+  switch (format)
+    {
+#ifdef HAVE_ZLIB
+    case CompressedFileBuf::GZIP:
+      return new GzipCodec ();
+#endif
+#ifdef HAVE_ZSTD
+    case CompressedFileBuf::ZSTD:
+      return new ZstdCodec ();
+#endif
+    default:
+      return 0;
+    }
+}
+
+CompressedFileBuf::CompressedFileBuf ()
+  : m_mode (std::ios::in),
+    m_format (NONE),
+    m_codec (0),
+    m_writer (0),
+    m_position (0),
+    m_fail (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CompressedFileBuf::~CompressedFileBuf ()
+{
+  NS_LOG_FUNCTION (this);
+  if (IsOpen ())
+    {
+      Close ();
+    }
+}
+
+bool
+CompressedFileBuf::IsSupported (Format format)
+{
+  NS_LOG_FUNCTION (format);
+  switch (format)
+    {
+    case NONE:
+      return true;
+#ifdef HAVE_ZLIB
+    case GZIP:
+      return true;
+#endif
+#ifdef HAVE_ZSTD
+    case ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+    }
+}
+
+std::string
+CompressedFileBuf::GetLibraryName (Format format)
+{
+  NS_LOG_FUNCTION (format);
+  return format == GZIP ? "zlib" : "libzstd";
+}
+
+CompressedFileBuf::Format
+CompressedFileBuf::ResolveFormat (std::string const &filename, std::ios::openmode mode, Format format)
+{
+  NS_LOG_FUNCTION (filename << mode << format);
+  if (format != AUTO)
+    {
+      return format;
+    }
+  if (mode & std::ios::out)
+    {
+      std::string::size_type dot = filename.rfind ('.');
+      std::string extension = dot == std::string::npos ? "" : filename.substr (dot);
+      if (extension == ".gz")
+        {
+          return GZIP;
+        }
+      if (extension == ".zst")
+        {
+          return ZSTD;
+        }
+      return NONE;
+    }
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  uint8_t magic[4] = { 0, 0, 0, 0 };
+  file.read (reinterpret_cast<char *> (magic), sizeof (magic));
+  if (magic[0] == 0x1f && magic[1] == 0x8b)
+    {
+      return GZIP;
+    }
+  if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+    {
+      return ZSTD;
+    }
+  return NONE;
+}
+
+bool
+CompressedFileBuf::Open (std::string const &filename, std::ios::openmode mode, Format format)
+{
+  NS_LOG_FUNCTION (this << filename << mode << format);
+  NS_ASSERT (!IsOpen ());
+  CompressedFileCodec *codec = CreateCodec (format);
+  if (codec == 0)
+    {
+      NS_LOG_WARN ("Compression format " << format << " is not supported");
+      return false;
+    }
+  if (!codec->Open (filename, mode))
+    {
+      codec->Close ();
+      delete codec;
+      return false;
+    }
+  m_filename = filename;
+  m_mode = mode;
+  m_format = format;
+  m_codec = codec;
+  m_position = 0;
+  m_fail = false;
+  m_block.resize (BLOCK_SIZE);
+  if (mode & std::ios::out)
+    {
+      m_writer = new BlockWriter (MakeCallback (&CompressedFileCodec::Write, m_codec),
+                                  BLOCK_SIZE, MAX_BLOCKS);
+      setp (&m_block[0], &m_block[0] + m_block.size ());
+      setg (0, 0, 0);
+    }
+  else
+    {
+      setp (0, 0);
+      setg (&m_block[0], &m_block[0], &m_block[0]);
+    }
+  return true;
+}
+
+bool
+CompressedFileBuf::IsOpen (void) const
+{
+  return m_codec != 0;
+}
+
+bool
+CompressedFileBuf::SubmitBlock (void)
+{
+  uint32_t used = pptr () - pbase ();
+  m_position += used;
+  m_writer->Write (reinterpret_cast<uint8_t const *> (pbase ()), used);
+  setp (&m_block[0], &m_block[0] + m_block.size ());
+  m_fail = m_fail || m_writer->Fail ();
+  return !m_fail;
+}
+
+bool
+CompressedFileBuf::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer == 0)
+    {
+      return IsOpen () && !m_fail;
+    }
+  bool ok = SubmitBlock () && m_writer->Flush () && m_codec->Flush ();
+  m_fail = m_fail || !ok;
+  return ok;
+}
+
+bool
+CompressedFileBuf::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsOpen ())
+    {
+      return false;
+    }
+  bool ok = m_writer == 0 || (SubmitBlock () && m_writer->Flush ());
+  delete m_writer;
+  m_writer = 0;
+  ok = m_codec->Close () && ok;
+  delete m_codec;
+  m_codec = 0;
+  setp (0, 0);
+  setg (0, 0, 0);
+  return ok;
+}
+
+CompressedFileBuf::int_type
+CompressedFileBuf::overflow (int_type c)
+{
+  if (m_writer == 0 || !SubmitBlock ())
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+CompressedFileBuf::int_type
+CompressedFileBuf::underflow (void)
+{
+  if (gptr () < egptr ())
+    {
+      return traits_type::to_int_type (*gptr ());
+    }
+  if (m_codec == 0 || m_writer != 0)
+    {
+      return traits_type::eof ();
+    }
+  m_position += egptr () - eback ();
+  int32_t size = m_codec->Read (&m_block[0], m_block.size ());
+  if (size <= 0)
+    {
+      m_fail = m_fail || size < 0;
+      setg (&m_block[0], &m_block[0], &m_block[0]);
+      return traits_type::eof ();
+    }
+  setg (&m_block[0], &m_block[0], &m_block[0] + size);
+  return traits_type::to_int_type (*gptr ());
+}
+
+int
+CompressedFileBuf::sync (void)
+{
+  NS_LOG_FUNCTION (this);
+  // std::endl must not end a compressed block: Flush does
+  if (m_writer == 0)
+    {
+      return IsOpen () && !m_fail ? 0 : -1;
+    }
+  return SubmitBlock () ? 0 : -1;
+}
+
+CompressedFileBuf::pos_type
+CompressedFileBuf::seekoff (off_type off, std::ios::seekdir way, std::ios::openmode which)
+{
+  NS_LOG_FUNCTION (this << off << way << which);
+  pos_type error = pos_type (off_type (-1));
+  if (!IsOpen () || way == std::ios::end)
+    {
+      return error;
+    }
+  if (m_writer != 0)
+    {
+      int64_t current = m_position + (pptr () - pbase ());
+      if (way == std::ios::beg ? off != current : off != 0)
+        {
+          return error;
+        }
+      return pos_type (current);
+    }
+  int64_t current = m_position + (gptr () - eback ());
+  int64_t target = way == std::ios::beg ? off : current + off;
+  if (target < 0)
+    {
+      return error;
+    }
+  if (target < current)
+    {
+      // go back by reading the file again from its start
+      std::string filename = m_filename;
+      std::ios::openmode mode = m_mode;
+      Format format = m_format;
+      Close ();
+      if (!Open (filename, mode, format))
+        {
+          return error;
+        }
+      current = 0;
+    }
+  while (current < target)
+    {
+      if (gptr () == egptr () && traits_type::eq_int_type (underflow (), traits_type::eof ()))
+        {
+          return error;
+        }
+      int64_t size = std::min<int64_t> (egptr () - gptr (), target - current);
+      gbump (size);
+      current += size;
+    }
+  return pos_type (current);
+}
+
+CompressedFileBuf::pos_type
+CompressedFileBuf::seekpos (pos_type pos, std::ios::openmode which)
+{
+  return seekoff (off_type (pos), std::ios::beg, which);
+}
+
+} // namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSED_FILE_BUF_H
+#define COMPRESSED_FILE_BUF_H
+
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <ios>
+#include <stdint.h>
+
+namespace ns3 {
+
+class BlockWriter;
+class CompressedFileCodec;
+
+/**
+ * \ingroup network
+ *
+ * \brief A stream buffer which reads or writes a compressed file.
+ *
+ * Written data is accumulated in blocks which are compressed and written
+ * to the file by the background thread of a BlockWriter when threading
+ * is available, so that compressing does not block the caller. Read data
+ * is decompressed on demand.
+ *
+ * Gzip files are supported when zlib is found at configure time, and
+ * zstd files when libzstd is found.
+ *
+ * Seeking is limited to what sequential access allows: the position can
+ * be queried, an input stream can skip forward or go back to its start,
+ * and an output stream can "seek" to its current position.
+ *
+ * Flushing a stream using this buffer (std::flush, std::endl) only hands
+ * the data written so far over to the writer, so that traces ending each
+ * line with std::endl keep their compression ratio. Flush writes all the
+ * data to the file, which can then be decompressed up to this point
+ * (gzip Z_SYNC_FLUSH, zstd ZSTD_flushStream), and ends a compressed block.
+ */
+class CompressedFileBuf : public std::streambuf
+{
+public:
+  /// Compression formats
+  enum Format
+  {
+    AUTO,  //!< select the format from the file name (or content, when reading)
+    NONE,  //!< no compression
+    GZIP,  //!< gzip (zlib)
+    ZSTD   //!< zstandard
+  };
+
+  CompressedFileBuf ();
+  virtual ~CompressedFileBuf ();
+
+  /**
+   * \param format a compression format
+   * \returns true if this build can read and write files in this format
+   */
+  static bool IsSupported (Format format);
+  /**
+   * \param format GZIP or ZSTD
+   * \returns the name of the library which implements the format
+   */
+  static std::string GetLibraryName (Format format);
+
+  /**
+   * \brief Resolve the format of a file.
+   *
+   * For AUTO, files opened for reading are identified from their first
+   * bytes, and files opened for writing from the extension of their name
+   * (".gz" or ".zst"). Other formats are returned unchanged.
+   *
+   * \param filename the file name
+   * \param mode the mode in which the file is to be opened
+   * \param format the requested format
+   * \returns the format to use for this file
+   */
+  static Format ResolveFormat (std::string const &filename, std::ios::openmode mode,
+                               Format format = AUTO);
+
+  /**
+   * \brief Open a compressed file.
+   *
+   * The file is opened either for reading or for writing (possibly in
+   * append mode, which adds a new compressed member to the file).
+   *
+   * \param filename the file name
+   * \param mode the open mode
+   * \param format GZIP or ZSTD
+   * \returns true on success
+   */
+  bool Open (std::string const &filename, std::ios::openmode mode, Format format);
+
+  /**
+   * \returns true if a file is open
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \brief Write all the buffered data to the file.
+   *
+   * The data written so far can be decompressed from the file once this
+   * returns.
+   *
+   * \returns true on success
+   */
+  bool Flush (void);
+
+  /**
+   * \brief Write all the buffered data and close the file.
+   * \returns true on success
+   */
+  bool Close (void);
+
+protected:
+  virtual int_type overflow (int_type c);
+  virtual int_type underflow (void);
+  virtual int sync (void);
+  virtual pos_type seekoff (off_type off, std::ios::seekdir way,
+                            std::ios::openmode which = std::ios::in | std::ios::out);
+  virtual pos_type seekpos (pos_type pos,
+                            std::ios::openmode which = std::ios::in | std::ios::out);
+
+private:
+  /**
+   * \brief Hand the content of the put area over to the writer.
+   * \returns true on success
+   */
+  bool SubmitBlock (void);
+
+  std::string m_filename;         //!< the file name
+  std::ios::openmode m_mode;      //!< the open mode
+  Format m_format;                //!< the compression format
+  CompressedFileCodec *m_codec;   //!< the compressor or decompressor
+  BlockWriter *m_writer;          //!< the writer of uncompressed blocks
+  std::vector<char> m_block;      //!< the get or put area
+  int64_t m_position;             //!< uncompressed offset of the get or put area
+  bool m_fail;                    //!< true if an operation failed
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSED_FILE_BUF_H */
@@ -188,4 +188,43 @@ EthernetHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+EthernetHeaderView::EthernetHeaderView (Ptr<const Packet> packet)
+  : HeaderView<EthernetHeader> (packet, 14)
+{
+}
+
+Mac48Address
+EthernetHeaderView::GetDestination (void) const
+{
+  if (IsDirect ())
+    {
+      Mac48Address address;
+      address.CopyFrom (GetData (0));
+      return address;
+    }
+  return GetHeader ().GetDestination ();
+}
+
+Mac48Address
+EthernetHeaderView::GetSource (void) const
+{
+  if (IsDirect ())
+    {
+      Mac48Address address;
+      address.CopyFrom (GetData (6));
+      return address;
+    }
+  return GetHeader ().GetSource ();
+}
+
+uint16_t
+EthernetHeaderView::GetLengthType (void) const
+{
+  if (IsDirect ())
+    {
+      return ReadNtohU16 (12);
+    }
+  return GetHeader ().GetLengthType ();
+}
+
 } // namespace ns3
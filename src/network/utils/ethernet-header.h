@@ -22,6 +22,7 @@
 #define ETHERNET_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include <string>
 #include "ns3/mac48-address.h"
 
@@ -130,6 +131,33 @@ private:
   Mac48Address m_destination;   //!< Destination address
 };
 
+/**
+ * \ingroup network
+ *
+ * \brief Read-only view of an EthernetHeader (without preamble)
+ * stored at the start of a packet.
+ */
+class EthernetHeaderView : public HeaderView<EthernetHeader>
+{
+public:
+  /**
+   * \param packet the packet which starts with the Ethernet header
+   */
+  EthernetHeaderView (Ptr<const Packet> packet);
+  /**
+   * \return The destination address of this packet
+   */
+  Mac48Address GetDestination (void) const;
+  /**
+   * \return The source address of this packet
+   */
+  Mac48Address GetSource (void) const;
+  /**
+   * \return The size of the payload in bytes, or the type of the payload
+   */
+  uint16_t GetLengthType (void) const;
+};
+
 } // namespace ns3
 
 
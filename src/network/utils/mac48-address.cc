@@ -264,6 +264,18 @@ std::ostream& operator<< (std::ostream& os, const Mac48Address & address)
   return os;
 }
 
+size_t
+Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  // the allocated addresses differ in their last bytes
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      value = (value << 8) | x.m_address[i];
+    }
+  return static_cast<size_t> (value ^ (value >> 32));
+}
+
 std::istream& operator>> (std::istream& is, Mac48Address & address)
 {
   std::string v;
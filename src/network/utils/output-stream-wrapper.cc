@@ -21,15 +21,31 @@
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
 #include <fstream>
+#include "compressed-file-buf.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_compressedBuf (0),
+    m_destroyable (true)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
+  CompressedFileBuf::Format format = CompressedFileBuf::ResolveFormat (filename, filemode | std::ios::out);
+  if (format != CompressedFileBuf::NONE)
+    {
+      NS_ABORT_MSG_UNLESS (CompressedFileBuf::IsSupported (format), "AsciiTraceHelper::CreateFileStream():  " <<
+                           "Unable to Open " << filename << ": " << CompressedFileBuf::GetLibraryName (format) <<
+                           " was not found at configure time");
+      m_compressedBuf = new CompressedFileBuf ();
+      bool open = m_compressedBuf->Open (filename, filemode | std::ios::out, format);
+      m_ostream = new std::ostream (m_compressedBuf);
+      FatalImpl::RegisterStream (m_ostream);
+      NS_ABORT_MSG_UNLESS (open, "AsciiTraceHelper::CreateFileStream():  " <<
+                           "Unable to Open " << filename << " for mode " << filemode);
+      return;
+    }
   std::ofstream* os = new std::ofstream ();
   os->open (filename.c_str (), filemode);
   m_ostream = os;
@@ -39,19 +55,31 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_compressedBuf (0), m_destroyable (false)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (m_ostream->good (), "Output stream is not vaild for writing.");
 }
 
+OutputStreamWrapper::OutputStreamWrapper (Ptr<BinaryTraceFile> file)
+  : m_ostream (file->GetTextStream ()),
+    m_compressedBuf (0),
+    m_binaryTraceFile (file),
+    m_destroyable (false)
+{
+  NS_LOG_FUNCTION (this << file);
+  FatalImpl::RegisterStream (m_ostream);
+}
+
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
+  delete m_compressedBuf;
+  m_compressedBuf = 0;
 }
 
 std::ostream *
@@ -61,4 +89,11 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+Ptr<BinaryTraceFile>
+OutputStreamWrapper::GetBinaryTraceFile (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_binaryTraceFile;
+}
+
 } // namespace ns3
@@ -23,9 +23,12 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
+#include "binary-trace-file.h"
 
 namespace ns3 {
 
+class CompressedFileBuf;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -72,6 +75,10 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
 public:
   /**
    * Constructor
+   *
+   * If the file name ends with ".gz" or ".zst", the file is compressed
+   * (see CompressedFileBuf).
+   *
    * \param filename file name
    * \param filemode std::ios::openmode flags
    */
@@ -81,6 +88,14 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor
+   *
+   * The stream writes text records to the binary trace file.
+   *
+   * \param file binary trace file
+   */
+  OutputStreamWrapper (Ptr<BinaryTraceFile> file);
   ~OutputStreamWrapper ();
 
   /**
@@ -92,8 +107,16 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * \returns the binary trace file written by this wrapper, or 0 if the
+   *          wrapper writes to a plain output stream
+   */
+  Ptr<BinaryTraceFile> GetBinaryTraceFile (void) const;
+
 private:
   std::ostream *m_ostream; //!< The output stream
+  CompressedFileBuf *m_compressedBuf; //!< The compressed file, if any
+  Ptr<BinaryTraceFile> m_binaryTraceFile; //!< The binary trace file, if any
   bool m_destroyable; //!< Can be destroyed
 };
 
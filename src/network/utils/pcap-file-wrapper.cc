@@ -19,8 +19,10 @@
 #include "ns3/log.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/simulator.h"
 #include "pcap-file-wrapper.h"
 
 namespace ns3 {
@@ -46,6 +48,28 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("BlockSize",
+                   "Size in bytes of the blocks in which records are buffered before "
+                   "being written to the file by a background thread. "
+                   "Zero writes each record to the file directly.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_blockSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxBlocks",
+                   "Maximum number of blocks allocated when BlockSize is not zero. "
+                   "Writing a record blocks when all of them wait to be written.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_maxBlocks),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("Compression",
+                   "Compression of the files opened for writing. Auto selects "
+                   "it from the file name extension (.gz or .zst).",
+                   EnumValue (CompressedFileBuf::AUTO),
+                   MakeEnumAccessor (&PcapFileWrapper::m_compression),
+                   MakeEnumChecker (CompressedFileBuf::AUTO, "Auto",
+                                    CompressedFileBuf::NONE, "None",
+                                    CompressedFileBuf::GZIP, "Gzip",
+                                    CompressedFileBuf::ZSTD, "Zstd"))
   ;
   return tid;
 }
@@ -93,7 +117,19 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
-  m_file.Open (filename, mode);
+  m_file.Open (filename, mode, m_compression);
+  if (m_blockSize > 0 && (mode & std::ios::out) && !m_file.Fail ())
+    {
+      m_file.SetBlockBuffering (m_blockSize, m_maxBlocks);
+      Simulator::ScheduleDestroy (&PcapFileWrapper::Flush, Ptr<PcapFileWrapper> (this));
+    }
+}
+
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
 }
 
 void
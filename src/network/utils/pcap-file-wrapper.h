@@ -82,6 +82,12 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the records buffered by the underlying pcap file, if the
+   * "BlockSize" attribute enabled block-buffered writing.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -224,6 +230,9 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_blockSize; //!< size of the write blocks, 0 to write records directly
+  uint32_t m_maxBlocks; //!< maximum number of write blocks
+  CompressedFileBuf::Format m_compression; //!< compression of the files opened for writing
 };
 
 } // namespace ns3
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -29,6 +30,7 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#include "block-writer.h"
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -50,7 +52,9 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_blockWriter (0),
+    m_compressedBuf (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,6 +72,10 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_blockWriter != 0)
+    {
+      return m_blockWriter->Fail ();
+    }
   return m_file.fail ();
 }
 bool 
@@ -88,9 +96,50 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  delete m_blockWriter;
+  m_blockWriter = 0;
+  if (m_compressedBuf != 0)
+    {
+      // restore the file buffer of the stream before closing the compressed file
+      m_file.std::ios::rdbuf (m_file.rdbuf ());
+      if (!m_compressedBuf->Close ())
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      delete m_compressedBuf;
+      m_compressedBuf = 0;
+      return;
+    }
   m_file.close ();
 }
 
+void
+PcapFile::SetBlockBuffering (uint32_t blockSize, uint32_t maxBlocks)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  NS_ASSERT_MSG (m_blockWriter == 0, "Block buffering is already enabled");
+  m_blockWriter = new BlockWriter (MakeCallback (&PcapFile::WriteBlock, this), blockSize, maxBlocks);
+}
+
+bool
+PcapFile::WriteBlock (uint8_t const *data, uint32_t size)
+{
+  m_file.write ((const char *)data, size);
+  return !m_file.fail ();
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_blockWriter != 0)
+    {
+      m_blockWriter->Flush ();
+    }
+  // also flushes the compressed file, if any
+  m_file.flush ();
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -206,6 +255,10 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
+  if (m_blockWriter != 0)
+    {
+      m_blockWriter->Flush ();
+    }
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -322,9 +375,10 @@ PcapFile::ReadAndVerifyFileHeader (void)
 }
 
 void
-PcapFile::Open (std::string const &filename, std::ios::openmode mode)
+PcapFile::Open (std::string const &filename, std::ios::openmode mode,
+                CompressedFileBuf::Format compression)
 {
-  NS_LOG_FUNCTION (this << filename << mode);
+  NS_LOG_FUNCTION (this << filename << mode << compression);
   NS_ASSERT ((mode & std::ios::app) == 0);
   NS_ASSERT (!m_file.fail ());
   //
@@ -333,7 +387,31 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   mode |= std::ios::binary;
 
   m_filename=filename;
-  m_file.open (filename.c_str (), mode);
+  if (mode & std::ios::in)
+    {
+      compression = CompressedFileBuf::AUTO;
+    }
+  compression = CompressedFileBuf::ResolveFormat (filename, mode, compression);
+  if (compression != CompressedFileBuf::NONE)
+    {
+      m_compressedBuf = new CompressedFileBuf ();
+      if (m_compressedBuf->Open (filename, mode, compression))
+        {
+          // the stream reads and writes through the compressed file buffer
+          m_file.std::ios::rdbuf (m_compressedBuf);
+        }
+      else
+        {
+          delete m_compressedBuf;
+          m_compressedBuf = 0;
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
+    }
+  else
+    {
+      m_file.open (filename.c_str (), mode);
+    }
   if (mode & std::ios::in)
     {
       // will set the fail bit if file header is invalid.
@@ -418,6 +496,20 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
       Swap (&header, &header);
     }
 
+  if (m_blockWriter != 0)
+    {
+      uint8_t *out = m_blockWriter->Reserve (sizeof(header.m_tsSec) + sizeof(header.m_tsUsec) +
+                                             sizeof(header.m_inclLen) + sizeof(header.m_origLen));
+      memcpy (out, &header.m_tsSec, sizeof(header.m_tsSec));
+      out += sizeof(header.m_tsSec);
+      memcpy (out, &header.m_tsUsec, sizeof(header.m_tsUsec));
+      out += sizeof(header.m_tsUsec);
+      memcpy (out, &header.m_inclLen, sizeof(header.m_inclLen));
+      out += sizeof(header.m_inclLen);
+      memcpy (out, &header.m_origLen, sizeof(header.m_origLen));
+      return inclLen;
+    }
+
   //
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
@@ -435,7 +527,19 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
+  WriteRecordData (data, inclLen);
+}
+
+void
+PcapFile::WriteRecordData (uint8_t const *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  if (m_blockWriter != 0)
+    {
+      memcpy (m_blockWriter->Reserve (size), data, size);
+      return;
+    }
+  m_file.write ((const char *)data, size);
   NS_BUILD_DEBUG(m_file.flush());
 }
 
@@ -444,6 +548,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  if (m_blockWriter != 0)
+    {
+      p->CopyData (m_blockWriter->Reserve (inclLen), inclLen);
+      return;
+    }
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -460,6 +569,13 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (m_blockWriter != 0)
+    {
+      headerBuffer.CopyData (m_blockWriter->Reserve (toCopy), toCopy);
+      inclLen -= toCopy;
+      p->CopyData (m_blockWriter->Reserve (inclLen), inclLen);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
@@ -25,11 +25,13 @@
 #include <fstream>
 #include <stdint.h>
 #include "ns3/ptr.h"
+#include "compressed-file-buf.h"
 
 namespace ns3 {
 
 class Packet;
 class Header;
+class BlockWriter;
 
 
 /**
@@ -74,17 +76,50 @@ public:
    * selected as a binary file (fstream::binary is automatically ored with the mode
    * field).
    *
+   * Files opened for reading may be compressed (see CompressedFileBuf).
+   * Files opened for writing are compressed according to \p compression:
+   * by default, the compression is selected from the file name extension
+   * (".gz" or ".zst").
+   *
    * \param filename String containing the name of the file.
    *
    * \param mode the access mode for the file.
+   *
+   * \param compression the compression of a file opened for writing.
    */
-  void Open (std::string const &filename, std::ios::openmode mode);
+  void Open (std::string const &filename, std::ios::openmode mode,
+             CompressedFileBuf::Format compression = CompressedFileBuf::AUTO);
 
   /**
    * Close the underlying file.
    */
   void Close (void);
 
+  /**
+   * \brief Enable block-buffered writing of the records.
+   *
+   * Once enabled, the records are appended to in-memory blocks of
+   * \p blockSize bytes instead of being written one by one to the
+   * underlying stream. Full blocks are written in order by the background
+   * thread shared by all the block buffered files (see BlockWriter) when
+   * threading is available, and by the calling thread otherwise, so the
+   * file content is identical to the one produced in the default mode.
+   * At most \p maxBlocks blocks are allocated: when all of them wait to
+   * be written, writing a record blocks until the background thread has
+   * written one.
+   *
+   * The blocks are written to the file by Flush and Close.
+   *
+   * \param blockSize the size of a block, in bytes
+   * \param maxBlocks the maximum number of blocks
+   */
+  void SetBlockBuffering (uint32_t blockSize, uint32_t maxBlocks);
+
+  /**
+   * \brief Write all the buffered records to the file.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -361,6 +396,23 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Write the data of a packet record.
+   *
+   * \param data the data to write
+   * \param size the number of bytes to write
+   */
+  void WriteRecordData (uint8_t const *data, uint32_t size);
+
+  /**
+   * \brief Write a block of records to the stream.
+   *
+   * \param data the block
+   * \param size the size of the block, in bytes
+   * \returns true on success
+   */
+  bool WriteBlock (uint8_t const *data, uint32_t size);
+
   /**
    * \brief Read and verify a Pcap file header
    */
@@ -371,6 +423,8 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  BlockWriter *m_blockWriter; //!< block writer, 0 when records are written directly
+  CompressedFileBuf *m_compressedBuf; //!< compressed file, 0 when the file is not compressed
 };
 
 } // namespace ns3
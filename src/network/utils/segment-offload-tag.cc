@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "segment-offload-tag.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentOffloadTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentOffloadTag);
+
+TypeId
+SegmentOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentOffloadTag> ()
+  ;
+  return tid;
+}
+TypeId
+SegmentOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+SegmentOffloadTag::GetSerializedSize (void) const
+{
+  return 6;
+}
+void
+SegmentOffloadTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU16 (m_segments);
+  buf.WriteU32 (m_payloadSize);
+}
+void
+SegmentOffloadTag::Deserialize (TagBuffer buf)
+{
+  m_segments = buf.ReadU16 ();
+  m_payloadSize = buf.ReadU32 ();
+}
+void
+SegmentOffloadTag::Print (std::ostream &os) const
+{
+  os << "Segments=" << m_segments << " PayloadSize=" << m_payloadSize;
+}
+SegmentOffloadTag::SegmentOffloadTag ()
+  : Tag (),
+    m_segments (1),
+    m_payloadSize (0)
+{
+}
+
+SegmentOffloadTag::SegmentOffloadTag (uint16_t segments, uint32_t payloadSize)
+  : Tag (),
+    m_segments (segments),
+    m_payloadSize (payloadSize)
+{
+  NS_ASSERT (segments > 0);
+}
+
+uint16_t
+SegmentOffloadTag::GetSegments (void) const
+{
+  return m_segments;
+}
+
+uint32_t
+SegmentOffloadTag::GetPayloadSize (void) const
+{
+  return m_payloadSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetWireSize (uint32_t packetSize) const
+{
+  NS_ASSERT (packetSize >= m_payloadSize);
+  return packetSize + (m_segments - 1) * (packetSize - m_payloadSize);
+}
+
+} // namespace ns3
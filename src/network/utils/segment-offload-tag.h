@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENT_OFFLOAD_TAG_H
+#define SEGMENT_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Mark a packet as a super-segment standing for several wire frames.
+ *
+ * With segmentation offload, a transport protocol hands a burst of
+ * segments to the lower layers as a single packet, which carries one copy
+ * of the headers and the payload of all the segments. The IP layers do
+ * not fragment such packets, and the devices which support the offload
+ * (PointToPointNetDevice, SimpleNetDevice) transmit them in the time taken
+ * by the back-to-back frames they stand for, each one carrying its own
+ * copy of the headers. The whole super-segment is delivered to the
+ * receiver at once, as a receive offload would do.
+ *
+ * Other devices handle super-segments as ordinary packets.
+ */
+class SegmentOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentOffloadTag ();
+
+  /**
+   * \brief Constructs a SegmentOffloadTag
+   * \param segments the number of segments
+   * \param payloadSize the payload size of all the segments
+   */
+  SegmentOffloadTag (uint16_t segments, uint32_t payloadSize);
+
+  /**
+   * \returns the number of segments of the super-segment
+   */
+  uint16_t GetSegments (void) const;
+  /**
+   * \returns the payload size of all the segments, headers excluded
+   */
+  uint32_t GetPayloadSize (void) const;
+  /**
+   * \brief Get the number of bytes sent on the wire for the super-segment.
+   *
+   * The bytes of a packet which are not payload are headers, repeated in
+   * each segment.
+   *
+   * \param packetSize the size of the packet carrying the super-segment
+   * \returns the size of all the segments, headers included
+   */
+  uint32_t GetWireSize (uint32_t packetSize) const;
+
+private:
+  uint16_t m_segments;    //!< number of segments
+  uint32_t m_payloadSize; //!< payload size of all the segments
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_OFFLOAD_TAG_H */
@@ -26,6 +26,7 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
+#include "segment-offload-tag.h"
 #include "ns3/string.h"
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
@@ -462,7 +463,8 @@ bool
 SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
   NS_LOG_FUNCTION (this << p << source << dest << protocolNumber);
-  if (p->GetSize () > GetMtu ())
+  SegmentOffloadTag offloadTag;
+  if (p->GetSize () > GetMtu () && !p->PeekPacketTag (offloadTag))
     {
       return false;
     }
@@ -484,13 +486,8 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
         {
           p = m_queue->Dequeue ();
           p->RemovePacketTag (tag);
-          Time txTime = Time (0);
-          if (m_bps > DataRate (0))
-            {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
-            }
           m_channel->Send (p, protocolNumber, to, from, this);
-          TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+          TransmitCompleteEvent = Simulator::Schedule (GetTxTime (packet), &SimpleNetDevice::TransmitComplete, this);
         }
       return true;
     }
@@ -524,17 +521,27 @@ SimpleNetDevice::TransmitComplete ()
 
   if (m_queue->GetNPackets ())
     {
-      Time txTime = Time (0);
-      if (m_bps > DataRate (0))
-        {
-          txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
-        }
-      TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+      TransmitCompleteEvent = Simulator::Schedule (GetTxTime (packet), &SimpleNetDevice::TransmitComplete, this);
     }
 
   return;
 }
 
+Time
+SimpleNetDevice::GetTxTime (Ptr<const Packet> packet) const
+{
+  if (m_bps == DataRate (0))
+    {
+      return Time (0);
+    }
+  SegmentOffloadTag offloadTag;
+  if (packet->PeekPacketTag (offloadTag))
+    {
+      return m_bps.CalculateBytesTxTime (offloadTag.GetWireSize (packet->GetSize ()));
+    }
+  return m_bps.CalculateBytesTxTime (packet->GetSize ());
+}
+
 Ptr<Node> 
 SimpleNetDevice::GetNode (void) const
 {
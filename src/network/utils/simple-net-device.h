@@ -168,6 +168,13 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * \param packet a packet
+   * \returns the time taken to transmit the packet, or the back-to-back
+   *          frames standing for it if it is a super-segment
+   */
+  Time GetTxTime (Ptr<const Packet> packet) const;
+
   bool m_linkUp; //!< Flag indicating whether or not the link is up
 
   /**
@@ -196,6 +196,7 @@ RoutingProtocol::GetTypeId (void)
 
 RoutingProtocol::RoutingProtocol ()
   : m_routingTableAssociation (0),
+  m_generation (0),
   m_ipv4 (0),
   m_helloTimer (Timer::CANCEL_ON_DESTROY),
   m_tcTimer (Timer::CANCEL_ON_DESTROY),
@@ -258,6 +259,12 @@ void RoutingProtocol::DoDispose ()
   Ipv4RoutingProtocol::DoDispose ();
 }
 
+int64_t
+RoutingProtocol::GetGeneration (void) const
+{
+  return static_cast<int64_t> (m_generation) + m_hnaRoutingTable->GetGeneration ();
+}
+
 void
 RoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
 {
@@ -2819,12 +2826,14 @@ RoutingProtocol::Clear ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_table.clear ();
+  m_generation++;
 }
 
 void
 RoutingProtocol::RemoveEntry (Ipv4Address const &dest)
 {
   m_table.erase (dest);
+  m_generation++;
 }
 
 bool
@@ -3079,6 +3088,7 @@ RoutingProtocol::AddEntry (Ipv4Address const &dest,
   entry.nextAddr = next;
   entry.interface = interface;
   entry.distance = distance;
+  m_generation++;
 }
 
 void
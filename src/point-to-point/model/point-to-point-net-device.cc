@@ -26,6 +26,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/segment-offload-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -285,6 +286,14 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_phyTxBeginTrace (m_currentPkt);
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  SegmentOffloadTag offloadTag;
+  if (p->PeekPacketTag (offloadTag))
+    {
+      // A super-segment is sent as back-to-back frames, and delivered to
+      // the peer when its last frame is received.
+      int64_t gaps = offloadTag.GetSegments () - 1;
+      txTime = m_bps.CalculateBytesTxTime (offloadTag.GetWireSize (p->GetSize ())) + m_tInterframeGap * gaps;
+    }
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
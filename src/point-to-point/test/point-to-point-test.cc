@@ -24,6 +24,8 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/segment-offload-tag.h"
+#include "ns3/data-rate.h"
 
 using namespace ns3;
 
@@ -101,6 +103,118 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the transmission time of the super-segments
+ *
+ * A super-segment is received after the time taken by the back-to-back
+ * frames it stands for, each one carrying its own copy of the headers.
+ */
+class PointToPointOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointOffloadTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one packet to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param size the packet size
+   * \param segments the number of segments of the packet, 1 for an
+   *        ordinary packet
+   * \param payloadSize the payload size of all the segments
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device, uint32_t size,
+                      uint16_t segments, uint32_t payloadSize);
+  /**
+   * \brief Record the time a packet is received
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_rxTimes; //!< the reception times
+};
+
+PointToPointOffloadTest::PointToPointOffloadTest ()
+  : TestCase ("PointToPoint super-segment transmission time")
+{
+}
+
+void
+PointToPointOffloadTest::SendOnePacket (Ptr<PointToPointNetDevice> device, uint32_t size,
+                                        uint16_t segments, uint32_t payloadSize)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  if (segments > 1)
+    {
+      p->AddPacketTag (SegmentOffloadTag (segments, payloadSize));
+    }
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointOffloadTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                  const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointOffloadTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  // one byte per microsecond
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointOffloadTest::Receive, this));
+
+  Ptr<NetDeviceQueueInterface> ifaceA = CreateObject<NetDeviceQueueInterface> ();
+  devA->AggregateObject (ifaceA);
+  ifaceA->CreateTxQueues ();
+  Ptr<NetDeviceQueueInterface> ifaceB = CreateObject<NetDeviceQueueInterface> ();
+  devB->AggregateObject (ifaceB);
+  ifaceB->CreateTxQueues ();
+
+  // 4 segments of 250 bytes of payload, behind 40 bytes of headers: with
+  // the PPP header, the frames hold 4 * 292 bytes
+  Simulator::Schedule (Seconds (1.0), &PointToPointOffloadTest::SendOnePacket, this, devA, 1040, 4, 1000);
+  Simulator::Schedule (Seconds (2.0), &PointToPointOffloadTest::SendOnePacket, this, devA, 1040, 1, 0);
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 2, "Packets not received");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_rxTimes[0], Seconds (1.0) + MicroSeconds (4 * 292), NanoSeconds (1), "Wrong super-segment transmission time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_rxTimes[1], Seconds (2.0) + MicroSeconds (1042), NanoSeconds (1), "Wrong packet transmission time");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +231,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointOffloadTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
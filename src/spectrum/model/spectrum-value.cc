@@ -106,17 +106,14 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v1 = m_values.data ();
+  const double *v2 = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v1[i] += v2[i];
     }
 }
 
@@ -138,17 +135,14 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v1 = m_values.data ();
+  const double *v2 = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v1[i] -= v2[i];
     }
 }
 
@@ -164,17 +158,14 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v1 = m_values.data ();
+  const double *v2 = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v1[i] *= v2[i];
     }
 }
 
@@ -197,17 +188,14 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v1 = m_values.data ();
+  const double *v2 = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v1[i] /= v2[i];
     }
 }
 
@@ -408,11 +396,7 @@ Integral (const SpectrumValue& arg)
 Ptr<SpectrumValue>
 SpectrumValue::Copy () const
 {
-  Ptr<SpectrumValue> p = Create<SpectrumValue> (m_spectrumModel);
-  *p = *this;
-  return p;
-
-  //  return Copy<SpectrumValue> (*this)
+  return Ptr<SpectrumValue> (new SpectrumValue (*this), false);
 }
 
 
@@ -438,169 +422,150 @@ operator << (std::ostream& os, const SpectrumValue& pvf)
 
 
 SpectrumValue
-operator+ (const SpectrumValue& lhs, const SpectrumValue& rhs)
+operator+ (SpectrumValue lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = lhs;
-  res.Add (rhs);
-  return res;
+  lhs.Add (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator+ (const SpectrumValue& lhs, double rhs)
+operator+ (SpectrumValue lhs, double rhs)
 {
-  SpectrumValue res = lhs;
-  res.Add (rhs);
-  return res;
+  lhs.Add (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator+ (double lhs, const SpectrumValue& rhs)
+operator+ (double lhs, SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.Add (lhs);
-  return res;
+  rhs.Add (lhs);
+  return rhs;
 }
 
 
 SpectrumValue
-operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
+operator- (SpectrumValue lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
-  return res;
+  lhs.Subtract (rhs);
+  return lhs;
 }
 
 
-
 SpectrumValue
-operator- (const SpectrumValue& lhs, double rhs)
+operator- (SpectrumValue lhs, double rhs)
 {
-  SpectrumValue res = lhs;
-  res.Subtract (rhs);
-  return res;
+  lhs.Subtract (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator- (double lhs, const SpectrumValue& rhs)
+operator- (double lhs, SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.Subtract (lhs);
-  return res;
+  rhs.Subtract (lhs);
+  return rhs;
 }
 
+
 SpectrumValue
-operator* (const SpectrumValue& lhs, const SpectrumValue& rhs)
+operator* (SpectrumValue lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = lhs;
-  res.Multiply (rhs);
-  return res;
+  lhs.Multiply (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator* (const SpectrumValue& lhs, double rhs)
+operator* (SpectrumValue lhs, double rhs)
 {
-  SpectrumValue res = lhs;
-  res.Multiply (rhs);
-  return res;
+  lhs.Multiply (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator* (double lhs, const SpectrumValue& rhs)
+operator* (double lhs, SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.Multiply (lhs);
-  return res;
+  rhs.Multiply (lhs);
+  return rhs;
 }
 
 
 SpectrumValue
-operator/ (const SpectrumValue& lhs, const SpectrumValue& rhs)
+operator/ (SpectrumValue lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = lhs;
-  res.Divide (rhs);
-  return res;
+  lhs.Divide (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator/ (const SpectrumValue& lhs, double rhs)
+operator/ (SpectrumValue lhs, double rhs)
 {
-  SpectrumValue res = lhs;
-  res.Divide (rhs);
-  return res;
+  lhs.Divide (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-operator/ (double lhs, const SpectrumValue& rhs)
+operator/ (double lhs, SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.Divide (lhs);
-  return res;
+  rhs.Divide (lhs);
+  return rhs;
 }
 
 
 SpectrumValue
-operator+ (const SpectrumValue& rhs)
+operator+ (SpectrumValue rhs)
 {
   return rhs;
 }
 
 SpectrumValue
-operator- (const SpectrumValue& rhs)
+operator- (SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  return res;
+  rhs.ChangeSign ();
+  return rhs;
 }
 
 
 SpectrumValue
-Pow (double lhs, const SpectrumValue& rhs)
+Pow (double lhs, SpectrumValue rhs)
 {
-  SpectrumValue res = rhs;
-  res.Exp (lhs);
-  return res;
+  rhs.Exp (lhs);
+  return rhs;
 }
 
 
 SpectrumValue
-Pow (const SpectrumValue& lhs, double rhs)
+Pow (SpectrumValue lhs, double rhs)
 {
-  SpectrumValue res = lhs;
-  res.Pow (rhs);
-  return res;
+  lhs.Pow (rhs);
+  return lhs;
 }
 
 
 SpectrumValue
-Log10 (const SpectrumValue& arg)
+Log10 (SpectrumValue arg)
 {
-  SpectrumValue res = arg;
-  res.Log10 ();
-  return res;
+  arg.Log10 ();
+  return arg;
 }
 
 SpectrumValue
-Log2 (const SpectrumValue& arg)
+Log2 (SpectrumValue arg)
 {
-  SpectrumValue res = arg;
-  res.Log2 ();
-  return res;
+  arg.Log2 ();
+  return arg;
 }
 
 SpectrumValue
-Log (const SpectrumValue& arg)
+Log (SpectrumValue arg)
 {
-  SpectrumValue res = arg;
-  res.Log ();
-  return res;
+  arg.Log ();
+  return arg;
 }
 
 SpectrumValue&
@@ -54,6 +54,11 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * The operators take by value the operand whose copy they return, so
+ * that a temporary operand lends its values to the result: a chain of
+ * operations such as a - b + c allocates the values once. The compound
+ * assignment operators do not allocate.
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
@@ -167,7 +172,7 @@ public:
    *
    * @return the value of lhs + rhs
    */
-  friend SpectrumValue operator+ (const SpectrumValue& lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator+ (SpectrumValue lhs, const SpectrumValue& rhs);
 
 
   /**
@@ -178,7 +183,7 @@ public:
    *
    * @return the value of lhs + rhs
    */
-  friend SpectrumValue operator+ (const SpectrumValue& lhs, double rhs);
+  friend SpectrumValue operator+ (SpectrumValue lhs, double rhs);
 
   /**
    *  addition operator
@@ -188,7 +193,7 @@ public:
    *
    * @return the value of lhs + rhs
    */
-  friend SpectrumValue operator+ (double lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator+ (double lhs, SpectrumValue rhs);
 
 
   /**
@@ -199,7 +204,7 @@ public:
    *
    * @return the value of lhs - rhs
    */
-  friend SpectrumValue operator- (const SpectrumValue& lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator- (SpectrumValue lhs, const SpectrumValue& rhs);
 
   /**
    *  subtraction operator
@@ -209,7 +214,7 @@ public:
    *
    * @return the value of lhs - rhs
    */
-  friend SpectrumValue operator- (const SpectrumValue& lhs, double rhs);
+  friend SpectrumValue operator- (SpectrumValue lhs, double rhs);
 
   /**
    *  subtraction operator
@@ -219,7 +224,7 @@ public:
    *
    * @return the value of lhs - rhs
    */
-  friend SpectrumValue operator- (double lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator- (double lhs, SpectrumValue rhs);
 
   /**
    *  multiplication component-by-component (Schur product)
@@ -229,7 +234,7 @@ public:
    *
    * @return the value of lhs * rhs
    */
-  friend SpectrumValue operator* (const SpectrumValue& lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator* (SpectrumValue lhs, const SpectrumValue& rhs);
 
   /**
    *  multiplication by a scalar
@@ -239,7 +244,7 @@ public:
    *
    * @return the value of lhs * rhs
    */
-  friend SpectrumValue operator* (const SpectrumValue& lhs, double rhs);
+  friend SpectrumValue operator* (SpectrumValue lhs, double rhs);
 
   /**
    *  multiplication of a scalar
@@ -249,7 +254,7 @@ public:
    *
    * @return the value of lhs * rhs
    */
-  friend SpectrumValue operator* (double lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator* (double lhs, SpectrumValue rhs);
 
   /**
    *  division component-by-component
@@ -259,7 +264,7 @@ public:
    *
    * @return the value of lhs / rhs
    */
-  friend SpectrumValue operator/ (const SpectrumValue& lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator/ (SpectrumValue lhs, const SpectrumValue& rhs);
 
   /**
    * division by a scalar
@@ -269,7 +274,7 @@ public:
    *
    * @return the value of *this / rhs
    */
-  friend SpectrumValue operator/ (const SpectrumValue& lhs, double rhs);
+  friend SpectrumValue operator/ (SpectrumValue lhs, double rhs);
 
   /**
    * division of a scalar
@@ -279,7 +284,7 @@ public:
    *
    * @return the value of *this / rhs
    */
-  friend SpectrumValue operator/ (double lhs, const SpectrumValue& rhs);
+  friend SpectrumValue operator/ (double lhs, SpectrumValue rhs);
 
   /**
    * unary plus operator
@@ -287,7 +292,7 @@ public:
    * @param rhs Right Hand Side of the operator
    * @return the value of *this
    */
-  friend SpectrumValue operator+ (const SpectrumValue& rhs);
+  friend SpectrumValue operator+ (SpectrumValue rhs);
 
   /**
    * unary minus operator
@@ -295,7 +300,7 @@ public:
    * @param rhs Right Hand Side of the operator
    * @return the value of - *this
    */
-  friend SpectrumValue operator- (const SpectrumValue& rhs);
+  friend SpectrumValue operator- (SpectrumValue rhs);
 
 
   /**
@@ -448,7 +453,7 @@ public:
    *
    * @return each value in base raised to the exponent
    */
-  friend SpectrumValue Pow (const SpectrumValue& lhs, double rhs);
+  friend SpectrumValue Pow (SpectrumValue lhs, double rhs);
 
 
   /**
@@ -458,7 +463,7 @@ public:
    *
    * @return the value in base raised to each value in the exponent
    */
-  friend SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
+  friend SpectrumValue Pow (double lhs, SpectrumValue rhs);
 
   /**
    *
@@ -467,7 +472,7 @@ public:
    *
    * @return the logarithm in base 10 of all values in the argument
    */
-  friend SpectrumValue Log10 (const SpectrumValue&  arg);
+  friend SpectrumValue Log10 (SpectrumValue arg);
 
 
   /**
@@ -477,7 +482,7 @@ public:
    *
    * @return the logarithm in base 2 of all values in the argument
    */
-  friend SpectrumValue Log2 (const SpectrumValue&  arg);
+  friend SpectrumValue Log2 (SpectrumValue arg);
 
   /**
    *
@@ -486,7 +491,7 @@ public:
    *
    * @return the logarithm in base e of all values in the argument
    */
-  friend SpectrumValue Log (const SpectrumValue&  arg);
+  friend SpectrumValue Log (SpectrumValue arg);
 
   /**
    *
@@ -613,11 +618,11 @@ std::ostream& operator << (std::ostream& os, const SpectrumValue& pvf);
 double Norm (const SpectrumValue& x);
 double Sum (const SpectrumValue& x);
 double Prod (const SpectrumValue& x);
-SpectrumValue Pow (const SpectrumValue& lhs, double rhs);
-SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
-SpectrumValue Log10 (const SpectrumValue& arg);
-SpectrumValue Log2 (const SpectrumValue& arg);
-SpectrumValue Log (const SpectrumValue& arg);
+SpectrumValue Pow (SpectrumValue lhs, double rhs);
+SpectrumValue Pow (double lhs, SpectrumValue rhs);
+SpectrumValue Log10 (SpectrumValue arg);
+SpectrumValue Log2 (SpectrumValue arg);
+SpectrumValue Log (SpectrumValue arg);
 double Integral (const SpectrumValue& arg);
 
 
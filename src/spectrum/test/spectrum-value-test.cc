@@ -223,6 +223,17 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv9b, v9, "tv9b =  doubleValue * v1"), TestCase::QUICK);
   AddTestCase (new SpectrumValueTestCase (tv10b, v10, "tv10b = doubleValue div v1"), TestCase::QUICK);
 
+  // chains of operations reuse the values of the temporary operands
+  SpectrumValue tv3c (f), tv4c (f), tv5c (f), tv1c (f);
+  tv3c = v1 * doubleValue / doubleValue + v2;
+  tv4c = -(v2 - v1);
+  tv5c = v1 * v2 + v2 - v2;
+  tv1c = v1 - v2 + v2;
+  AddTestCase (new SpectrumValueTestCase (tv3c, v3, "tv3c = v1 * doubleValue div doubleValue + v2"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv4c, v4, "tv4c = -(v2 - v1)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv5c, v5, "tv5c = v1 * v2 + v2 - v2"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv1c, v1, "tv1c = v1 - v2 + v2"), TestCase::QUICK);
+
 
 
 
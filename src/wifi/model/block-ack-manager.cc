@@ -35,7 +35,8 @@ NS_LOG_COMPONENT_DEFINE ("BlockAckManager");
 BlockAckManager::Item::Item (Ptr<const Packet> packet, const WifiMacHeader &hdr, Time tStamp)
   : packet (packet),
     hdr (hdr),
-    timestamp (tStamp)
+    timestamp (tStamp),
+    retryStamp (0)
 {
   NS_LOG_FUNCTION (this << packet << hdr << tStamp);
 }
@@ -68,6 +69,8 @@ BlockAckManager::GetTypeId (void)
 }
 
 BlockAckManager::BlockAckManager ()
+  : m_nRetryPackets (0),
+    m_retryStamp (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -78,6 +81,7 @@ BlockAckManager::~BlockAckManager ()
   m_queue = 0;
   m_agreements.clear ();
   m_retryPackets.clear ();
+  m_nRetryPackets = 0;
 }
 
 bool
@@ -139,6 +143,7 @@ BlockAckManager::CreateAgreement (const MgtAddBaRequestHeader *reqHdr, Mac48Addr
   PacketQueue queue;
   std::pair<OriginatorBlockAckAgreement, PacketQueue> value (agreement, queue);
   m_agreements.insert (std::make_pair (key, value));
+  m_retryPackets.insert (std::make_pair (key, RetryQueue ()));
   m_blockPackets (recipient, reqHdr->GetTid ());
 }
 
@@ -149,30 +154,16 @@ BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
   AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
   if (it != m_agreements.end ())
     {
-      for (std::list<PacketQueueI>::const_iterator i = m_retryPackets.begin (); i != m_retryPackets.end (); )
-        {
-          if ((*i)->hdr.GetAddr1 () == recipient && (*i)->hdr.GetQosTid () == tid)
-            {
-              i = m_retryPackets.erase (i);
-            }
-          else
-            {
-              i++;
-            }
-        }
-      m_agreements.erase (it);
+      RetryQueuesI retry = m_retryPackets.find (it->first);
+      NS_ASSERT (retry != m_retryPackets.end ());
+      m_nRetryPackets -= retry->second.packets.size ();
       //remove scheduled bar
-      for (std::list<Bar>::const_iterator i = m_bars.begin (); i != m_bars.end (); )
+      for (std::list<std::list<Bar>::iterator>::const_iterator i = retry->second.bars.begin (); i != retry->second.bars.end (); i++)
         {
-          if (i->recipient == recipient && i->tid == tid)
-            {
-              i = m_bars.erase (i);
-            }
-          else
-            {
-              i++;
-            }
+          m_bars.erase (*i);
         }
+      m_retryPackets.erase (retry);
+      m_agreements.erase (it);
     }
 }
 
@@ -257,80 +248,73 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
   uint8_t tid;
   Mac48Address recipient;
   CleanupBuffers ();
-  if (!m_retryPackets.empty ())
+  if (m_nRetryPackets == 0)
     {
-      NS_LOG_DEBUG ("Retry buffer size is " << m_retryPackets.size ());
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-      while (it != m_retryPackets.end ())
+      return packet;
+    }
+  NS_LOG_DEBUG ("Retry buffer size is " << m_nRetryPackets);
+  for (RetryQueuesI retry = GetNextRetryQueue (); retry != m_retryPackets.end (); retry = GetNextRetryQueue ())
+    {
+      std::list<PacketQueueI>::iterator it = retry->second.packets.begin ();
+      if ((*it)->hdr.IsQosData ())
         {
-          if ((*it)->hdr.IsQosData ())
-            {
-              tid = (*it)->hdr.GetQosTid ();
-            }
-          else
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
-          recipient = (*it)->hdr.GetAddr1 ();
-          AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
-          NS_ASSERT (agreement != m_agreements.end ());
-          if (removePacket)
-            {
-              if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
-                {
-                  //Standard says the originator should not send a packet with seqnum < winstart
-                  NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-                  agreement->second.second.erase ((*it));
-                  it = m_retryPackets.erase (it);
-                  continue;
-                }
-              else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
-                {
-                  agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
-                }
-            }
-          packet = (*it)->packet->Copy ();
-          hdr = (*it)->hdr;
-          hdr.SetRetry ();
-          if (hdr.IsQosData ())
-            {
-              tid = hdr.GetQosTid ();
-            }
-          else
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
-          recipient = hdr.GetAddr1 ();
-          if (!agreement->second.first.IsHtSupported ()
-              && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
-                  || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
+          tid = (*it)->hdr.GetQosTid ();
+        }
+      else
+        {
+          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
+        }
+      recipient = (*it)->hdr.GetAddr1 ();
+      AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
+      NS_ASSERT (agreement != m_agreements.end ());
+      if (removePacket)
+        {
+          if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
             {
-              hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
+              //Standard says the originator should not send a packet with seqnum < winstart
+              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
+              PacketQueueI item = *it;
+              EraseFromRetryQueue (retry->second, it);
+              agreement->second.second.erase (item);
+              continue;
             }
-          else
+          else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
             {
-              /* From section 9.10.3 in IEEE802.11e standard:
-               * In order to improve efficiency, originators using the Block Ack facility
-               * may send MPDU frames with the Ack Policy subfield in QoS control frames
-               * set to Normal Ack if only a few MPDUs are available for transmission.[...]
-               * When there are sufficient number of MPDUs, the originator may switch back to
-               * the use of Block Ack.
-               */
-              hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
-              if (removePacket)
-                {
-                  AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-                  i->second.second.erase (*it);
-                }
+              agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
             }
-          if (removePacket)
+        }
+      packet = (*it)->packet->Copy ();
+      hdr = (*it)->hdr;
+      hdr.SetRetry ();
+      if (!agreement->second.first.IsHtSupported ()
+          && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
+              || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
+        {
+          hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
+        }
+      else
+        {
+          /* From section 9.10.3 in IEEE802.11e standard:
+           * In order to improve efficiency, originators using the Block Ack facility
+           * may send MPDU frames with the Ack Policy subfield in QoS control frames
+           * set to Normal Ack if only a few MPDUs are available for transmission.[...]
+           * When there are sufficient number of MPDUs, the originator may switch back to
+           * the use of Block Ack.
+           */
+          hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
+        }
+      if (removePacket)
+        {
+          NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
+          PacketQueueI item = *it;
+          EraseFromRetryQueue (retry->second, it);
+          NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << m_nRetryPackets);
+          if (hdr.IsQosAck ())
             {
-              NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
-              it = m_retryPackets.erase (it);
-              NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << m_retryPackets.size ());
+              agreement->second.second.erase (item);
             }
-          break;
         }
+      return packet;
     }
   return packet;
 }
@@ -344,53 +328,53 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
   Mac48Address recipient = hdr.GetAddr1 ();
   AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
   NS_ASSERT (agreement != m_agreements.end ());
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  for (; it != m_retryPackets.end (); it++)
+  RetryQueuesI retryIt = m_retryPackets.find (agreement->first);
+  NS_ASSERT (retryIt != m_retryPackets.end ());
+  RetryQueue &retry = retryIt->second;
+  std::list<PacketQueueI>::iterator it = retry.packets.begin ();
+  while (it != retry.packets.end ())
     {
       if (!(*it)->hdr.IsQosData ())
         {
           NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
         }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
+      if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
         {
-          if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
-            {
-              //standard says the originator should not send a packet with seqnum < winstart
-              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-              agreement->second.second.erase ((*it));
-              it = m_retryPackets.erase (it);
-              it--;
-              continue;
-            }
-          else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
-            {
-              agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
-            }
-          packet = (*it)->packet->Copy ();
-          hdr = (*it)->hdr;
-          hdr.SetRetry ();
-          *tstamp = (*it)->timestamp;
-          NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
-          if (!agreement->second.first.IsHtSupported ()
-              && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
-                  || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
-            {
-              hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
-            }
-          else
-            {
-              /* From section 9.10.3 in IEEE802.11e standard:
-               * In order to improve efficiency, originators using the Block Ack facility
-               * may send MPDU frames with the Ack Policy subfield in QoS control frames
-               * set to Normal Ack if only a few MPDUs are available for transmission.[...]
-               * When there are sufficient number of MPDUs, the originator may switch back to
-               * the use of Block Ack.
-               */
-              hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
-            }
-          NS_LOG_DEBUG ("Peeked one packet from retry buffer size = " << m_retryPackets.size () );
-          return packet;
+          //standard says the originator should not send a packet with seqnum < winstart
+          NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
+          PacketQueueI item = *it;
+          it = EraseFromRetryQueue (retry, it);
+          agreement->second.second.erase (item);
+          continue;
+        }
+      else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
+        {
+          agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
+        }
+      packet = (*it)->packet->Copy ();
+      hdr = (*it)->hdr;
+      hdr.SetRetry ();
+      *tstamp = (*it)->timestamp;
+      NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
+      if (!agreement->second.first.IsHtSupported ()
+          && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
+              || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
+        {
+          hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
         }
+      else
+        {
+          /* From section 9.10.3 in IEEE802.11e standard:
+           * In order to improve efficiency, originators using the Block Ack facility
+           * may send MPDU frames with the Ack Policy subfield in QoS control frames
+           * set to Normal Ack if only a few MPDUs are available for transmission.[...]
+           * When there are sufficient number of MPDUs, the originator may switch back to
+           * the use of Block Ack.
+           */
+          hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
+        }
+      NS_LOG_DEBUG ("Peeked one packet from retry buffer size = " << m_nRetryPackets);
+      return packet;
     }
   return packet;
 }
@@ -398,21 +382,21 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
 bool
 BlockAckManager::RemovePacket (uint8_t tid, Mac48Address recipient, uint16_t seqnumber)
 {
-
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  for (; it != m_retryPackets.end (); it++)
+  RetryQueuesI retry = m_retryPackets.find (std::make_pair (recipient, tid));
+  if (retry == m_retryPackets.end () || !retry->second.seqs.test (seqnumber))
     {
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && (*it)->hdr.GetSequenceNumber () == seqnumber)
+      return false;
+    }
+  std::list<PacketQueueI>::iterator it = retry->second.packets.begin ();
+  for (; it != retry->second.packets.end (); it++)
+    {
+      if ((*it)->hdr.GetSequenceNumber () == seqnumber)
         {
-          WifiMacHeader hdr = (*it)->hdr;
           AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-          i->second.second.erase ((*it));
-          m_retryPackets.erase (it);
-          NS_LOG_DEBUG ("Removed Packet from retry queue = " << hdr.GetSequenceNumber () << " " << +tid << " " << recipient << " Buffer Size = " << m_retryPackets.size ());
+          PacketQueueI item = *it;
+          EraseFromRetryQueue (retry->second, it);
+          i->second.second.erase (item);
+          NS_LOG_DEBUG ("Removed Packet from retry queue = " << seqnumber << " " << +tid << " " << recipient << " Buffer Size = " << m_nRetryPackets);
           return true;
         }
     }
@@ -426,6 +410,10 @@ BlockAckManager::HasBar (Bar &bar)
   if (m_bars.size () > 0)
     {
       bar = m_bars.front ();
+      // the first BAR is also the first of its agreement
+      RetryQueuesI retry = m_retryPackets.find (std::make_pair (bar.recipient, bar.tid));
+      NS_ASSERT (retry != m_retryPackets.end () && retry->second.bars.front () == m_bars.begin ());
+      retry->second.bars.pop_front ();
       m_bars.pop_front ();
       return true;
     }
@@ -436,7 +424,7 @@ bool
 BlockAckManager::HasPackets (void) const
 {
   NS_LOG_FUNCTION (this);
-  return (m_retryPackets.size () > 0 || m_bars.size () > 0);
+  return (m_nRetryPackets > 0 || m_bars.size () > 0);
 }
 
 uint32_t
@@ -468,35 +456,13 @@ uint32_t
 BlockAckManager::GetNRetryNeededPackets (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  uint32_t nPackets = 0;
-  uint16_t currentSeq = 0;
-  if (ExistsAgreement (recipient, tid))
+  /* a fragmented packet is in the queue once, by its first lost fragment */
+  RetryQueuesCI it = m_retryPackets.find (std::make_pair (recipient, tid));
+  if (it != m_retryPackets.end ())
     {
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-      while (it != m_retryPackets.end ())
-        {
-          if (!(*it)->hdr.IsQosData ())
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
-          if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
-            {
-              currentSeq = (*it)->hdr.GetSequenceNumber ();
-              nPackets++;
-              /* a fragmented packet must be counted as one packet */
-              while (it != m_retryPackets.end () && (*it)->hdr.GetSequenceNumber () == currentSeq)
-                {
-                  it++;
-                }
-            }
-          //go to next packet
-          else
-            {
-              it++;
-            }
-        }
+      return it->second.packets.size ();
     }
-  return nPackets;
+  return 0;
 }
 
 void
@@ -516,21 +482,9 @@ BlockAckManager::SetWifiRemoteStationManager (const Ptr<WifiRemoteStationManager
 bool
 BlockAckManager::AlreadyExists (uint16_t currentSeq, Mac48Address recipient, uint8_t tid) const
 {
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
-    {
-      NS_LOG_FUNCTION (this << (*it)->hdr.GetType ());
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && currentSeq == (*it)->hdr.GetSequenceNumber ())
-        {
-          return true;
-        }
-      it++;
-    }
-  return false;
+  NS_LOG_FUNCTION (this << currentSeq << recipient << +tid);
+  RetryQueuesCI it = m_retryPackets.find (std::make_pair (recipient, tid));
+  return (it != m_retryPackets.end () && it->second.seqs.test (currentSeq));
 }
 
 void
@@ -548,6 +502,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
           uint8_t nFailedMpdus = 0;
           AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
           PacketQueueI queueEnd = it->second.second.end ();
+          RetryQueue &retry = m_retryPackets.find (it->first)->second;
 
           if (it->second.first.m_inactivityEvent.IsRunning ())
             {
@@ -569,7 +524,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                                                     (*queueIt).hdr.GetFragmentNumber ()))
                     {
                       nSuccessfulMpdus++;
-                      RemoveFromRetryQueue (recipient, tid, (*queueIt).hdr.GetSequenceNumber ());
+                      RemoveFromRetryQueue (retry, (*queueIt).hdr.GetSequenceNumber ());
                       queueIt = it->second.second.erase (queueIt);
                     }
                   else
@@ -581,9 +536,9 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                           (*it).second.first.SetStartingSequence (sequenceFirstLost);
                         }
                       nFailedMpdus++;
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      if (!retry.seqs.test ((*queueIt).hdr.GetSequenceNumber ()))
                         {
-                          InsertInRetryQueue (queueIt);
+                          InsertInRetryQueue (retry, queueIt);
                         }
                       queueIt++;
                     }
@@ -604,7 +559,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                             {
                               m_txOkCallback ((*queueIt).hdr);
                             }
-                          RemoveFromRetryQueue (recipient, tid, currentSeq);
+                          RemoveFromRetryQueue (retry, currentSeq);
                           queueIt = it->second.second.erase (queueIt);
                         }
                     }
@@ -621,9 +576,9 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                         {
                           m_txFailedCallback ((*queueIt).hdr);
                         }
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      if (!retry.seqs.test ((*queueIt).hdr.GetSequenceNumber ()))
                         {
-                          InsertInRetryQueue (queueIt);
+                          InsertInRetryQueue (retry, queueIt);
                         }
                       queueIt++;
                     }
@@ -746,6 +701,7 @@ BlockAckManager::NotifyMpduTransmission (Mac48Address recipient, uint8_t tid, ui
         {
           Bar request (bar, recipient, tid, it->second.first.IsImmediateBlockAck ());
           m_bars.push_back (request);
+          m_retryPackets.find (it->first)->second.bars.push_back (--m_bars.end ());
         }
     }
 }
@@ -792,36 +748,44 @@ bool BlockAckManager::NeedBarRetransmission (uint8_t tid, uint16_t seqNumber, Ma
 }
 
 void
-BlockAckManager::RemoveFromRetryQueue (Mac48Address address, uint8_t tid, uint16_t seq)
+BlockAckManager::RemoveFromRetryQueue (RetryQueue &queue, uint16_t seq)
 {
   /* remove retry packet iterator if it's present in retry queue */
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
+  if (!queue.seqs.test (seq))
     {
-      if ((*it)->hdr.GetAddr1 () == address
-          && (*it)->hdr.GetQosTid () == tid
-          && (*it)->hdr.GetSequenceNumber () == seq)
-        {
-          it = m_retryPackets.erase (it);
-        }
-      else
+      return;
+    }
+  for (std::list<PacketQueueI>::iterator it = queue.packets.begin (); it != queue.packets.end (); it++)
+    {
+      if ((*it)->hdr.GetSequenceNumber () == seq)
         {
-          it++;
+          EraseFromRetryQueue (queue, it);
+          return;
         }
     }
 }
 
+std::list<BlockAckManager::PacketQueueI>::iterator
+BlockAckManager::EraseFromRetryQueue (RetryQueue &queue, std::list<PacketQueueI>::iterator it)
+{
+  queue.seqs.reset ((*it)->hdr.GetSequenceNumber ());
+  m_nRetryPackets--;
+  return queue.packets.erase (it);
+}
+
 void
 BlockAckManager::CleanupBuffers (void)
 {
   NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
   for (AgreementsI j = m_agreements.begin (); j != m_agreements.end (); j++)
     {
       if (j->second.second.empty ())
         {
           continue;
         }
-      Time now = Simulator::Now ();
+      RetryQueuesI retry = m_retryPackets.find (j->first);
+      NS_ASSERT (retry != m_retryPackets.end ());
       PacketQueueI end = j->second.second.begin ();
       for (PacketQueueI i = j->second.second.begin (); i != j->second.second.end (); i++)
         {
@@ -832,9 +796,7 @@ BlockAckManager::CleanupBuffers (void)
             }
           else
             {
-              RemoveFromRetryQueue (j->second.first.GetPeer (),
-                                    j->second.first.GetTid (),
-                                    i->hdr.GetSequenceNumber ());
+              RemoveFromRetryQueue (retry->second, i->hdr.GetSequenceNumber ());
             }
         }
       j->second.second.erase (j->second.second.begin (), end);
@@ -881,18 +843,10 @@ uint16_t
 BlockAckManager::GetSeqNumOfNextRetryPacket (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
+  RetryQueuesCI it = m_retryPackets.find (std::make_pair (recipient, tid));
+  if (it != m_retryPackets.end () && !it->second.packets.empty ())
     {
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
-        {
-          return (*it)->hdr.GetSequenceNumber ();
-        }
-      it++;
+      return it->second.packets.front ()->hdr.GetSequenceNumber ();
     }
   return 4096;
 }
@@ -910,32 +864,42 @@ BlockAckManager::SetTxFailedCallback (TxFailed callback)
 }
 
 void
-BlockAckManager::InsertInRetryQueue (PacketQueueI item)
+BlockAckManager::InsertInRetryQueue (RetryQueue &queue, PacketQueueI item)
 {
   NS_LOG_INFO ("Adding to retry queue " << (*item).hdr.GetSequenceNumber ());
-  if (m_retryPackets.size () == 0)
+  NS_ASSERT (!queue.seqs.test (item->hdr.GetSequenceNumber ()));
+  /* the lost packets are usually reported in order: look for the position from the end */
+  std::list<PacketQueueI>::iterator it = queue.packets.end ();
+  while (it != queue.packets.begin ())
     {
-      m_retryPackets.push_back (item);
+      std::list<PacketQueueI>::iterator prev = it;
+      prev--;
+      if (((item->hdr.GetSequenceNumber () - (*prev)->hdr.GetSequenceNumber () + 4096) % 4096) <= 2047)
+        {
+          break;
+        }
+      it = prev;
     }
-  else
+  queue.packets.insert (it, item);
+  queue.seqs.set (item->hdr.GetSequenceNumber ());
+  item->retryStamp = m_retryStamp++;
+  m_nRetryPackets++;
+}
+
+BlockAckManager::RetryQueuesI
+BlockAckManager::GetNextRetryQueue (void)
+{
+  RetryQueuesI next = m_retryPackets.end ();
+  for (RetryQueuesI retry = m_retryPackets.begin (); retry != m_retryPackets.end (); retry++)
     {
-      for (std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin (); it != m_retryPackets.end (); )
+      if (!retry->second.packets.empty ()
+          && (next == m_retryPackets.end ()
+              || retry->second.packets.front ()->retryStamp < next->second.packets.front ()->retryStamp))
         {
-          if (((item->hdr.GetSequenceNumber () - (*it)->hdr.GetSequenceNumber () + 4096) % 4096) > 2047)
-            {
-              it = m_retryPackets.insert (it, item);
-              break;
-            }
-          else
-            {
-              it++;
-              if (it == m_retryPackets.end ())
-                {
-                  m_retryPackets.push_back (item);
-                }
-            }
+          next = retry;
         }
     }
+  return next;
 }
 
 } //namespace ns3
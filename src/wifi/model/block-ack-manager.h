@@ -22,6 +22,8 @@
 #define BLOCK_ACK_MANAGER_H
 
 #include <map>
+#include <list>
+#include <bitset>
 #include "ns3/nstime.h"
 #include "wifi-mac-header.h"
 #include "originator-block-ack-agreement.h"
@@ -457,24 +459,69 @@ private:
     Ptr<const Packet> packet; ///< packet
     WifiMacHeader hdr; ///< header
     Time timestamp; ///< timestamp
+    uint64_t retryStamp; ///< order of arrival in the retransmission queues
   };
   /**
+   * The stored packets of a block ack agreement that need to be retransmitted,
+   * and its pending BARs.
+   * A sequence number is at most once in the queue, so that the bitmap tells
+   * without a search whether a packet is in the queue.
+   */
+  struct RetryQueue
+  {
+    std::list<PacketQueueI> packets; ///< iterators to the packets, in the order of their sequence numbers
+    std::bitset<4096> seqs;          ///< the sequence numbers of the packets
+    std::list<std::list<Bar>::iterator> bars; ///< the BARs of the agreement in m_bars, in their order
+  };
+  /**
+   * typedef for a map between (recipient, tid) and retransmission queue.
+   */
+  typedef std::map<std::pair<Mac48Address, uint8_t>, RetryQueue> RetryQueues;
+  /**
+   * typedef for an iterator for RetryQueues.
+   */
+  typedef RetryQueues::iterator RetryQueuesI;
+  /**
+   * typedef for a const iterator for RetryQueues.
+   */
+  typedef RetryQueues::const_iterator RetryQueuesCI;
+
+  /**
+   * \param queue the retransmission queue of the agreement of the item
    * \param item
    *
    * Insert item in retransmission queue.
    * This method ensures packets are retransmitted in the correct order.
    */
-  void InsertInRetryQueue (PacketQueueI item);
+  void InsertInRetryQueue (RetryQueue &queue, PacketQueueI item);
 
   /**
-   * Remove items from retransmission queue.
+   * Remove an item from retransmission queue.
    * This method should be called when packets are acknowledged.
    *
-   * \param address recipient mac address of the packet to be removed
-   * \param tid Traffic ID of the packet to be removed
+   * \param queue the retransmission queue of the agreement of the item
    * \param seq sequence number of the packet to be removed
    */
-  void RemoveFromRetryQueue (Mac48Address address, uint8_t tid, uint16_t seq);
+  void RemoveFromRetryQueue (RetryQueue &queue, uint16_t seq);
+
+  /**
+   * Erase an item from retransmission queue.
+   *
+   * \param queue the retransmission queue of the agreement of the item
+   * \param it the item to erase
+   * \returns the item following the erased one
+   */
+  std::list<PacketQueueI>::iterator EraseFromRetryQueue (RetryQueue &queue, std::list<PacketQueueI>::iterator it);
+
+  /**
+   * Get the retransmission queue to serve next. The agreements are served in
+   * the order their first packet to retransmit was reported lost.
+   *
+   * \returns the retransmission queue whose first packet arrived first, or the
+   *          end of the retransmission queues if no packet needs to be
+   *          retransmitted
+   */
+  RetryQueuesI GetNextRetryQueue (void);
 
   /**
    * This data structure contains, for each block ack agreement (recipient, tid), a set of packets
@@ -485,11 +532,14 @@ private:
   Agreements m_agreements;
 
   /**
-   * This list contains all iterators to stored packets that need to be retransmitted.
+   * This data structure contains, for each block ack agreement, the iterators to stored
+   * packets that need to be retransmitted.
    * A packet needs retransmission if it's indicated as not correctly received in a block ack
    * frame.
    */
-  std::list<PacketQueueI> m_retryPackets;
+  RetryQueues m_retryPackets;
+  uint32_t m_nRetryPackets; ///< number of packets in the retransmission queues
+  uint64_t m_retryStamp; ///< order of arrival of the next packet to retransmit
   std::list<Bar> m_bars; ///< list of BARs
 
   uint8_t m_blockAckThreshold; ///< bock ack threshold
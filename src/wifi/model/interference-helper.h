@@ -23,7 +23,7 @@
 
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -244,9 +244,15 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a time-ordered vector of NiChanges, the changes at the
+   * same time being in insertion order
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
+  /**
+   * typedef for the NiChanges of an event, from the change at its start
+   * to the change following the one at its end
+   */
+  typedef std::pair<NiChanges::const_iterator, NiChanges::const_iterator> NiRange;
 
   /**
    * Append the given Event.
@@ -262,7 +268,7 @@ private:
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiRange *ni) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -295,7 +301,7 @@ private:
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiRange *ni) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
@@ -305,15 +311,20 @@ private:
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiRange *ni) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
   uint8_t m_numRxAntennas; /**< the number of RX antennas in the corresponding receiver */
-  /// Experimental: needed for energy duration calculation
+  /**
+   * The changes of the total signal power, each holding the power
+   * from its time to the next change. The changes before the current
+   * reception, or before the last signal if none, are pruned.
+   */
   NiChanges m_niChanges;
   double m_firstPower; ///< first power
   bool m_rxing; ///< flag whether it is in receiving state
+  Time m_rxStart; ///< start time of the current reception
 
   /**
    * Returns an iterator to the first nichange that is later than moment
@@ -323,29 +334,39 @@ private:
    */
   NiChanges::const_iterator GetNextPosition (Time moment) const;
   /**
-   * Returns an iterator to the first nichange that is later than moment
+   * Returns an iterator to the last nichange that is before than moment
    *
    * \param moment time to check from
    * \returns an iterator to the list of NiChanges
    */
-  //NiChanges::iterator GetNextPosition (Time moment);
+  NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+
   /**
-   * Returns an iterator to the last nichange that is before than moment
+   * Returns an iterator to the first nichange at moment
    *
-   * \param moment time to check from
-   * \returns an iterator to the list of NiChanges
+   * \param moment time to check
+   * \returns an iterator to the list of NiChanges, or its end if
+   *          there is no change at moment
    */
-  NiChanges::const_iterator GetPreviousPosition (Time moment) const;
+  NiChanges::const_iterator Find (Time moment) const;
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the index of the new event.
    *
    * \param moment
    * \param change
-   * \returns the iterator of the new event
+   * \returns the index of the new event
+   */
+  std::size_t AddNiChangeEvent (Time moment, NiChange change);
+
+  /**
+   * Erase the changes before the last one strictly preceding a given
+   * time, except the zero power change at time 0.
+   *
+   * \param moment the earliest time which will be looked up
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change);
+  void PruneNiChanges (Time moment);
 };
 
 } //namespace ns3
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "interpolated-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "wifi-tx-vector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("InterpolatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (InterpolatedErrorRateModel);
+
+TypeId
+InterpolatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::InterpolatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<InterpolatedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The type of the interpolated error rate model.",
+                   TypeIdValue (NistErrorRateModel::GetTypeId ()),
+                   MakeTypeIdAccessor (&InterpolatedErrorRateModel::m_modelTid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR of the grid (dB).",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR of the grid (dB).",
+                   DoubleValue (50.0),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Step",
+                   "The step of the grid (dB).",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_stepDb),
+                   MakeDoubleChecker<double> (0.001))
+  ;
+  return tid;
+}
+
+InterpolatedErrorRateModel::InterpolatedErrorRateModel ()
+  : m_lastTable (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+InterpolatedErrorRateModel::~InterpolatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+InterpolatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_lastTable = 0;
+  ErrorRateModel::DoDispose ();
+}
+
+bool
+InterpolatedErrorRateModel::TableKey::operator < (const TableKey &o) const
+{
+  if (model != o.model)
+    {
+      return model < o.model;
+    }
+  if (minSnrDb != o.minSnrDb)
+    {
+      return minSnrDb < o.minSnrDb;
+    }
+  if (stepDb != o.stepDb)
+    {
+      return stepDb < o.stepDb;
+    }
+  if (nPoints != o.nPoints)
+    {
+      return nPoints < o.nPoints;
+    }
+  if (mode != o.mode)
+    {
+      return mode < o.mode;
+    }
+  if (channelWidth != o.channelWidth)
+    {
+      return channelWidth < o.channelWidth;
+    }
+  if (guardInterval != o.guardInterval)
+    {
+      return guardInterval < o.guardInterval;
+    }
+  return nss < o.nss;
+}
+
+InterpolatedErrorRateModel::Tables &
+InterpolatedErrorRateModel::GetTables (void)
+{
+  static Tables tables;
+  return tables;
+}
+
+const InterpolatedErrorRateModel::Table &
+InterpolatedErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector) const
+{
+  TableKey key;
+  key.model = m_modelTid.GetUid ();
+  key.minSnrDb = m_minSnrDb;
+  key.stepDb = m_stepDb;
+  key.nPoints = static_cast<uint32_t> (std::floor ((m_maxSnrDb - m_minSnrDb) / m_stepDb + 0.5)) + 1;
+  key.mode = mode.GetUid ();
+  key.channelWidth = txVector.GetChannelWidth ();
+  key.guardInterval = txVector.GetGuardInterval ();
+  key.nss = txVector.GetNss ();
+  if (m_lastTable != 0 && !(key < m_lastKey) && !(m_lastKey < key))
+    {
+      return *m_lastTable;
+    }
+
+  Tables &tables = GetTables ();
+  Tables::iterator it = tables.find (key);
+  if (it == tables.end ())
+    {
+      NS_LOG_DEBUG ("Tabulating " << m_modelTid.GetName () << " for " << mode
+                    << " width=" << key.channelWidth << " gi=" << key.guardInterval
+                    << " nss=" << +key.nss);
+      Table table (key.nPoints);
+      double floor = std::log (std::numeric_limits<double>::min ());
+      for (uint32_t i = 0; i < key.nPoints; i++)
+        {
+          double snr = std::pow (10.0, (m_minSnrDb + i * m_stepDb) / 10.0);
+          double pe = 1 - m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+          table[i] = pe > 0 ? std::log (std::min (pe, 1.0)) : floor;
+        }
+      it = tables.insert (std::make_pair (key, table)).first;
+    }
+  m_lastKey = key;
+  m_lastTable = &it->second;
+  return it->second;
+}
+
+double
+InterpolatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  if (m_model == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_modelTid);
+      m_model = factory.Create<ErrorRateModel> ();
+    }
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+  double x = snr > 0 ? (10.0 * std::log10 (snr) - m_minSnrDb) / m_stepDb : -1;
+  if (!(x >= 0) || x >= (m_maxSnrDb - m_minSnrDb) / m_stepDb)
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  const Table &table = GetTable (mode, txVector);
+  uint32_t i = static_cast<uint32_t> (x);
+  if (i + 1 >= table.size ())
+    {
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  double logPe = table[i] + (x - i) * (table[i + 1] - table[i]);
+  return std::exp (nbits * std::log1p (-std::exp (logPe)));
+}
+
+} //namespace ns3
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INTERPOLATED_ERROR_RATE_MODEL_H
+#define INTERPOLATED_ERROR_RATE_MODEL_H
+
+#include <map>
+#include <vector>
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A model for the error rate which interpolates the curves of another
+ * model, tabulated on a grid of SNR values.
+ *
+ * The analytic models compute the success rate of a chunk of n bits as
+ * (1 - p)^n, where p, the error rate of a bit, depends on the mode, the
+ * SNR and, for some models, the channel width, the guard interval and the
+ * number of spatial streams. The first time a combination of these
+ * parameters is used, this model evaluates p on every point of the grid
+ * with the model given by the ErrorRateModel attribute. It then returns
+ * (1 - p)^n, with log (p) linearly interpolated in dB between the two
+ * grid points around the SNR, so that a chunk costs a logarithm and an
+ * exponential instead of the evaluation of the model. The SNR values out
+ * of the grid are passed to the model.
+ *
+ * The tables are shared by all the instances using the same model and
+ * grid: the model must thus have no attribute changing its curves.
+ */
+class InterpolatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  InterpolatedErrorRateModel ();
+  virtual ~InterpolatedErrorRateModel ();
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+private:
+  void DoDispose (void);
+
+  /// Key of a table: model, grid, mode, channel width, guard interval and number of spatial streams
+  struct TableKey
+  {
+    uint16_t model;         //!< the UID of the TypeId of the model
+    double minSnrDb;        //!< the lowest SNR of the grid (dB)
+    double stepDb;          //!< the step of the grid (dB)
+    uint32_t nPoints;       //!< the number of points of the grid
+    uint32_t mode;          //!< the UID of the mode
+    uint16_t channelWidth;  //!< the channel width (MHz)
+    uint16_t guardInterval; //!< the guard interval (ns)
+    uint8_t nss;            //!< the number of spatial streams
+
+    /**
+     * \param o the key to compare with
+     * \returns true if this key is ordered before o
+     */
+    bool operator < (const TableKey &o) const;
+  };
+  /// Logarithms of the bit error rate on the points of the grid
+  typedef std::vector<double> Table;
+  /// Container for the tables
+  typedef std::map<TableKey, Table> Tables;
+
+  /**
+   * \returns the tables of all the instances
+   */
+  static Tables &GetTables (void);
+
+  /**
+   * \param mode the Wi-Fi mode of the chunk
+   * \param txVector TXVECTOR of the overall transmission
+   * \returns the table of the mode, built if needed
+   */
+  const Table &GetTable (WifiMode mode, WifiTxVector txVector) const;
+
+  TypeId m_modelTid;                   //!< the TypeId of the interpolated model
+  double m_minSnrDb;                   //!< the lowest SNR of the grid (dB)
+  double m_maxSnrDb;                   //!< the highest SNR of the grid (dB)
+  double m_stepDb;                     //!< the step of the grid (dB)
+  mutable Ptr<ErrorRateModel> m_model; //!< the interpolated model
+  mutable const Table *m_lastTable;    //!< the last table used
+  mutable TableKey m_lastKey;          //!< the key of the last table used
+};
+
+} //namespace ns3
+
+#endif /* INTERPOLATED_ERROR_RATE_MODEL_H */
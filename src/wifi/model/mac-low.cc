@@ -547,15 +547,18 @@ MacLow::StartTransmission (Ptr<const Packet> packet,
         }
       AcIndex ac = QosUtilsMapTidToAc (GetTid (packet, *hdr));
       std::map<AcIndex, Ptr<QosTxop> >::const_iterator edcaIt = m_edca.find (ac);
-      Ptr<Packet> aggregatedPacket = Create<Packet> ();
+      uint32_t ampduSize = 0;
       for (uint32_t i = 0; i < sentMpdus; i++)
         {
-          Ptr<Packet> newPacket = (m_txPackets[GetTid (packet, *hdr)].at (i).packet)->Copy ();
-          newPacket->AddHeader (m_txPackets[GetTid (packet, *hdr)].at (i).hdr);
-          AddWifiMacTrailer (newPacket);
-          edcaIt->second->GetMpduAggregator ()->Aggregate (newPacket, aggregatedPacket);
+          const Item &item = m_txPackets[GetTid (packet, *hdr)].at (i);
+          uint32_t mpduSize = item.packet->GetSize () + item.hdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+          if (edcaIt->second->GetMpduAggregator ()->CanBeAggregated (mpduSize, ampduSize, 0))
+            {
+              ampduSize = MpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize);
+            }
         }
-      m_currentPacket = aggregatedPacket;
+      //the A-MPDU is serialized again by ForwardDown from the aggregate queue
+      m_currentPacket = Create<Packet> (ampduSize);
       m_currentHdr = (m_txPackets[GetTid (packet, *hdr)].at (0).hdr);
       m_currentTxVector = GetDataTxVector (m_currentPacket, &m_currentHdr);
     }
@@ -2527,16 +2530,10 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
 }
 
 bool
-MacLow::StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peekedHdr, Ptr<Packet> aggregatedPacket, uint8_t blockAckSize) const
+MacLow::StopMpduAggregation (uint32_t payloadSize, WifiMacHeader peekedHdr, uint32_t ampduSize, uint8_t blockAckSize) const
 {
-  if (peekedPacket == 0)
-    {
-      NS_LOG_DEBUG ("no more packets in queue");
-      return true;
-    }
-
   Time aPPDUMaxTime = MicroSeconds (5484);
-  uint8_t tid = GetTid (peekedPacket, peekedHdr);
+  uint8_t tid = GetTid (0, peekedHdr);
   AcIndex ac = QosUtilsMapTidToAc (tid);
   std::map<AcIndex, Ptr<QosTxop> >::const_iterator edcaIt = m_edca.find (ac);
 
@@ -2546,13 +2543,13 @@ MacLow::StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peeke
     }
 
   //A STA shall not transmit a PPDU that has a duration that is greater than aPPDUMaxTime
-  if (m_phy->CalculateTxDuration (aggregatedPacket->GetSize () + peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, m_currentTxVector, m_phy->GetFrequency ()) > aPPDUMaxTime)
+  if (m_phy->CalculateTxDuration (ampduSize + payloadSize + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, m_currentTxVector, m_phy->GetFrequency ()) > aPPDUMaxTime)
     {
       NS_LOG_DEBUG ("no more packets can be aggregated to satisfy PPDU <= aPPDUMaxTime");
       return true;
     }
 
-  if (!edcaIt->second->GetMpduAggregator ()->CanBeAggregated (peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, aggregatedPacket, blockAckSize))
+  if (!edcaIt->second->GetMpduAggregator ()->CanBeAggregated (payloadSize + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, ampduSize, blockAckSize))
     {
       NS_LOG_DEBUG ("no more packets can be aggregated because the maximum A-MPDU size has been reached");
       return true;
@@ -2568,7 +2565,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
   Ptr<Packet> newPacket, tempPacket;
   WifiMacHeader peekedHdr;
   newPacket = packet->Copy ();
-  Ptr<Packet> currentAggregatedPacket;
+  uint32_t ampduSize = 0;
   CtrlBAckRequestHeader blockAckReq;
 
   if (hdr.IsBlockAckReq ())
@@ -2587,7 +2584,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
       Time tstamp;
       uint8_t tid = GetTid (packet, hdr);
       Ptr<WifiMacQueue> queue;
-      Ptr<Packet> aggPacket;
+      Ptr<MpduAggregator> mpduAggregator;
       AcIndex ac = QosUtilsMapTidToAc (tid);
       std::map<AcIndex, Ptr<QosTxop> >::const_iterator edcaIt = m_edca.find (ac);
       NS_ASSERT (edcaIt != m_edca.end ());
@@ -2600,7 +2597,8 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
             {
               /* here is performed mpdu aggregation */
               /* MSDU aggregation happened in edca if the user asked for it so m_currentPacket may contains a normal packet or a A-MSDU*/
-              currentAggregatedPacket = Create<Packet> ();
+              /* the A-MPDU is only sized here: its MPDUs are serialized by ForwardDown */
+              mpduAggregator = edcaIt->second->GetMpduAggregator ();
               peekedHdr = hdr;
               uint16_t startingSequenceNumber = 0;
               uint16_t currentSequenceNumber = 0;
@@ -2608,7 +2606,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               uint8_t blockAckSize = 0;
               bool aggregated = false;
               uint8_t i = 0;
-              aggPacket = newPacket->Copy ();
+              uint32_t mpduSize;
 
               if (!hdr.IsBlockAckReq ())
                 {
@@ -2618,16 +2616,16 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       peekedHdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
                     }
                   currentSequenceNumber = peekedHdr.GetSequenceNumber ();
-                  newPacket->AddHeader (peekedHdr);
-                  AddWifiMacTrailer (newPacket);
+                  mpduSize = packet->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH;
 
-                  aggregated = edcaIt->second->GetMpduAggregator ()->Aggregate (newPacket, currentAggregatedPacket);
+                  aggregated = mpduAggregator->CanBeAggregated (mpduSize, ampduSize, 0);
 
                   if (aggregated)
                     {
-                      NS_LOG_DEBUG ("Adding packet with sequence number " << currentSequenceNumber << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      ampduSize = MpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize);
+                      NS_LOG_DEBUG ("Adding packet with sequence number " << currentSequenceNumber << " to A-MPDU, packet size = " << mpduSize << ", A-MPDU size = " << ampduSize);
                       i++;
-                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (aggPacket, peekedHdr));
+                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (packet, peekedHdr));
                     }
                 }
               else if (hdr.IsBlockAckReq ())
@@ -2657,10 +2655,10 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                   /* here is performed MSDU aggregation (two-level aggregation) */
                   if (peekedPacket != 0 && edcaIt->second->GetMsduAggregator () != 0)
                     {
-                      tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
+                      tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, ampduSize, blockAckSize);
                       if (tempPacket != 0)  //MSDU aggregation
                         {
-                          peekedPacket = tempPacket->Copy ();
+                          peekedPacket = tempPacket;
                         }
                     }
                 }
@@ -2670,7 +2668,8 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                   currentSequenceNumber = peekedHdr.GetSequenceNumber ();
                 }
 
-              while (IsInWindow (currentSequenceNumber, startingSequenceNumber, 64) && !StopMpduAggregation (peekedPacket, peekedHdr, currentAggregatedPacket, blockAckSize))
+              while (IsInWindow (currentSequenceNumber, startingSequenceNumber, 64) && peekedPacket != 0
+                     && !StopMpduAggregation (peekedPacket->GetSize (), peekedHdr, ampduSize, blockAckSize))
                 {
                   //for now always send AMPDU with normal ACK
                   if (retry == false)
@@ -2690,15 +2689,12 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                       peekedHdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
                     }
 
-                  newPacket = peekedPacket->Copy ();
-                  aggPacket = newPacket->Copy ();
-
-                  newPacket->AddHeader (peekedHdr);
-                  AddWifiMacTrailer (newPacket);
-                  aggregated = edcaIt->second->GetMpduAggregator ()->Aggregate (newPacket, currentAggregatedPacket);
+                  mpduSize = peekedPacket->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+                  aggregated = mpduAggregator->CanBeAggregated (mpduSize, ampduSize, 0);
                   if (aggregated)
                     {
-                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (aggPacket, peekedHdr));
+                      ampduSize = MpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize);
+                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (peekedPacket, peekedHdr));
                       if (i == 1 && hdr.IsQosData ())
                         {
                           if (!m_txParams.MustSendRts ())
@@ -2710,7 +2706,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                               InsertInTxQueue (packet, hdr, tstamp, tid);
                             }
                         }
-                      NS_LOG_DEBUG ("Adding packet with sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << newPacket->GetSize () << ", A-MPDU size = " << currentAggregatedPacket->GetSize ());
+                      NS_LOG_DEBUG ("Adding packet with sequence number " << peekedHdr.GetSequenceNumber () << " to A-MPDU, packet size = " << mpduSize << ", A-MPDU size = " << ampduSize);
                       i++;
                       isAmpdu = true;
                       if (!m_txParams.MustSendRts ())
@@ -2729,7 +2725,6 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                         {
                           queue->Remove (peekedPacket);
                         }
-                      newPacket = 0;
                     }
                   else
                     {
@@ -2755,10 +2750,10 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
 
                               if (edcaIt->second->GetMsduAggregator () != 0)
                                 {
-                                  tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
+                                  tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, ampduSize, blockAckSize);
                                   if (tempPacket != 0) //MSDU aggregation
                                     {
-                                      peekedPacket = tempPacket->Copy ();
+                                      peekedPacket = tempPacket;
                                     }
                                 }
                             }
@@ -2782,10 +2777,10 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
 
                           if (edcaIt->second->GetMsduAggregator () != 0 && IsInWindow (currentSequenceNumber, startingSequenceNumber, 64))
                             {
-                              tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, blockAckSize);
+                              tempPacket = PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, ampduSize, blockAckSize);
                               if (tempPacket != 0) //MSDU aggregation
                                 {
-                                  peekedPacket = tempPacket->Copy ();
+                                  peekedPacket = tempPacket;
                                 }
                             }
                         }
@@ -2798,16 +2793,15 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
 
               if (isAmpdu)
                 {
+                  //the placeholder has the size of the A-MPDU sent by ForwardDown
+                  newPacket = Create<Packet> (ampduSize);
                   if (hdr.IsBlockAckReq ())
                     {
-                      newPacket = packet->Copy ();
                       peekedHdr = hdr;
-                      aggPacket = newPacket->Copy ();
-                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (aggPacket, peekedHdr));
-                      newPacket->AddHeader (peekedHdr);
-                      AddWifiMacTrailer (newPacket);
-                      edcaIt->second->GetMpduAggregator ()->Aggregate (newPacket, currentAggregatedPacket);
-                      currentAggregatedPacket->AddHeader (blockAckReq);
+                      m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (packet, peekedHdr));
+                      mpduSize = packet->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+                      newPacket = Create<Packet> (MpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize));
+                      newPacket->AddHeader (blockAckReq);
                     }
 
                   if (qosPolicy == 0)
@@ -2818,7 +2812,6 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
                   //Add packet tag
                   AmpduTag ampdutag;
                   ampdutag.SetRemainingNbOfMpdus (i - 1);
-                  newPacket = currentAggregatedPacket;
                   newPacket->AddPacketTag (ampdutag);
 
                   NS_LOG_DEBUG ("tx unicast A-MPDU");
@@ -2845,8 +2838,6 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
               peekedHdr = hdr;
               peekedHdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
 
-              currentAggregatedPacket = Create<Packet> ();
-              edcaIt->second->GetMpduAggregator ()->AggregateSingleMpdu (packet, currentAggregatedPacket);
               m_aggregateQueue[tid]->Enqueue (Create<WifiMacQueueItem> (packet, peekedHdr));
               if (m_txParams.MustSendRts ())
                 {
@@ -2859,9 +2850,7 @@ MacLow::AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr)
 
               //Add packet tag
               AmpduTag ampdutag;
-              newPacket = currentAggregatedPacket;
-              newPacket->AddHeader (peekedHdr);
-              AddWifiMacTrailer (newPacket);
+              newPacket = Create<Packet> (MpduAggregator::GetSizeIfAggregated (packet->GetSize () + peekedHdr.GetSize () + WIFI_MAC_FCS_LENGTH, 0));
               newPacket->AddPacketTag (ampdutag);
 
               NS_LOG_DEBUG ("tx unicast S-MPDU with sequence number " << hdr.GetSequenceNumber ());
@@ -2895,18 +2884,18 @@ MacLow::InsertInTxQueue (Ptr<const Packet> packet, const WifiMacHeader &hdr, Tim
 }
 
 Ptr<Packet>
-MacLow::PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Time *tstamp, Ptr<Packet> currentAmpduPacket, uint8_t blockAckSize)
+MacLow::PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Time *tstamp, uint32_t ampduSize, uint8_t blockAckSize)
 {
-  bool msduAggregation = false;
   bool isAmsdu = false;
   Ptr<Packet> currentAmsduPacket = Create<Packet> ();
-  Ptr<Packet> tempPacket = Create<Packet> ();
+  Ptr<MsduAggregator> msduAggregator;
 
   Ptr<WifiMacQueue> queue;
   AcIndex ac = QosUtilsMapTidToAc (GetTid (packet, *hdr));
   std::map<AcIndex, Ptr<QosTxop> >::const_iterator edcaIt = m_edca.find (ac);
   NS_ASSERT (edcaIt != m_edca.end ());
   queue = edcaIt->second->GetWifiMacQueue ();
+  msduAggregator = edcaIt->second->GetMsduAggregator ();
 
   Ptr<const WifiMacQueueItem> peekedItem = queue->DequeueByTidAndAddress (hdr->GetQosTid (),
                                                                           WifiMacHeader::ADDR1,
@@ -2916,25 +2905,25 @@ MacLow::PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Ti
       *hdr = peekedItem->GetHeader ();
     }
 
-  edcaIt->second->GetMsduAggregator ()->Aggregate (packet, currentAmsduPacket,
-                                                   edcaIt->second->MapSrcAddressForAggregation (*hdr),
-                                                   edcaIt->second->MapDestAddressForAggregation (*hdr));
+  msduAggregator->Aggregate (packet, currentAmsduPacket,
+                              edcaIt->second->MapSrcAddressForAggregation (*hdr),
+                              edcaIt->second->MapDestAddressForAggregation (*hdr));
 
   peekedItem = queue->PeekByTidAndAddress (hdr->GetQosTid (), WifiMacHeader::ADDR1, hdr->GetAddr1 ());
   while (peekedItem != 0)
     {
-      *hdr = peekedItem->GetHeader ();
-      *tstamp = peekedItem->GetTimeStamp ();
-      tempPacket = currentAmsduPacket;
-
-      msduAggregation = edcaIt->second->GetMsduAggregator ()->Aggregate (peekedItem->GetPacket (), tempPacket,
-                                                                         edcaIt->second->MapSrcAddressForAggregation (*hdr),
-                                                                         edcaIt->second->MapDestAddressForAggregation (*hdr));
-
-      if (msduAggregation && !StopMpduAggregation (tempPacket, *hdr, currentAmpduPacket, blockAckSize))
-        {
+      //size the A-MSDU first, so that a rejected MSDU is never appended to it
+      uint32_t amsduSize = MsduAggregator::GetSizeIfAggregated (peekedItem->GetPacket ()->GetSize (),
+                                                                currentAmsduPacket->GetSize ());
+      if (amsduSize <= msduAggregator->GetMaxAmsduSize ()
+          && !StopMpduAggregation (amsduSize, peekedItem->GetHeader (), ampduSize, blockAckSize))
+        {
+          *hdr = peekedItem->GetHeader ();
+          *tstamp = peekedItem->GetTimeStamp ();
+          msduAggregator->Aggregate (peekedItem->GetPacket (), currentAmsduPacket,
+                                     edcaIt->second->MapSrcAddressForAggregation (*hdr),
+                                     edcaIt->second->MapDestAddressForAggregation (*hdr));
           isAmsdu = true;
-          currentAmsduPacket = tempPacket;
           queue->Remove (peekedItem->GetPacket ());
         }
       else
@@ -392,7 +392,9 @@ public:
    * \param hdr the WifiMacHeader for the packet.
    * \return the A-MPDU packet if aggregation is successfull, the input packet otherwise
    *
-   * This function adds the packets that will be added to an A-MPDU to an aggregate queue
+   * This function adds the packets that will be added to an A-MPDU to an aggregate queue.
+   * The returned A-MPDU only has the size of the A-MPDU and its AmpduTag: the MPDUs are
+   * serialized from the aggregate queue when the A-MPDU is forwarded to the PHY.
    *
    */
   Ptr<Packet> AggregateToAmpdu (Ptr<const Packet> packet, const WifiMacHeader hdr);
@@ -406,16 +408,16 @@ public:
    */
   void DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr, WifiTxVector txVector);
   /**
-   * \param peekedPacket the packet to be aggregated
+   * \param payloadSize the size of the packet to be aggregated, without MAC header and FCS
    * \param peekedHdr the WifiMacHeader for the packet.
-   * \param aggregatedPacket the current A-MPDU
+   * \param ampduSize the size of the current A-MPDU
    * \param blockAckSize the size of a piggybacked block ack request
    * \return false if the given packet can be added to an A-MPDU, true otherwise
    *
    * This function decides if a given packet can be added to an A-MPDU or not
    *
    */
-  bool StopMpduAggregation (Ptr<const Packet> peekedPacket, WifiMacHeader peekedHdr, Ptr<Packet> aggregatedPacket, uint8_t blockAckSize) const;
+  bool StopMpduAggregation (uint32_t payloadSize, WifiMacHeader peekedHdr, uint32_t ampduSize, uint8_t blockAckSize) const;
   /**
    *
    * This function is called to flush the aggregate queue, which is used for A-MPDU
@@ -852,12 +854,12 @@ private:
    * \param packet packet picked for aggregation
    * \param hdr 802.11 header for packet picked for aggregation
    * \param tstamp timestamp
-   * \param currentAmpduPacket current A-MPDU packet
+   * \param ampduSize size of the current A-MPDU
    * \param blockAckSize size of the piggybacked block ack request
    *
    * \return the aggregate if MSDU aggregation succeeded, 0 otherwise
    */
-  Ptr<Packet> PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Time *tstamp, Ptr<Packet> currentAmpduPacket, uint8_t blockAckSize);
+  Ptr<Packet> PerformMsduAggregation (Ptr<const Packet> packet, WifiMacHeader *hdr, Time *tstamp, uint32_t ampduSize, uint8_t blockAckSize);
 
   Ptr<WifiPhy> m_phy; //!< Pointer to WifiPhy (actually send/receives frames)
   Ptr<WifiRemoteStationManager> m_stationManager; //!< Pointer to WifiRemoteStationManager (rate control)
@@ -50,26 +50,6 @@ NS_LOG_COMPONENT_DEFINE ("MinstrelHtWifiManager");
 
 namespace ns3 {
 
-///MinstrelHtWifiRemoteStation structure
-struct MinstrelHtWifiRemoteStation : MinstrelWifiRemoteStation
-{
-  uint8_t m_sampleGroup;     //!< The group that the sample rate belongs to.
-
-  uint32_t m_sampleWait;      //!< How many transmission attempts to wait until a new sample.
-  uint32_t m_sampleTries;     //!< Number of sample tries after waiting sampleWait.
-  uint32_t m_sampleCount;     //!< Max number of samples per update interval.
-  uint32_t m_numSamplesSlow;  //!< Number of times a slow rate was sampled.
-
-  uint32_t m_avgAmpduLen;      //!< Average number of MPDUs in an A-MPDU.
-  uint32_t m_ampduLen;         //!< Number of MPDUs in an A-MPDU.
-  uint32_t m_ampduPacketCount; //!< Number of A-MPDUs transmitted.
-
-  McsGroupData m_groupsTable;  //!< Table of groups with stats.
-  bool m_isHt;                 //!< If the station is HT capable.
-
-  std::ofstream m_statsFile;   //!< File where statistics table is written.
-};
-
 NS_OBJECT_ENSURE_REGISTERED (MinstrelHtWifiManager);
 
 TypeId
@@ -376,6 +356,7 @@ MinstrelHtWifiManager::DoCreateStation (void) const
 
   // Initialize variables common to both stations.
   station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+  station->m_sampleTable = 0;
   station->m_col = 0;
   station->m_index = 0;
   station->m_maxTpRate = 0;
@@ -455,12 +436,15 @@ MinstrelHtWifiManager::CheckInit (MinstrelHtWifiRemoteStation *station)
           station->m_isHt = true;
           station->m_nModes = GetNMcsSupported (station);
           station->m_minstrelTable = MinstrelRate (station->m_nModes);
-          station->m_sampleTable = SampleRate (m_numRates, std::vector<uint8_t> (m_nSampleCol));
+          station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
           InitSampleTable (station);
           RateInit (station);
-          std::ostringstream tmp;
-          tmp << "minstrel-ht-stats-" << station->m_state->m_address << ".txt";
-          station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+          if (m_printStats)
+            {
+              std::ostringstream tmp;
+              tmp << "minstrel-ht-stats-" << station->m_state->m_address << ".txt";
+              station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+            }
           station->m_initialized = true;
         }
     }
@@ -1029,7 +1013,7 @@ MinstrelHtWifiManager::GetNextSample (MinstrelHtWifiRemoteStation *station)
   uint8_t sampleGroup = station->m_sampleGroup;
   uint8_t index = station->m_groupsTable[sampleGroup].m_index;
   uint8_t col = station->m_groupsTable[sampleGroup].m_col;
-  uint8_t sampleIndex = station->m_sampleTable[index][col];
+  uint8_t sampleIndex = (*station->m_sampleTable)[index][col];
   uint8_t rateIndex = GetIndex (sampleGroup, sampleIndex);
   NS_LOG_DEBUG ("Next Sample is " << +rateIndex);
   SetNextSample (station); //Calculate the next sample rate.
@@ -1064,7 +1048,7 @@ MinstrelHtWifiManager::SetNextSample (MinstrelHtWifiRemoteStation *station)
       index = station->m_groupsTable[station->m_sampleGroup].m_index;
       col = station->m_groupsTable[sampleGroup].m_col;
     }
-  NS_LOG_DEBUG ("New sample set: group= " << +sampleGroup << " index= " << +station->m_sampleTable[index][col]);
+  NS_LOG_DEBUG ("New sample set: group= " << +sampleGroup << " index= " << +(*station->m_sampleTable)[index][col]);
 }
 
 uint8_t
@@ -1177,7 +1161,18 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (this << station);
 
-  station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+  //count the intervals elapsed without report, which would each have
+  //left the statistics unchanged but for the skipped samples
+  uint32_t nIntervals = 1;
+  if (Simulator::Now () >= station->m_nextStatsUpdate && m_updateStats.IsStrictlyPositive ())
+    {
+      nIntervals += (Simulator::Now () - station->m_nextStatsUpdate).GetTimeStep () / m_updateStats.GetTimeStep ();
+      station->m_nextStatsUpdate += TimeStep (m_updateStats.GetTimeStep () * nIntervals);
+    }
+  else
+    {
+      station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+    }
 
   station->m_numSamplesSlow = 0;
   station->m_sampleCount = 0;
@@ -1222,7 +1217,7 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
                   /// If we've attempted something.
                   if (station->m_groupsTable[j].m_ratesTable[i].numRateAttempt > 0)
                     {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped = 0;
+                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped = nIntervals - 1;
                       /**
                        * Calculate the probability of success.
                        * Assume probability scales from 0 to 100.
@@ -1253,7 +1248,7 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
                     }
                   else
                     {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped++;
+                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped += nIntervals;
                     }
 
                   /// Bookeeping.
@@ -1464,7 +1459,7 @@ MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
                             "," << +m_minstrelGroups[groupId].sgi << "," << m_minstrelGroups[groupId].chWidth << ")");
 
               station->m_groupsTable[groupId].m_supported = true;                                ///Group supported.
-              station->m_groupsTable[groupId].m_col = 0;
+              station->m_groupsTable[groupId].m_col = m_uniformRandomVariable->GetInteger (0, m_nSampleCol - 1); ///The sample table is shared, start at a random column.
               station->m_groupsTable[groupId].m_index = 0;
 
               station->m_groupsTable[groupId].m_ratesTable = HtMinstrelRate (m_numRates);        ///Create the rate list for the group.
@@ -1599,9 +1594,15 @@ MinstrelHtWifiManager::InitSampleTable (MinstrelHtWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (this << station);
   station->m_col = station->m_index = 0;
+  station->m_sampleTable = &m_sampleTable;
+  if (m_sampleTable.size () == m_numRates && (m_numRates == 0 || m_sampleTable[0].size () == m_nSampleCol))
+    {
+      return;
+    }
 
   //for off-setting to make rates fall between 0 and nModes
   uint8_t numSampleRates = m_numRates;
+  m_sampleTable = HtSampleRate (m_numRates, std::vector<uint8_t> (m_nSampleCol));
 
   uint8_t newIndex;
   for (uint8_t col = 0; col < m_nSampleCol; col++)
@@ -1616,11 +1617,11 @@ MinstrelHtWifiManager::InitSampleTable (MinstrelHtWifiRemoteStation *station)
           newIndex = (i + uv) % numSampleRates;
 
           //this loop is used for filling in other uninitialized places
-          while (station->m_sampleTable[newIndex][col] != 0)
+          while (m_sampleTable[newIndex][col] != 0)
             {
               newIndex = (newIndex + 1) % m_numRates;
             }
-          station->m_sampleTable[newIndex][col] = i;
+          m_sampleTable[newIndex][col] = i;
         }
     }
 }
@@ -29,6 +29,8 @@
 #include "wifi-remote-station-manager.h"
 #include "minstrel-wifi-manager.h"
 
+class MinstrelHtWifiManagerTest;
+
 namespace ns3 {
 
 /**
@@ -61,7 +63,6 @@ struct McsGroup
  */
 typedef std::vector<McsGroup> MinstrelMcsGroups;
 
-struct MinstrelHtWifiRemoteStation;
 /**
  * A struct to contain all statistics information related to a data rate.
  */
@@ -130,6 +131,28 @@ typedef std::vector<struct GroupInfo> McsGroupData;
  */
 typedef std::vector<std::vector<uint8_t> > HtSampleRate;
 
+/**
+ * Hold per-remote-station state for the Minstrel HT Wifi manager.
+ */
+struct MinstrelHtWifiRemoteStation : MinstrelWifiRemoteStation
+{
+  uint8_t m_sampleGroup;     //!< The group that the sample rate belongs to.
+
+  uint32_t m_sampleWait;      //!< How many transmission attempts to wait until a new sample.
+  uint32_t m_sampleTries;     //!< Number of sample tries after waiting sampleWait.
+  uint32_t m_sampleCount;     //!< Max number of samples per update interval.
+  uint32_t m_numSamplesSlow;  //!< Number of times a slow rate was sampled.
+
+  uint32_t m_avgAmpduLen;      //!< Average number of MPDUs in an A-MPDU.
+  uint32_t m_ampduLen;         //!< Number of MPDUs in an A-MPDU.
+  uint32_t m_ampduPacketCount; //!< Number of A-MPDUs transmitted.
+
+  McsGroupData m_groupsTable;  //!< Table of groups with stats.
+  bool m_isHt;                 //!< If the station is HT capable.
+
+  std::ofstream m_statsFile;   //!< File where statistics table is written.
+};
+
 /**
  * Constants for maximum values.
  */
@@ -189,6 +212,9 @@ static const uint8_t MAX_VHT_WIDTH = 160;        //!< Maximal channel width.
 class MinstrelHtWifiManager : public WifiRemoteStationManager
 {
 public:
+  /// Allow test cases to access private members
+  friend class ::MinstrelHtWifiManagerTest;
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -355,6 +381,9 @@ private:
   /**
    * Updating the Minstrel Table every 1/10 seconds.
    *
+   * The table is updated on the first report after the end of an update
+   * interval, accounting for the intervals elapsed without report.
+   *
    * \param station the minstrel HT wifi remote station
    */
   void UpdateStats (MinstrelHtWifiRemoteStation *station);
@@ -447,6 +476,9 @@ private:
   /**
    * Initialize Sample Table.
    *
+   * As in the Linux implementation, all the HT stations share a sample
+   * table, generated for the first of them.
+   *
    * \param station the minstrel HT wifi remote station
    */
   void InitSampleTable (MinstrelHtWifiRemoteStation *station);
@@ -596,6 +628,7 @@ private:
   bool m_printStats;           //!< If statistics table should be printed.
 
   MinstrelMcsGroups m_minstrelGroups;                 //!< Global array for groups information.
+  HtSampleRate m_sampleTable;                         //!< Sample table shared by the HT stations.
 
   Ptr<MinstrelWifiManager> m_legacyManager;           //!< Pointer to an instance of MinstrelWifiManager. Used when 802.11n/ac not supported.
 
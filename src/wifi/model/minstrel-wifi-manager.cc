@@ -163,6 +163,7 @@ MinstrelWifiManager::DoCreateStation (void) const
   MinstrelWifiRemoteStation *station = new MinstrelWifiRemoteStation ();
 
   station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+  station->m_sampleTable = 0;
   station->m_col = 0;
   station->m_index = 0;
   station->m_maxTpRate = 0;
@@ -194,13 +195,16 @@ MinstrelWifiManager::CheckInit (MinstrelWifiRemoteStation *station)
       //before we perform our own initialization.
       station->m_nModes = GetNSupported (station);
       station->m_minstrelTable = MinstrelRate (station->m_nModes);
-      station->m_sampleTable = SampleRate (station->m_nModes, std::vector<uint8_t> (m_sampleCol));
+      station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
       InitSampleTable (station);
       RateInit (station);
       station->m_initialized = true;
-      std::ostringstream tmp;
-      tmp << "minstrel-stats-" << station->m_state->m_address << ".txt";
-      station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+      if (m_printStats)
+        {
+          std::ostringstream tmp;
+          tmp << "minstrel-stats-" << station->m_state->m_address << ".txt";
+          station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+        }
     }
 }
 
@@ -532,7 +536,14 @@ MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
       return;
     }
   NS_LOG_FUNCTION (this);
-  station->m_nextStatsUpdate = Simulator::Now () + m_updateStats;
+  //count the intervals elapsed without report, which would each have
+  //left the statistics unchanged but for the skipped samples
+  uint32_t nIntervals = 1;
+  if (m_updateStats.IsStrictlyPositive ())
+    {
+      nIntervals += (Simulator::Now () - station->m_nextStatsUpdate).GetTimeStep () / m_updateStats.GetTimeStep ();
+    }
+  station->m_nextStatsUpdate += TimeStep (m_updateStats.GetTimeStep () * nIntervals);
   NS_LOG_DEBUG ("Next update at " << station->m_nextStatsUpdate);
   NS_LOG_DEBUG ("Currently using rate: " << +station->m_txrate << " (" << GetSupported (station, station->m_txrate) << ")");
 
@@ -559,7 +570,7 @@ MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
       //if we've attempted something
       if (station->m_minstrelTable[i].numRateAttempt)
         {
-          station->m_minstrelTable[i].numSamplesSkipped = 0;
+          station->m_minstrelTable[i].numSamplesSkipped = std::min<uint32_t> (nIntervals - 1, 255);
           /**
            * calculate the probability of success
            * assume probability scales from 0 to 18000
@@ -586,7 +597,7 @@ MinstrelWifiManager::UpdateStats (MinstrelWifiRemoteStation *station)
         }
       else
         {
-          station->m_minstrelTable[i].numSamplesSkipped++;
+          station->m_minstrelTable[i].numSamplesSkipped = std::min<uint32_t> (station->m_minstrelTable[i].numSamplesSkipped + nIntervals, 255);
         }
 
       //bookeeping
@@ -887,7 +898,7 @@ uint8_t
 MinstrelWifiManager::GetNextSample (MinstrelWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (this << station);
-  uint8_t bitrate = station->m_sampleTable[station->m_index][station->m_col];
+  uint8_t bitrate = (*station->m_sampleTable)[station->m_index][station->m_col];
   station->m_index++;
 
   //bookeeping for m_index and m_col variables
@@ -977,10 +988,20 @@ void
 MinstrelWifiManager::InitSampleTable (MinstrelWifiRemoteStation *station)
 {
   NS_LOG_FUNCTION (this << station);
-  station->m_col = station->m_index = 0;
+  station->m_index = 0;
+  station->m_col = m_uniformRandomVariable->GetInteger (0, m_sampleCol - 1);
+
+  std::pair<uint8_t, uint8_t> key = std::make_pair (station->m_nModes, m_sampleCol);
+  std::map<std::pair<uint8_t, uint8_t>, SampleRate>::const_iterator it = m_sampleTables.find (key);
+  if (it != m_sampleTables.end ())
+    {
+      station->m_sampleTable = &it->second;
+      return;
+    }
 
   //for off-setting to make rates fall between 0 and nModes
   uint8_t numSampleRates = station->m_nModes;
+  SampleRate sampleTable (numSampleRates, std::vector<uint8_t> (m_sampleCol));
 
   uint8_t newIndex;
   for (uint8_t col = 0; col < m_sampleCol; col++)
@@ -996,13 +1017,14 @@ MinstrelWifiManager::InitSampleTable (MinstrelWifiRemoteStation *station)
           newIndex = (i + uv) % numSampleRates;
 
           //this loop is used for filling in other uninitialized places
-          while (station->m_sampleTable[newIndex][col] != 0)
+          while (sampleTable[newIndex][col] != 0)
             {
-              newIndex = (newIndex + 1) % station->m_nModes;
+              newIndex = (newIndex + 1) % numSampleRates;
             }
-          station->m_sampleTable[newIndex][col] = i;
+          sampleTable[newIndex][col] = i;
         }
     }
+  station->m_sampleTable = &m_sampleTables.insert (std::make_pair (key, sampleTable)).first->second;
 }
 
 void
@@ -1014,7 +1036,7 @@ MinstrelWifiManager::PrintSampleTable (MinstrelWifiRemoteStation *station)
     {
       for (uint8_t j = 0; j < m_sampleCol; j++)
         {
-          table << station->m_sampleTable[i][j] << "\t";
+          table << (*station->m_sampleTable)[i][j] << "\t";
         }
       table << std::endl;
     }
@@ -27,6 +27,8 @@
 #include <fstream>
 #include <map>
 
+class MinstrelWifiManagerTest;
+
 namespace ns3 {
 
 class UniformRandomVariable;
@@ -108,7 +110,7 @@ struct MinstrelWifiRemoteStation : public WifiRemoteStation
   uint8_t m_txrate;              ///< current transmit rate
   bool m_initialized;            ///< for initializing tables
   MinstrelRate m_minstrelTable;  ///< minstrel table
-  SampleRate m_sampleTable;      ///< sample table
+  const SampleRate *m_sampleTable; ///< sample table, shared by the stations with the same number of modes
   std::ofstream m_statsFile;     ///< stats file
 };
 
@@ -157,6 +159,9 @@ struct MinstrelWifiRemoteStation : public WifiRemoteStation
 class MinstrelWifiManager : public WifiRemoteStationManager
 {
 public:
+  /// Allow test cases to access private members
+  friend class ::MinstrelWifiManagerTest;
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -193,6 +198,9 @@ public:
   /**
    * updating the Minstrel Table every 1/10 seconds
    *
+   * The table is updated on the first report after the end of an update
+   * interval, accounting for the intervals elapsed without report.
+   *
    * \param station the station object
    */
   void UpdateStats (MinstrelWifiRemoteStation *station);
@@ -253,6 +261,10 @@ public:
   /**
    * initialize Sample Table
    *
+   * The stations with the same number of modes share a sample table,
+   * generated for the first of them, and start sampling at a random
+   * column.
+   *
    * \param station the station object
    */
   void InitSampleTable (MinstrelWifiRemoteStation *station);
@@ -360,6 +372,8 @@ private:
   uint32_t m_pktLen;        ///< packet length used for calculate mode TxTime
   bool m_printStats;        ///< whether statistics table should be printed.
   bool m_printSamples;      ///< whether samples table should be printed.
+  /// sample tables indexed by number of modes and of columns
+  std::map<std::pair<uint8_t, uint8_t>, SampleRate> m_sampleTables;
 
   /// Provides uniform random variables.
   Ptr<UniformRandomVariable> m_uniformRandomVariable;
@@ -67,10 +67,9 @@ MpduAggregator::Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacke
   Ptr<Packet> currentPacket;
   AmpduSubframeHeader currentHdr;
 
-  uint8_t padding = CalculatePadding (aggregatedPacket);
-  uint32_t actualSize = aggregatedPacket->GetSize ();
+  uint8_t padding = CalculatePadding (aggregatedPacket->GetSize ());
 
-  if ((4 + packet->GetSize () + actualSize + padding) <= GetMaxAmpduSize ())
+  if (GetSizeIfAggregated (packet->GetSize (), aggregatedPacket->GetSize ()) <= GetMaxAmpduSize ())
     {
       if (padding)
         {
@@ -94,7 +93,7 @@ MpduAggregator::AggregateSingleMpdu (Ptr<const Packet> packet, Ptr<Packet> aggre
   Ptr<Packet> currentPacket;
   AmpduSubframeHeader currentHdr;
 
-  uint8_t padding = CalculatePadding (aggregatedPacket);
+  uint8_t padding = CalculatePadding (aggregatedPacket->GetSize ());
   if (padding)
     {
       Ptr<Packet> pad = Create<Packet> (padding);
@@ -124,7 +123,7 @@ MpduAggregator::AddHeaderAndPad (Ptr<Packet> packet, bool last, bool isSingleMpd
     }
 
   packet->AddHeader (currentHdr);
-  uint32_t padding = CalculatePadding (packet);
+  uint32_t padding = CalculatePadding (packet->GetSize ());
 
   if (padding && !last)
     {
@@ -134,15 +133,14 @@ MpduAggregator::AddHeaderAndPad (Ptr<Packet> packet, bool last, bool isSingleMpd
 }
 
 bool
-MpduAggregator::CanBeAggregated (uint32_t packetSize, Ptr<Packet> aggregatedPacket, uint8_t blockAckSize) const
+MpduAggregator::CanBeAggregated (uint32_t packetSize, uint32_t ampduSize, uint8_t blockAckSize) const
 {
-  uint8_t padding = CalculatePadding (aggregatedPacket);
-  uint32_t actualSize = aggregatedPacket->GetSize ();
+  uint8_t padding = CalculatePadding (ampduSize);
   if (blockAckSize > 0)
     {
       blockAckSize = blockAckSize + 4 + padding;
     }
-  if ((4 + packetSize + actualSize + padding + blockAckSize) <= GetMaxAmpduSize ())
+  if ((GetSizeIfAggregated (packetSize, ampduSize) + blockAckSize) <= GetMaxAmpduSize ())
     {
       return true;
     }
@@ -152,10 +150,16 @@ MpduAggregator::CanBeAggregated (uint32_t packetSize, Ptr<Packet> aggregatedPack
     }
 }
 
+uint32_t
+MpduAggregator::GetSizeIfAggregated (uint32_t mpduSize, uint32_t ampduSize)
+{
+  return ampduSize + CalculatePadding (ampduSize) + 4 + mpduSize;
+}
+
 uint8_t
-MpduAggregator::CalculatePadding (Ptr<const Packet> packet) const
+MpduAggregator::CalculatePadding (uint32_t ampduSize)
 {
-  return (4 - (packet->GetSize () % 4 )) % 4;
+  return (4 - (ampduSize % 4 )) % 4;
 }
 
 MpduAggregator::DeaggregatedMpdus
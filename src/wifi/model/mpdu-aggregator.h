@@ -96,14 +96,24 @@ public:
   void AddHeaderAndPad (Ptr<Packet> packet, bool last, bool isSingleMpdu) const;
   /**
    * \param packetSize size of the packet we want to insert into <i>aggregatedPacket</i>.
-   * \param aggregatedPacket packet that will contain the packet of size <i>packetSize</i>, if aggregation is possible.
+   * \param ampduSize size of the A-MPDU that will contain the packet of size <i>packetSize</i>, if aggregation is possible.
    * \param blockAckSize size of the piggybacked block ack request
    *
-   * \return true if the packet of size <i>packetSize</i> can be aggregated to <i>aggregatedPacket</i>, false otherwise.
+   * \return true if the packet of size <i>packetSize</i> can be aggregated to the A-MPDU, false otherwise.
    *
    * This method is used to determine if a packet could be aggregated to an A-MPDU without exceeding the maximum packet size.
    */
-  bool CanBeAggregated (uint32_t packetSize, Ptr<Packet> aggregatedPacket, uint8_t blockAckSize) const;
+  bool CanBeAggregated (uint32_t packetSize, uint32_t ampduSize, uint8_t blockAckSize) const;
+  /**
+   * \param mpduSize the size of the MPDU to aggregate, including MAC header and FCS
+   * \param ampduSize the size of the A-MPDU the MPDU is aggregated to
+   *
+   * \return the size of the A-MPDU once the MPDU is aggregated, including its
+   *         A-MPDU subframe header and the padding of the previous subframe
+   *
+   * This method allows to size an A-MPDU without building it.
+   */
+  static uint32_t GetSizeIfAggregated (uint32_t mpduSize, uint32_t ampduSize);
 
   /**
    * Deaggregates an A-MPDU by removing the A-MPDU subframe header and padding.
@@ -116,13 +126,13 @@ public:
 
 private:
   /**
-   * \param packet the Packet
+   * \param ampduSize the size of the aggregated packet
    * \return padding that must be added to the end of an aggregated packet
    *
    * Calculates how much padding must be added to the end of an aggregated packet, after that a new packet is added.
    * Each A-MPDU subframe is padded so that its length is multiple of 4 octets.
    */
-  uint8_t CalculatePadding (Ptr<const Packet> packet) const;
+  static uint8_t CalculatePadding (uint32_t ampduSize);
 
   uint16_t m_maxAmpduLength; //!< Maximum length in bytes of A-MPDUs
 };
@@ -68,10 +68,9 @@ MsduAggregator::Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacke
   Ptr<Packet> currentPacket;
   AmsduSubframeHeader currentHdr;
 
-  uint8_t padding = CalculatePadding (aggregatedPacket);
-  uint32_t actualSize = aggregatedPacket->GetSize ();
+  uint8_t padding = CalculatePadding (aggregatedPacket->GetSize ());
 
-  if ((14 + packet->GetSize () + actualSize + padding) <= GetMaxAmsduSize ())
+  if (GetSizeIfAggregated (packet->GetSize (), aggregatedPacket->GetSize ()) <= GetMaxAmsduSize ())
     {
       if (padding)
         {
@@ -90,10 +89,16 @@ MsduAggregator::Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacke
   return false;
 }
 
+uint32_t
+MsduAggregator::GetSizeIfAggregated (uint32_t msduSize, uint32_t amsduSize)
+{
+  return amsduSize + CalculatePadding (amsduSize) + 14 + msduSize;
+}
+
 uint8_t
-MsduAggregator::CalculatePadding (Ptr<const Packet> packet) const
+MsduAggregator::CalculatePadding (uint32_t amsduSize)
 {
-  return (4 - (packet->GetSize () % 4 )) % 4;
+  return (4 - (amsduSize % 4 )) % 4;
 }
 
 MsduAggregator::DeaggregatedMsdus
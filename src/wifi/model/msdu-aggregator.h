@@ -79,6 +79,17 @@ public:
   bool Aggregate (Ptr<const Packet> packet, Ptr<Packet> aggregatedPacket,
                   Mac48Address src, Mac48Address dest) const;
 
+  /**
+   * \param msduSize the size of the MSDU to aggregate
+   * \param amsduSize the size of the A-MSDU the MSDU is aggregated to
+   *
+   * \return the size of the A-MSDU once the MSDU is aggregated, including its
+   *         A-MSDU subframe header and the padding of the previous subframe
+   *
+   * This method allows to size an A-MSDU without building it.
+   */
+  static uint32_t GetSizeIfAggregated (uint32_t msduSize, uint32_t amsduSize);
+
   /**
    *
    * \param aggregatedPacket the aggregated packet.
@@ -93,11 +104,11 @@ private:
    * after that a new packet is added.
    * Each A-MSDU subframe is padded so that its length is multiple of 4 octets.
    *
-   * \param packet
+   * \param amsduSize the size of the aggregated packet
    *
    * \return the number of octets required for padding
    */
-  uint8_t CalculatePadding (Ptr<const Packet> packet) const;
+  static uint8_t CalculatePadding (uint32_t amsduSize);
 
   uint16_t m_maxAmsduLength; ///< maximum AMSDU length
 };
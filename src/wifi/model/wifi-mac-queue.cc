@@ -52,7 +52,9 @@ WifiMacQueue::GetTypeId (void)
 }
 
 WifiMacQueue::WifiMacQueue ()
-  : NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
+  : m_frontRank (0),
+    m_backRank (0),
+    NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
 {
 }
 
@@ -74,47 +76,147 @@ WifiMacQueue::GetMaxDelay (void) const
   return m_maxDelay;
 }
 
-bool
-WifiMacQueue::TtlExceeded (ConstIterator &it)
+void
+WifiMacQueue::RemoveExpired (void)
 {
   NS_LOG_FUNCTION (this);
-
-  if (Simulator::Now () > (*it)->GetTimeStamp () + m_maxDelay)
+  while (!m_expiry.empty () && Simulator::Now () > m_expiry.begin ()->first + m_maxDelay)
     {
+      ConstIterator it = m_expiry.begin ()->second;
       NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
                     Simulator::Now () - (*it)->GetTimeStamp () << ")");
-      auto curr = it++;
-      DoRemove (curr);
-      return true;
+      Unindex (it);
+      DoRemove (it);
     }
-  return false;
+}
+
+WifiMacQueue::Entries &
+WifiMacQueue::GetEntries (ConstIterator it)
+{
+  const WifiMacHeader &hdr = (*it)->GetHeader ();
+  if (hdr.IsQosData ())
+    {
+      return m_flows[std::make_pair (hdr.GetAddr1 (), hdr.GetQosTid ())];
+    }
+  return m_others;
 }
 
 bool
-WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
+WifiMacQueue::Insert (bool front, Ptr<WifiMacQueueItem> item)
 {
-  NS_LOG_FUNCTION (this << item);
-  NS_ASSERT_MSG (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS,
-                 "WifiMacQueues must be in packet mode");
+  NS_LOG_FUNCTION (this << front << item);
+  if (!DoEnqueue (front ? Head () : Tail (), item))
+    {
+      return false;
+    }
+  ConstIterator it = front ? Head () : std::prev (Tail ());
+  Entries &entries = GetEntries (it);
+  if (front)
+    {
+      entries.push_front (std::make_pair (--m_frontRank, it));
+    }
+  else
+    {
+      entries.push_back (std::make_pair (m_backRank++, it));
+    }
+  m_expiry.insert (std::make_pair (item->GetTimeStamp (), it));
+  if (item->GetHeader ().IsData ())
+    {
+      m_nPacketsByAddress[item->GetDestinationAddress ()]++;
+    }
+  return true;
+}
 
-  // if the queue is full, remove the first stale packet (if any) encountered
-  // starting from the head of the queue, in order to make room for the new packet.
-  if (QueueBase::GetNPackets () == GetMaxSize ().GetValue ())
+void
+WifiMacQueue::Unindex (ConstIterator it)
+{
+  NS_LOG_FUNCTION (this);
+  // the items are mostly removed from the front of their flow, and in
+  // increasing order of timestamp, hence the searches are short
+  Entries &entries = GetEntries (it);
+  for (Entries::iterator e = entries.begin (); e != entries.end (); e++)
+    {
+      if (e->second == it)
+        {
+          entries.erase (e);
+          break;
+        }
+    }
+  const WifiMacHeader &hdr = (*it)->GetHeader ();
+  if (entries.empty () && hdr.IsQosData ())
+    {
+      m_flows.erase (std::make_pair (hdr.GetAddr1 (), hdr.GetQosTid ()));
+    }
+  auto range = m_expiry.equal_range ((*it)->GetTimeStamp ());
+  for (auto e = range.first; e != range.second; e++)
     {
-      auto it = Head ();
-      while (it != Tail () && !TtlExceeded (it))
+      if (e->second == it)
         {
-          it++;
+          m_expiry.erase (e);
+          break;
         }
     }
+  if (hdr.IsData ())
+    {
+      auto count = m_nPacketsByAddress.find ((*it)->GetDestinationAddress ());
+      NS_ASSERT (count != m_nPacketsByAddress.end ());
+      if (--count->second == 0)
+        {
+          m_nPacketsByAddress.erase (count);
+        }
+    }
+}
+
+const WifiMacQueue::Entries *
+WifiMacQueue::FindFlow (uint8_t tid, Mac48Address dest) const
+{
+  Flows::const_iterator flow = m_flows.find (std::make_pair (dest, tid));
+  if (flow == m_flows.end ())
+    {
+      return 0;
+    }
+  return &flow->second;
+}
+
+WifiMacQueue::ConstIterator
+WifiMacQueue::FindFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets) const
+{
+  // the first item not blocked is the first item of the frames other than
+  // QoS data or of a flow not blocked
+  const Entry *first = 0;
+  if (!m_others.empty ())
+    {
+      first = &m_others.front ();
+    }
+  for (Flows::const_iterator flow = m_flows.begin (); flow != m_flows.end (); flow++)
+    {
+      if ((first == 0 || flow->second.front ().first < first->first)
+          && !blockedPackets->IsBlocked (flow->first.first, flow->first.second))
+        {
+          first = &flow->second.front ();
+        }
+    }
+  return first != 0 ? first->second : Tail ();
+}
+
+bool
+WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT_MSG (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS,
+                 "WifiMacQueues must be in packet mode");
+
+  // remove the stale packets (if any), in order to make room for the new packet.
+  RemoveExpired ();
 
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue () && m_dropPolicy == DROP_OLDEST)
     {
       NS_LOG_DEBUG ("Remove the oldest item in the queue");
+      Unindex (Head ());
       DoRemove (Head ());
     }
 
-  return DoEnqueue (Tail (), item);
+  return Insert (false, item);
 }
 
 bool
@@ -124,36 +226,28 @@ WifiMacQueue::PushFront (Ptr<WifiMacQueueItem> item)
   NS_ASSERT_MSG (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS,
                  "WifiMacQueues must be in packet mode");
 
-  // if the queue is full, remove the first stale packet (if any) encountered
-  // starting from the head of the queue, in order to make room for the new packet.
-  if (QueueBase::GetNPackets () == GetMaxSize ().GetValue ())
-    {
-      auto it = Head ();
-      while (it != Tail () && !TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  // remove the stale packets (if any), in order to make room for the new packet.
+  RemoveExpired ();
 
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue () && m_dropPolicy == DROP_OLDEST)
     {
       NS_LOG_DEBUG ("Remove the oldest item in the queue");
+      Unindex (Head ());
       DoRemove (Head ());
     }
 
-  return DoEnqueue (Head (), item);
+  return Insert (true, item);
 }
 
 Ptr<WifiMacQueueItem>
 WifiMacQueue::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  if (Head () != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoDequeue (it);
-        }
+      Unindex (Head ());
+      return DoDequeue (Head ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -163,17 +257,16 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueByAddress (WifiMacHeader::AddressType type, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  if (m_nPacketsByAddress.find (dest) != m_nPacketsByAddress.end ())
     {
-      if (!TtlExceeded (it))
+      for (auto it = Head (); it != Tail (); it++)
         {
           if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
             {
+              Unindex (it);
               return DoDequeue (it);
             }
-
-          it++;
         }
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -185,18 +278,13 @@ WifiMacQueue::DequeueByTidAndAddress (uint8_t tid,
                                       WifiMacHeader::AddressType type, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  const Entries *entries = FindFlow (tid, dest);
+  if (entries != 0)
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      ConstIterator it = entries->front ().second;
+      Unindex (it);
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -206,18 +294,12 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  ConstIterator it = FindFirstAvailable (blockedPackets);
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      Unindex (it);
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -245,18 +327,11 @@ WifiMacQueue::PeekByTidAndAddress (uint8_t tid,
                                    WifiMacHeader::AddressType type, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  const Entries *entries = FindFlow (tid, dest);
+  if (entries != 0)
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoPeek (it);
-            }
-
-          it++;
-        }
+      return DoPeek (entries->front ().second);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -266,18 +341,11 @@ Ptr<const WifiMacQueueItem>
 WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  ConstIterator it = FindFirstAvailable (blockedPackets);
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoPeek (it);
-            }
-
-          it++;
-        }
+      return DoPeek (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -287,13 +355,11 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::Remove (void)
 {
   NS_LOG_FUNCTION (this);
-
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  if (Head () != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoRemove (it);
-        }
+      Unindex (Head ());
+      return DoRemove (Head ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -303,17 +369,14 @@ bool
 WifiMacQueue::Remove (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  for (auto it = Head (); it != Tail (); it++)
     {
-      if (!TtlExceeded (it))
+      if ((*it)->GetPacket () == packet)
         {
-          if ((*it)->GetPacket () == packet)
-            {
-              DoRemove (it);
-              return true;
-            }
-
-          it++;
+          Unindex (it);
+          DoRemove (it);
+          return true;
         }
     }
   NS_LOG_DEBUG ("Packet " << packet << " not found in the queue");
@@ -324,21 +387,9 @@ uint32_t
 WifiMacQueue::GetNPacketsByAddress (Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-
-  uint32_t nPackets = 0;
-
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
-    }
+  RemoveExpired ();
+  auto count = m_nPacketsByAddress.find (dest);
+  uint32_t nPackets = (count != m_nPacketsByAddress.end () ? count->second : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -347,20 +398,9 @@ uint32_t
 WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  uint32_t nPackets = 0;
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
-    }
+  RemoveExpired ();
+  const Entries *entries = FindFlow (tid, dest);
+  uint32_t nPackets = (entries != 0 ? entries->size () : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -369,16 +409,10 @@ bool
 WifiMacQueue::IsEmpty (void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          NS_LOG_DEBUG ("returns false");
-          return false;
-        }
-    }
-  NS_LOG_DEBUG ("returns true");
-  return true;
+  RemoveExpired ();
+  bool empty = QueueBase::IsEmpty ();
+  NS_LOG_DEBUG ("returns " << (empty ? "true" : "false"));
+  return empty;
 }
 
 uint32_t
@@ -386,13 +420,7 @@ WifiMacQueue::GetNPackets (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNPackets ();
 }
 
@@ -401,13 +429,7 @@ WifiMacQueue::GetNBytes (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNBytes ();
 }
 
@@ -24,6 +24,9 @@
 #ifndef WIFI_MAC_QUEUE_H
 #define WIFI_MAC_QUEUE_H
 
+#include <map>
+#include <list>
+#include <unordered_map>
 #include "wifi-mac-queue-item.h"
 
 namespace ns3 {
@@ -44,6 +47,12 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Besides the queue itself, the items are indexed by timestamp, so that
+ * the non-const methods first drop the stale items without looking at
+ * the others, and the QoS data frames are indexed by receiver and TID, in
+ * queue order, so that the methods looking for the frames of a receiver
+ * and a TID, or for the first frame not blocked, do not walk the queue.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -226,18 +235,57 @@ public:
   uint32_t GetNBytes (void);
 
 private:
+  /// An item and its rank, increasing from the head to the tail of the queue
+  typedef std::pair<int64_t, ConstIterator> Entry;
+  /// Items in queue order
+  typedef std::list<Entry> Entries;
+  /// QoS data frames indexed by receiver and TID
+  typedef std::map<std::pair<Mac48Address, uint8_t>, Entries> Flows;
+
+  /**
+   * Remove the items that have been in the queue for too long.
+   */
+  void RemoveExpired (void);
+  /**
+   * Insert an item in the queue and in the indexes.
+   *
+   * \param front true to insert the item at the front of the queue, false at the end
+   * \param item the item
+   * \return true if success, false if the packet has been dropped
+   */
+  bool Insert (bool front, Ptr<WifiMacQueueItem> item);
   /**
-   * Remove the item pointed to by the iterator <i>it</i> if it has been in the
-   * queue for too long. If the item is removed, the iterator is updated to
-   * point to the item that followed the erased one.
+   * Remove an item from the indexes, before removing it from the queue.
    *
    * \param it an iterator pointing to the item
-   * \return true if the item is removed, false otherwise
    */
-  bool TtlExceeded (ConstIterator &it);
+  void Unindex (ConstIterator it);
+  /**
+   * \param it an iterator pointing to an item
+   * \return the entries of the flow of the item
+   */
+  Entries &GetEntries (ConstIterator it);
+  /**
+   * \param tid the TID
+   * \param dest the receiver
+   * \return the QoS data frames to the receiver with the TID, or 0 if none
+   */
+  const Entries *FindFlow (uint8_t tid, Mac48Address dest) const;
+  /**
+   * \param blockedPackets the blocked receivers and TIDs
+   * \return the first item not blocked, or Tail () if none
+   */
+  ConstIterator FindFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets) const;
 
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
+  Flows m_flows;                            //!< QoS data frames per receiver and TID
+  Entries m_others;                         //!< Frames other than QoS data
+  std::multimap<Time, ConstIterator> m_expiry; //!< Items indexed by timestamp
+  /// Number of data frames per receiver
+  std::unordered_map<Mac48Address, uint32_t, Mac48AddressHash> m_nPacketsByAddress;
+  int64_t m_frontRank;                      //!< Rank of the last item pushed at the front
+  int64_t m_backRank;                       //!< Rank of the next item enqueued at the end
 
   NS_LOG_TEMPLATE_DECLARE;                  //!< redefinition of the log component
 };
@@ -22,6 +22,7 @@
 #ifndef WIFI_PHY_H
 #define WIFI_PHY_H
 
+#include <map>
 #include "ns3/event-id.h"
 #include "wifi-mpdu-type.h"
 #include "wifi-phy-standard.h"
@@ -403,7 +403,9 @@ WifiRemoteStationManager::GetTypeId (void)
 }
 
 WifiRemoteStationManager::WifiRemoteStationManager ()
-  : m_htSupported (false),
+  : m_lastState (0),
+    m_lastStation (0),
+    m_htSupported (false),
     m_vhtSupported (false),
     m_heSupported (false),
     m_pcfSupported (false),
@@ -1613,13 +1615,17 @@ WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
   NS_LOG_FUNCTION (this << address);
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  // consecutive lookups are often for the same station
+  if (m_lastState != 0 && m_lastState->m_address == address)
     {
-      if ((*i)->m_address == address)
-        {
-          NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
-          return (*i);
-        }
+      return m_lastState;
+    }
+  StationStates::const_iterator i = m_states.find (address);
+  if (i != m_states.end ())
+    {
+      NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
+      m_lastState = i->second;
+      return i->second;
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1639,8 +1645,9 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_htSupported = false;
   state->m_vhtSupported = false;
   state->m_heSupported = false;
-  const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  const_cast<WifiRemoteStationManager *> (this)->m_states[address] = state;
   NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning new state");
+  m_lastState = state;
   return state;
 }
 
@@ -1663,11 +1670,18 @@ WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << address << +tid);
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  if (m_lastStation != 0
+      && m_lastStation->m_tid == tid
+      && m_lastStation->m_state->m_address == address)
+    {
+      return m_lastStation;
+    }
+  std::vector<WifiRemoteStation *> &stations = const_cast<WifiRemoteStationManager *> (this)->m_stations[address];
+  for (std::vector<WifiRemoteStation *>::const_iterator i = stations.begin (); i != stations.end (); i++)
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
+      if ((*i)->m_tid == tid)
         {
+          m_lastStation = *i;
           return (*i);
         }
     }
@@ -1678,7 +1692,8 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_tid = tid;
   station->m_ssrc = 0;
   station->m_slrc = 0;
-  const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  stations.push_back (station);
+  m_lastStation = station;
   return station;
 }
 
@@ -1841,14 +1856,19 @@ WifiRemoteStationManager::Reset (void)
   NS_LOG_FUNCTION (this);
   for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_states.clear ();
+  m_lastState = 0;
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      for (std::vector<WifiRemoteStation *>::const_iterator j = i->second.begin (); j != i->second.end (); j++)
+        {
+          delete (*j);
+        }
     }
   m_stations.clear ();
+  m_lastStation = 0;
   m_bssBasicRateSet.clear ();
   m_bssBasicMcsSet.clear ();
 }
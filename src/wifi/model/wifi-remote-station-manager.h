@@ -21,6 +21,7 @@
 #ifndef WIFI_REMOTE_STATION_MANAGER_H
 #define WIFI_REMOTE_STATION_MANAGER_H
 
+#include <unordered_map>
 #include "ns3/traced-callback.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
@@ -1405,13 +1406,13 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * The WifiRemoteStations of each remote address, one per TID
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  typedef std::unordered_map <Mac48Address, std::vector<WifiRemoteStation *>, Mac48AddressHash> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * The WifiRemoteStationState of each remote address
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef std::unordered_map <Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
 
   /**
    * This is a pointer to the WifiPhy associated with this
@@ -1444,6 +1445,8 @@ private:
 
   StationStates m_states;  //!< States of known stations
   Stations m_stations;     //!< Information for each known stations
+  mutable WifiRemoteStationState *m_lastState; //!< State returned by the last LookupState
+  mutable WifiRemoteStation *m_lastStation;    //!< Station returned by the last Lookup
 
   WifiMode m_defaultTxMode; //!< The default transmission mode
   WifiMode m_defaultTxMcs;   //!< The default transmission modulation-coding scheme (MCS)
@@ -18,8 +18,11 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device.h"
@@ -52,11 +55,29 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxLossDb",
+                   "The maximum loss in dB for which transmissions are "
+                   "passed to the receiving PHY. Signals attenuated by more "
+                   "than this value get no packet copy and no reception event. "
+                   "The default value delivers all the signals.",
+                   DoubleValue (1.0e9),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxLossDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The distance in meters beyond which receivers are ignored, "
+                   "without evaluating the propagation models. The receivers "
+                   "are then indexed in a grid of MaxRange-wide cells. "
+                   "0 considers all the receivers. Must be set before the "
+                   "first transmission.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_nGridPhys (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -67,6 +88,23 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the course change callbacks hold a raw pointer to the channel
+  for (std::vector<CourseChangeConnection>::const_iterator i = m_courseChanges.begin (); i != m_courseChanges.end (); i++)
+    {
+      i->first->TraceDisconnectWithoutContext ("CourseChange", i->second);
+    }
+  m_courseChanges.clear ();
+  m_gridCells.clear ();
+  m_receiverCells.clear ();
+  m_movingReceivers.clear ();
+  m_nGridPhys = 0;
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -87,38 +125,141 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (m_maxRange <= 0)
     {
-      if (sender != (*i))
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
-            {
-              continue;
-            }
+          SendTo (sender, senderMobility, *i, packet, txPowerDbm, duration);
+        }
+      return;
+    }
+  SendInRange (sender, senderMobility, packet, txPowerDbm, duration);
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
+void
+YansWifiChannel::SendInRange (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                              Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  // collect the receivers of the cells around the sender, and the moving
+  // ones, and deliver in the order of the PHY list
+  UpdateGrid ();
+  GridCell center = GetGridCell (senderMobility);
+  std::vector<std::size_t> candidates (m_movingReceivers.begin (), m_movingReceivers.end ());
+  for (int64_t x = center.first - 1; x <= center.first + 1; x++)
+    {
+      for (int64_t y = center.second - 1; y <= center.second + 1; y++)
+        {
+          std::unordered_map<GridCell, std::vector<std::size_t>, GridCellHash>::const_iterator cell =
+            m_gridCells.find (GridCell (x, y));
+          if (cell != m_gridCells.end ())
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
             }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
         }
     }
+  std::sort (candidates.begin (), candidates.end ());
+  for (std::vector<std::size_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*i];
+      if (senderMobility->GetDistanceFrom (receiver->GetMobility ()) <= m_maxRange)
+        {
+          SendTo (sender, senderMobility, receiver, packet, txPowerDbm, duration);
+        }
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                         Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  if (sender == receiver)
+    {
+      return;
+    }
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  if (txPowerDbm - rxPowerDbm > m_maxLossDb)
+    {
+      // beyond range, the signal is ignored
+      NS_LOG_DEBUG ("culled: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm");
+      return;
+    }
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+  Ptr<Packet> copy = packet->Copy ();
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
+
+std::size_t
+YansWifiChannel::GridCellHash::operator() (const GridCell &cell) const
+{
+  return std::hash<int64_t> () (cell.first) ^ std::hash<int64_t> () (cell.second) * 0x9e3779b1U;
+}
+
+YansWifiChannel::GridCell
+YansWifiChannel::GetGridCell (Ptr<const MobilityModel> mobility) const
+{
+  Vector position = mobility->GetPosition ();
+  return GridCell (static_cast<int64_t> (std::floor (position.x / m_maxRange)),
+                   static_cast<int64_t> (std::floor (position.y / m_maxRange)));
+}
+
+void
+YansWifiChannel::UpdateGrid (void) const
+{
+  for ( ; m_nGridPhys < m_phyList.size (); m_nGridPhys++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[m_nGridPhys]->GetMobility ();
+      NS_ASSERT (mobility != 0);
+      m_receiverCells.push_back (GetGridCell (mobility));
+      m_movingReceivers.insert (m_nGridPhys);
+      Callback<void, Ptr<const MobilityModel> > courseChanged =
+        MakeCallback (&YansWifiChannel::CourseChanged, this).Bind (m_nGridPhys);
+      mobility->TraceConnectWithoutContext ("CourseChange", courseChanged);
+      m_courseChanges.push_back (CourseChangeConnection (mobility, courseChanged));
+      CourseChanged (m_nGridPhys, mobility);
+    }
+}
+
+void
+YansWifiChannel::CourseChanged (std::size_t index, Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << index << mobility);
+  if (m_movingReceivers.erase (index) == 0)
+    {
+      std::vector<std::size_t> &cell = m_gridCells[m_receiverCells[index]];
+      cell.erase (std::find (cell.begin (), cell.end (), index));
+    }
+  Vector velocity = mobility->GetVelocity ();
+  if (velocity.x != 0 || velocity.y != 0 || velocity.z != 0)
+    {
+      // the position of a moving receiver changes without notification
+      m_movingReceivers.insert (index);
+    }
+  else
+    {
+      m_receiverCells[index] = GetGridCell (mobility);
+      m_gridCells[m_receiverCells[index]].push_back (index);
+    }
 }
 
 void
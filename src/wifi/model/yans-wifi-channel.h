@@ -21,6 +21,10 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include "ns3/callback.h"
 #include "ns3/channel.h"
 
 namespace ns3 {
@@ -31,6 +35,7 @@ class PropagationDelayModel;
 class YansWifiPhy;
 class Packet;
 class Time;
+class MobilityModel;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -40,6 +45,20 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default, every transmission is delivered to every other PHY of the
+ * channel. Two attributes restrict the deliveries to the receivers which
+ * matter, for dense deployments:
+ *  - MaxLossDb drops the signals attenuated beyond a given loss, which
+ *    then cost no packet copy and no event.
+ *  - MaxRange ignores the receivers farther than a given distance from the
+ *    sender, without evaluating the propagation models for them. The
+ *    receivers are kept in a grid of MaxRange-wide cells, updated on the
+ *    course changes of their mobility models, so that a transmission only
+ *    visits the receivers of the neighbor cells, and the moving ones.
+ *
+ * The culled signals are not accounted for as interference by their
+ * receivers, so the thresholds should keep them below the noise floor.
  */
 class YansWifiChannel : public Channel
 {
@@ -98,6 +117,9 @@ public:
   int64_t AssignStreams (int64_t stream);
 
 
+protected:
+  virtual void DoDispose (void);
+
 private:
   /**
    * A vector of pointers to YansWifiPhy.
@@ -116,9 +138,79 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
 
+  /**
+   * Deliver a transmission to a receiver.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object to which the packet is delivered
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+               Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+
+  /// A cell of the receiver grid
+  typedef std::pair<int64_t, int64_t> GridCell;
+
+  /**
+   * \brief Hash function of the grid cells.
+   */
+  struct GridCellHash
+  {
+    /**
+     * \param cell a cell
+     * \returns the hash of the cell
+     */
+    std::size_t operator() (const GridCell &cell) const;
+  };
+
+  /**
+   * Deliver a transmission to the receivers in MaxRange.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendInRange (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                    Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+
+  /**
+   * Add the PHYs connected since the last transmission to the receiver grid.
+   */
+  void UpdateGrid (void) const;
+
+  /**
+   * Move a receiver in the grid after a course change.
+   *
+   * \param index the index of the receiver in the PHY list
+   * \param mobility the mobility model of the receiver
+   */
+  void CourseChanged (std::size_t index, Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * \param mobility a mobility model
+   * \returns the grid cell of its current position
+   */
+  GridCell GetGridCell (Ptr<const MobilityModel> mobility) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxLossDb;                  //!< Loss beyond which the signals are not received
+  double m_maxRange;                   //!< Distance beyond which the receivers are ignored, 0 for none
+
+  mutable std::size_t m_nGridPhys;     //!< Number of PHYs added to the grid
+  /// Receivers which were not moving at their last course change, by grid cell
+  mutable std::unordered_map<GridCell, std::vector<std::size_t>, GridCellHash> m_gridCells;
+  mutable std::vector<GridCell> m_receiverCells; //!< Grid cell of each receiver
+  mutable std::set<std::size_t> m_movingReceivers; //!< Receivers which are not in the grid
+  /// The mobility model of a receiver and the callback connected to its CourseChange
+  typedef std::pair<Ptr<MobilityModel>, Callback<void, Ptr<const MobilityModel> > > CourseChangeConnection;
+  mutable std::vector<CourseChangeConnection> m_courseChanges; //!< Connections to the CourseChange of the receivers
 };
 
 } //namespace ns3
@@ -21,6 +21,14 @@
 #include "ns3/test.h"
 #include "ns3/qos-utils.h"
 #include "ns3/ctrl-headers.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/block-ack-manager.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/mac-tx-middle.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include "ns3/yans-wifi-phy.h"
 
 using namespace ns3;
 
@@ -306,6 +314,203 @@ CtrlBAckResponseHeaderTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_blockAckHdr.IsPacketReceived (80), false, "error in compressed bitmap");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test for the retransmission queue of the block ack manager
+ *
+ * Ten packets, whose sequence numbers wrap around, are sent under a block
+ * ack agreement and the block ack reports two of them as lost. The lost
+ * packets must be retransmitted in the order of their sequence numbers and
+ * the second block ack, reporting them as received, must empty the queues.
+ * Then, packets of two other agreements are lost, and they must be
+ * retransmitted in the order they were reported lost. Finally, the BARs of
+ * the three agreements must be sent in order, except those of a destroyed
+ * agreement.
+ */
+class BlockAckManagerRetryTest : public TestCase
+{
+public:
+  BlockAckManagerRetryTest ();
+private:
+  virtual void DoRun ();
+  /**
+   * Callback blocking and unblocking a destination.
+   * \param recipient the recipient
+   * \param tid the TID
+   */
+  void Block (Mac48Address recipient, uint8_t tid);
+  /**
+   * Establish a block ack agreement.
+   * \param manager the block ack manager
+   * \param recipient the recipient
+   * \param tid the TID
+   * \param startingSeq the starting sequence number
+   */
+  void CreateAgreement (Ptr<BlockAckManager> manager, Mac48Address recipient, uint8_t tid, uint16_t startingSeq);
+  /**
+   * Send a packet under an agreement and receive a block ack reporting it lost.
+   * \param manager the block ack manager
+   * \param recipient the recipient
+   * \param tid the TID
+   * \param seq the sequence number of the packet
+   * \param mode the mode of the block ack
+   */
+  void LosePacket (Ptr<BlockAckManager> manager, Mac48Address recipient, uint8_t tid, uint16_t seq, WifiMode mode);
+};
+
+BlockAckManagerRetryTest::BlockAckManagerRetryTest ()
+  : TestCase ("Check the retransmission queue of the block ack manager")
+{
+}
+
+void
+BlockAckManagerRetryTest::Block (Mac48Address recipient, uint8_t tid)
+{
+}
+
+void
+BlockAckManagerRetryTest::CreateAgreement (Ptr<BlockAckManager> manager, Mac48Address recipient, uint8_t tid, uint16_t startingSeq)
+{
+  MgtAddBaRequestHeader reqHdr;
+  reqHdr.SetImmediateBlockAck ();
+  reqHdr.SetTid (tid);
+  reqHdr.SetTimeout (0);
+  reqHdr.SetBufferSize (63);
+  reqHdr.SetStartingSequence (startingSeq);
+  manager->CreateAgreement (&reqHdr, recipient);
+  MgtAddBaResponseHeader respHdr;
+  respHdr.SetImmediateBlockAck ();
+  respHdr.SetTid (tid);
+  respHdr.SetTimeout (0);
+  respHdr.SetBufferSize (63);
+  manager->UpdateAgreement (&respHdr, recipient);
+}
+
+void
+BlockAckManagerRetryTest::LosePacket (Ptr<BlockAckManager> manager, Mac48Address recipient, uint8_t tid, uint16_t seq, WifiMode mode)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (recipient);
+  hdr.SetQosTid (tid);
+  hdr.SetSequenceNumber (seq);
+  manager->StorePacket (Create<Packet> (100), hdr, Simulator::Now ());
+  CtrlBAckResponseHeader blockAck;
+  blockAck.SetType (COMPRESSED_BLOCK_ACK);
+  blockAck.SetTidInfo (tid);
+  blockAck.SetStartingSequence (seq);
+  manager->NotifyGotBlockAck (&blockAck, recipient, 0, mode, 0);
+}
+
+void
+BlockAckManagerRetryTest::DoRun (void)
+{
+  Mac48Address recipient ("00:00:00:00:00:02");
+  uint16_t startingSeq = 4090;
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  Ptr<ConstantRateWifiManager> stationManager = CreateObject<ConstantRateWifiManager> ();
+  stationManager->SetupPhy (phy);
+  Ptr<BlockAckManager> manager = CreateObject<BlockAckManager> ();
+  manager->SetWifiRemoteStationManager (stationManager);
+  manager->SetQueue (CreateObject<WifiMacQueue> ());
+  manager->SetTxMiddle (Create<MacTxMiddle> ());
+  manager->SetMaxPacketDelay (Seconds (10));
+  manager->SetBlockAckThreshold (64);
+  manager->SetBlockAckType (COMPRESSED_BLOCK_ACK);
+  manager->SetBlockDestinationCallback (MakeCallback (&BlockAckManagerRetryTest::Block, this));
+  manager->SetUnblockDestinationCallback (MakeCallback (&BlockAckManagerRetryTest::Block, this));
+
+  CreateAgreement (manager, recipient, 0, startingSeq);
+
+  for (uint16_t i = 0; i < 10; i++)
+    {
+      WifiMacHeader hdr;
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      hdr.SetAddr1 (recipient);
+      hdr.SetQosTid (0);
+      hdr.SetSequenceNumber ((startingSeq + i) % 4096);
+      manager->StorePacket (Create<Packet> (100), hdr, Simulator::Now ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), false, "No packet should need a retransmission");
+
+  // the packets 4093 and 0 are lost
+  CtrlBAckResponseHeader blockAck;
+  blockAck.SetType (COMPRESSED_BLOCK_ACK);
+  blockAck.SetTidInfo (0);
+  blockAck.SetStartingSequence (startingSeq);
+  for (uint16_t i = 0; i < 10; i++)
+    {
+      uint16_t seq = (startingSeq + i) % 4096;
+      if (seq != 4093 && seq != 0)
+        {
+          blockAck.SetReceivedPacket (seq);
+        }
+    }
+  manager->NotifyGotBlockAck (&blockAck, recipient, 0, phy->GetMode (0), 0);
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), true, "Two packets should need a retransmission");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNBufferedPackets (recipient, 0), 2, "Acknowledged packets still buffered");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNRetryNeededPackets (recipient, 0), 2, "Wrong number of packets to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetSeqNumOfNextRetryPacket (recipient, 0), 4093, "Wrong packet to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (manager->AlreadyExists (0, recipient, 0), true, "Packet 0 should need a retransmission");
+  NS_TEST_EXPECT_MSG_EQ (manager->AlreadyExists (4094, recipient, 0), false, "Packet 4094 was acknowledged");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNRetryNeededPackets (recipient, 1), 0, "No packet sent for TID 1");
+
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = manager->GetNextPacket (hdr, true);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "No packet to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (hdr.GetSequenceNumber (), 4093, "Wrong packet retransmitted");
+  NS_TEST_EXPECT_MSG_EQ (hdr.IsRetry (), true, "Retransmitted packet not flagged as retry");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetSeqNumOfNextRetryPacket (recipient, 0), 0, "Wrong packet to retransmit");
+
+  // the retransmitted packets are received
+  blockAck.ResetBitmap ();
+  blockAck.SetStartingSequence (4093);
+  blockAck.SetReceivedPacket (4093);
+  blockAck.SetReceivedPacket (0);
+  manager->NotifyGotBlockAck (&blockAck, recipient, 0, phy->GetMode (0), 0);
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), false, "No packet should need a retransmission");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNRetryNeededPackets (recipient, 0), 0, "Wrong number of packets to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetSeqNumOfNextRetryPacket (recipient, 0), 4096, "No packet should need a retransmission");
+
+  // the agreements are served in the order their packets were lost, not in
+  // the order of their recipients
+  Mac48Address other ("00:00:00:00:00:01");
+  CreateAgreement (manager, recipient, 1, 100);
+  CreateAgreement (manager, other, 0, 10);
+  LosePacket (manager, recipient, 1, 100, phy->GetMode (0));
+  LosePacket (manager, other, 0, 10, phy->GetMode (0));
+  packet = manager->GetNextPacket (hdr, true);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "No packet to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (hdr.GetAddr1 (), recipient, "Wrong agreement served first");
+  NS_TEST_EXPECT_MSG_EQ (hdr.GetSequenceNumber (), 100, "Wrong packet retransmitted");
+  packet = manager->GetNextPacket (hdr, true);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "No packet to retransmit");
+  NS_TEST_EXPECT_MSG_EQ (hdr.GetAddr1 (), other, "Wrong agreement served second");
+  NS_TEST_EXPECT_MSG_EQ (hdr.GetSequenceNumber (), 10, "Wrong packet retransmitted");
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), false, "No packet should need a retransmission");
+
+  // with nothing left to send, each transmission schedules a BAR
+  manager->NotifyMpduTransmission (other, 0, 11, WifiMacHeader::BLOCK_ACK);
+  manager->NotifyMpduTransmission (recipient, 1, 101, WifiMacHeader::BLOCK_ACK);
+  manager->NotifyMpduTransmission (recipient, 0, 1, WifiMacHeader::BLOCK_ACK);
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), true, "BARs should be pending");
+  manager->DestroyAgreement (recipient, 1);
+  Bar bar;
+  NS_TEST_ASSERT_MSG_EQ (manager->HasBar (bar), true, "Missing BAR");
+  NS_TEST_EXPECT_MSG_EQ (bar.recipient, other, "Wrong first BAR");
+  NS_TEST_ASSERT_MSG_EQ (manager->HasBar (bar), true, "Missing BAR");
+  NS_TEST_EXPECT_MSG_EQ (bar.recipient, recipient, "Wrong second BAR");
+  NS_TEST_EXPECT_MSG_EQ (+bar.tid, 0, "BAR of a destroyed agreement sent");
+  NS_TEST_EXPECT_MSG_EQ (manager->HasBar (bar), false, "No BAR should be pending");
+
+  manager->DestroyAgreement (other, 0);
+  manager->DestroyAgreement (recipient, 0);
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -324,6 +529,7 @@ BlockAckTestSuite::BlockAckTestSuite ()
   AddTestCase (new PacketBufferingCaseA, TestCase::QUICK);
   AddTestCase (new PacketBufferingCaseB, TestCase::QUICK);
   AddTestCase (new CtrlBAckResponseHeaderTest, TestCase::QUICK);
+  AddTestCase (new BlockAckManagerRetryTest, TestCase::QUICK);
 }
 
 static BlockAckTestSuite g_blockAckTestSuite; ///< the test suite
@@ -0,0 +1,429 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/adhoc-wifi-mac.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/minstrel-wifi-manager.h"
+#include "ns3/minstrel-ht-wifi-manager.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * Create an adhoc device with the given standard and remote station manager.
+ *
+ * \param standard the standard of the MAC and of the PHY
+ * \param manager the remote station manager
+ */
+static void
+ConfigureDevice (WifiPhyStandard standard, Ptr<WifiRemoteStationManager> manager)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  Ptr<AdhocWifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (standard);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (standard);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+  manager->Initialize ();
+}
+
+/**
+ * Create the state of a remote station which supports the first rates of a PHY.
+ *
+ * \param phy the PHY
+ * \param nModes the number of non-HT rates of the station
+ * \param nMcs the number of HT rates of the station
+ * \return the state, to be deleted by the caller
+ */
+static WifiRemoteStationState *
+CreateState (Ptr<WifiPhy> phy, uint8_t nModes, uint8_t nMcs)
+{
+  WifiRemoteStationState *state = new WifiRemoteStationState ();
+  state->m_state = WifiRemoteStationState::BRAND_NEW;
+  state->m_address = Mac48Address::Allocate ();
+  for (uint8_t i = 0; i < nModes; i++)
+    {
+      state->m_operationalRateSet.push_back (phy->GetMode (i));
+    }
+  for (uint8_t i = 0; i < nMcs; i++)
+    {
+      state->m_operationalMcsSet.push_back (phy->GetMcs (i));
+    }
+  state->m_channelWidth = 20;
+  state->m_shortGuardInterval = false;
+  state->m_guardInterval = 800;
+  state->m_greenfield = false;
+  state->m_streams = 1;
+  state->m_ness = 0;
+  state->m_aggregation = false;
+  state->m_stbc = false;
+  state->m_ldpc = false;
+  state->m_qosSupported = false;
+  state->m_htSupported = nMcs > 0;
+  state->m_vhtSupported = false;
+  state->m_heSupported = false;
+  return state;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Minstrel Wifi manager statistics and sample table Test
+ *
+ * A station reports transmissions at a single rate after an idle period of
+ * several update intervals, then at the next update. The statistics of the
+ * rates are checked after each update. Stations with the same number of
+ * rates are then checked to share one sample table while sampling every
+ * rate over a cycle of the table.
+ */
+class MinstrelWifiManagerTest : public TestCase
+{
+public:
+  MinstrelWifiManagerTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Report transmissions at a rate and update the statistics.
+   *
+   * \param rate the index of the rate
+   * \param attempts the number of transmission attempts
+   * \param successes the number of successful transmissions
+   */
+  void Report (uint8_t rate, uint32_t attempts, uint32_t successes);
+  /// Check the statistics after an idle period of several intervals
+  void CheckCatchUp (void);
+  /// Check the statistics after the next interval
+  void CheckNextInterval (void);
+  /// Check the statistics are not updated before the next update time
+  void CheckEarly (void);
+  /// Check the sample tables of stations with the same number of rates
+  void CheckSampleTables (void);
+
+  Ptr<MinstrelWifiManager> m_manager; ///< the manager
+  MinstrelWifiRemoteStation *m_station; ///< the station whose statistics are checked
+};
+
+MinstrelWifiManagerTest::MinstrelWifiManagerTest ()
+  : TestCase ("Minstrel statistics update and sample tables")
+{
+}
+
+void
+MinstrelWifiManagerTest::Report (uint8_t rate, uint32_t attempts, uint32_t successes)
+{
+  m_station->m_minstrelTable[rate].numRateAttempt = attempts;
+  m_station->m_minstrelTable[rate].numRateSuccess = successes;
+  m_manager->UpdateStats (m_station);
+}
+
+void
+MinstrelWifiManagerTest::CheckCatchUp (void)
+{
+  //the first update was due at 100 ms; at 350 ms, the intervals ending at
+  //100, 200 and 300 ms have elapsed
+  Report (1, 10, 5);
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (400), "The next update is not on the interval grid");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[1].prob, 9000, "Wrong success probability");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[1].ewmaProb, 9000, "The first EWMA is not the success probability");
+  NS_TEST_EXPECT_MSG_EQ (+m_station->m_minstrelTable[1].numSamplesSkipped, 2, "The reported rate did not skip the idle intervals");
+  for (uint8_t i = 0; i < m_station->m_nModes; i++)
+    {
+      if (i != 1)
+        {
+          NS_TEST_EXPECT_MSG_EQ (+m_station->m_minstrelTable[i].numSamplesSkipped, 3, "Rate " << +i << " did not skip every interval");
+          NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[i].ewmaProb, 0, "Rate " << +i << " has an EWMA without reports");
+        }
+    }
+}
+
+void
+MinstrelWifiManagerTest::CheckNextInterval (void)
+{
+  Report (1, 10, 10);
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (500), "Wrong next update time");
+  //(18000 * 25 + 9000 * 75) / 100
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[1].ewmaProb, 11250, "Wrong EWMA");
+  NS_TEST_EXPECT_MSG_EQ (+m_station->m_minstrelTable[1].numSamplesSkipped, 0, "The reported rate skipped an interval");
+  NS_TEST_EXPECT_MSG_EQ (+m_station->m_minstrelTable[0].numSamplesSkipped, 4, "Rate 0 did not skip the interval");
+}
+
+void
+MinstrelWifiManagerTest::CheckEarly (void)
+{
+  Report (1, 10, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (500), "The next update time moved");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[1].ewmaProb, 11250, "The statistics were updated early");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_minstrelTable[1].numRateAttempt, 10, "The reports were cleared early");
+}
+
+void
+MinstrelWifiManagerTest::CheckSampleTables (void)
+{
+  Ptr<WifiPhy> phy = m_manager->GetPhy ();
+  std::vector<WifiRemoteStationState *> states;
+  std::vector<MinstrelWifiRemoteStation *> stations;
+  uint8_t nModes[] = {8, 8, 8, 6};
+  for (uint8_t n : nModes)
+    {
+      states.push_back (CreateState (phy, n, 0));
+      stations.push_back (static_cast<MinstrelWifiRemoteStation *> (m_manager->DoCreateStation ()));
+      stations.back ()->m_state = states.back ();
+      m_manager->CheckInit (stations.back ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (stations[1]->m_sampleTable, stations[0]->m_sampleTable, "The sample table is not shared");
+  NS_TEST_EXPECT_MSG_EQ (stations[2]->m_sampleTable, stations[0]->m_sampleTable, "The sample table is not shared");
+  NS_TEST_EXPECT_MSG_NE (stations[3]->m_sampleTable, stations[0]->m_sampleTable, "A table is shared by stations with different numbers of rates");
+  NS_TEST_EXPECT_MSG_EQ (m_manager->m_sampleTables.size (), 2, "Wrong number of sample tables");
+
+  for (MinstrelWifiRemoteStation *station : stations)
+    {
+      const SampleRate &table = *station->m_sampleTable;
+      for (uint8_t col = 0; col < m_manager->m_sampleCol; col++)
+        {
+          std::vector<bool> found (station->m_nModes, false);
+          for (uint8_t i = 0; i < station->m_nModes; i++)
+            {
+              found[table[i][col]] = true;
+            }
+          NS_TEST_EXPECT_MSG_EQ (std::count (found.begin (), found.end (), true), station->m_nModes, "Column " << +col << " is not a permutation of the rates");
+        }
+
+      //a cycle goes through the rows but the last of every column
+      std::vector<uint32_t> samples (station->m_nModes, 0);
+      uint8_t startCol = station->m_col;
+      for (uint32_t i = 0; i < m_manager->m_sampleCol * (station->m_nModes - 1u); i++)
+        {
+          samples[m_manager->GetNextSample (station)]++;
+        }
+      NS_TEST_EXPECT_MSG_EQ (+station->m_col, +startCol, "The cycle did not end at its first column");
+      for (uint8_t i = 0; i < station->m_nModes; i++)
+        {
+          NS_TEST_EXPECT_MSG_GT (samples[i], 0, "Rate " << +i << " was never sampled");
+        }
+    }
+
+  for (uint8_t i = 0; i < stations.size (); i++)
+    {
+      delete stations[i];
+      delete states[i];
+    }
+}
+
+void
+MinstrelWifiManagerTest::DoRun (void)
+{
+  m_manager = CreateObject<MinstrelWifiManager> ();
+  ConfigureDevice (WIFI_PHY_STANDARD_80211a, m_manager);
+  WifiRemoteStationState *state = CreateState (m_manager->GetPhy (), 8, 0);
+  m_station = static_cast<MinstrelWifiRemoteStation *> (m_manager->DoCreateStation ());
+  m_station->m_state = state;
+  m_manager->CheckInit (m_station);
+  NS_TEST_ASSERT_MSG_EQ (m_station->m_initialized, true, "The station is not initialized");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (100), "Wrong first update time");
+
+  Simulator::Schedule (MilliSeconds (350), &MinstrelWifiManagerTest::CheckCatchUp, this);
+  Simulator::Schedule (MilliSeconds (400), &MinstrelWifiManagerTest::CheckNextInterval, this);
+  Simulator::Schedule (MilliSeconds (450), &MinstrelWifiManagerTest::CheckEarly, this);
+  Simulator::Schedule (MilliSeconds (500), &MinstrelWifiManagerTest::CheckSampleTables, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  delete m_station;
+  delete state;
+  m_manager = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Minstrel HT Wifi manager statistics and sample table Test
+ *
+ * Same as MinstrelWifiManagerTest for the single group of a 20 MHz, single
+ * stream 802.11n device, whose HT stations all share one sample table.
+ */
+class MinstrelHtWifiManagerTest : public TestCase
+{
+public:
+  MinstrelHtWifiManagerTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Report transmissions at a rate of the group and update the statistics.
+   *
+   * \param rate the index of the rate in the group
+   * \param attempts the number of transmission attempts
+   * \param successes the number of successful transmissions
+   */
+  void Report (uint8_t rate, uint32_t attempts, uint32_t successes);
+  /// Check the statistics after an idle period of several intervals
+  void CheckCatchUp (void);
+  /// Check the statistics after the next interval
+  void CheckNextInterval (void);
+  /// Check the sample table of the HT stations
+  void CheckSampleTables (void);
+
+  Ptr<MinstrelHtWifiManager> m_manager; ///< the manager
+  MinstrelHtWifiRemoteStation *m_station; ///< the station whose statistics are checked
+  uint8_t m_group; ///< the group supported by the device
+};
+
+MinstrelHtWifiManagerTest::MinstrelHtWifiManagerTest ()
+  : TestCase ("Minstrel HT statistics update and sample tables")
+{
+}
+
+void
+MinstrelHtWifiManagerTest::Report (uint8_t rate, uint32_t attempts, uint32_t successes)
+{
+  m_station->m_groupsTable[m_group].m_ratesTable[rate].numRateAttempt = attempts;
+  m_station->m_groupsTable[m_group].m_ratesTable[rate].numRateSuccess = successes;
+  m_manager->UpdateStats (m_station);
+}
+
+void
+MinstrelHtWifiManagerTest::CheckCatchUp (void)
+{
+  Report (1, 10, 5);
+  const HtMinstrelRate &rates = m_station->m_groupsTable[m_group].m_ratesTable;
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (400), "The next update is not on the interval grid");
+  NS_TEST_EXPECT_MSG_EQ (rates[1].ewmaProb, 50.0, "The first EWMA is not the success probability");
+  NS_TEST_EXPECT_MSG_EQ (rates[1].numSamplesSkipped, 2, "The reported rate did not skip the idle intervals");
+  //the rates not reported also skipped the update made at initialization
+  for (uint8_t i = 0; i < m_manager->m_numRates; i++)
+    {
+      if (i != 1)
+        {
+          NS_TEST_EXPECT_MSG_EQ (rates[i].numSamplesSkipped, 4, "Rate " << +i << " did not skip every interval");
+        }
+    }
+}
+
+void
+MinstrelHtWifiManagerTest::CheckNextInterval (void)
+{
+  Report (1, 10, 10);
+  const HtMinstrelRate &rates = m_station->m_groupsTable[m_group].m_ratesTable;
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (500), "Wrong next update time");
+  //(100 * 25 + 50 * 75) / 100
+  NS_TEST_EXPECT_MSG_EQ_TOL (rates[1].ewmaProb, 62.5, 1e-9, "Wrong EWMA");
+  NS_TEST_EXPECT_MSG_EQ (rates[1].numSamplesSkipped, 0, "The reported rate skipped an interval");
+  NS_TEST_EXPECT_MSG_EQ (rates[0].numSamplesSkipped, 5, "Rate 0 did not skip the interval");
+}
+
+void
+MinstrelHtWifiManagerTest::CheckSampleTables (void)
+{
+  Ptr<WifiPhy> phy = m_manager->GetPhy ();
+  std::vector<WifiRemoteStationState *> states;
+  std::vector<MinstrelHtWifiRemoteStation *> stations;
+  for (uint8_t i = 0; i < 3; i++)
+    {
+      states.push_back (CreateState (phy, 1, 8));
+      stations.push_back (static_cast<MinstrelHtWifiRemoteStation *> (m_manager->DoCreateStation ()));
+      stations.back ()->m_state = states.back ();
+      m_manager->CheckInit (stations.back ());
+      NS_TEST_EXPECT_MSG_EQ (stations.back ()->m_sampleTable, &m_manager->m_sampleTable, "The sample table is not shared");
+    }
+
+  for (MinstrelHtWifiRemoteStation *station : stations)
+    {
+      //the rows of every column of the group go by once in a cycle
+      std::vector<uint32_t> samples (m_manager->m_numRates, 0);
+      for (uint32_t i = 0; i < m_manager->m_nSampleCol * m_manager->m_numRates; i++)
+        {
+          uint8_t index = m_manager->GetNextSample (station);
+          NS_TEST_EXPECT_MSG_EQ (+m_manager->GetGroupId (index), +m_group, "Sample out of the supported group");
+          samples[m_manager->GetRateId (index)]++;
+        }
+      for (uint8_t i = 0; i < m_manager->m_numRates; i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (samples[i], m_manager->m_nSampleCol, "Rate " << +i << " was not sampled once per column");
+        }
+    }
+
+  for (uint8_t i = 0; i < stations.size (); i++)
+    {
+      delete stations[i];
+      delete states[i];
+    }
+}
+
+void
+MinstrelHtWifiManagerTest::DoRun (void)
+{
+  m_manager = CreateObject<MinstrelHtWifiManager> ();
+  ConfigureDevice (WIFI_PHY_STANDARD_80211n_5GHZ, m_manager);
+  m_group = m_manager->GetHtGroupId (1, 0, 20);
+  WifiRemoteStationState *state = CreateState (m_manager->GetPhy (), 1, 8);
+  m_station = static_cast<MinstrelHtWifiRemoteStation *> (m_manager->DoCreateStation ());
+  m_station->m_state = state;
+  m_manager->CheckInit (m_station);
+  NS_TEST_ASSERT_MSG_EQ (m_station->m_isHt, true, "The station is not handled as an HT station");
+  NS_TEST_ASSERT_MSG_EQ (m_station->m_groupsTable[m_group].m_supported, true, "The group of the device is not supported");
+  NS_TEST_EXPECT_MSG_EQ (m_station->m_nextStatsUpdate, MilliSeconds (100), "Wrong first update time");
+
+  Simulator::Schedule (MilliSeconds (350), &MinstrelHtWifiManagerTest::CheckCatchUp, this);
+  Simulator::Schedule (MilliSeconds (400), &MinstrelHtWifiManagerTest::CheckNextInterval, this);
+  Simulator::Schedule (MilliSeconds (500), &MinstrelHtWifiManagerTest::CheckSampleTables, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  delete m_station;
+  delete state;
+  m_manager = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Minstrel TestSuite
+ */
+class MinstrelTestSuite : public TestSuite
+{
+public:
+  MinstrelTestSuite ();
+};
+
+MinstrelTestSuite::MinstrelTestSuite ()
+  : TestSuite ("wifi-minstrel", UNIT)
+{
+  AddTestCase (new MinstrelWifiManagerTest, TestCase::QUICK);
+  AddTestCase (new MinstrelHtWifiManagerTest, TestCase::QUICK);
+}
+
+static MinstrelTestSuite g_minstrelTestSuite; ///< the test suite
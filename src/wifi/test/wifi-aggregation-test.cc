@@ -325,7 +325,6 @@ TwoLevelAggregationTest::DoRun (void)
    * Create dummy packets of 1500 bytes and fill mac header fields that will be used for the tests.
    */
   Ptr<const Packet> pkt = Create<Packet> (1500);
-  Ptr<Packet> currentAggregatedPacket = Create<Packet> ();
   WifiMacHeader hdr, peekedHdr;
   hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
   hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
@@ -354,7 +353,7 @@ TwoLevelAggregationTest::DoRun (void)
   m_low->m_currentHdr = peekedHdr;
   m_low->m_currentTxVector = m_low->GetDataTxVector (m_low->m_currentPacket, &m_low->m_currentHdr);
 
-  Ptr<Packet> packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, 0);
+  Ptr<Packet> packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, 0, 0);
 
   bool result = (packet != 0);
   NS_TEST_EXPECT_MSG_EQ (result, true, "aggregation failed");
@@ -375,7 +374,7 @@ TwoLevelAggregationTest::DoRun (void)
   m_txop->SetMpduAggregator (m_mpduAggregator);
 
   m_txop->GetWifiMacQueue ()->Enqueue (Create<WifiMacQueueItem> (pkt, hdr));
-  packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, 0);
+  packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, 0, 0);
 
   result = (packet != 0);
   NS_TEST_EXPECT_MSG_EQ (result, false, "maximum aggregated frame size check failed");
@@ -391,11 +390,35 @@ TwoLevelAggregationTest::DoRun (void)
 
   m_txop->GetWifiMacQueue ()->Remove (pkt);
   m_txop->GetWifiMacQueue ()->Remove (pkt);
-  packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, currentAggregatedPacket, 0);
+  packet = m_low->PerformMsduAggregation (peekedPacket, &peekedHdr, &tstamp, 0, 0);
 
   result = (packet != 0);
   NS_TEST_EXPECT_MSG_EQ (result, false, "aggregation failed to stop as queue is empty");
 
+  //-----------------------------------------------------------------------------------------------------
+
+  /*
+   * The A-MSDU is sized before an MSDU is aggregated to it.
+   * Three packets are queued but the maximum A-MPDU size only leaves room for an A-MSDU of two packets:
+   *      - A-MSDU frame size should be 3030 bytes (= 2 packets + headers + padding);
+   *      - the third packet should not be part of the A-MSDU and should still be in the queue.
+   */
+  m_txop->GetWifiMacQueue ()->Flush ();
+  m_mpduAggregator->SetMaxAmpduSize (3100);
+  for (uint8_t i = 0; i < 3; i++)
+    {
+      m_txop->GetWifiMacQueue ()->Enqueue (Create<WifiMacQueueItem> (pkt, hdr));
+    }
+  peekedItem = m_txop->GetWifiMacQueue ()->PeekByTidAndAddress (0, WifiMacHeader::ADDR1, hdr.GetAddr1 ());
+  peekedHdr = peekedItem->GetHeader ();
+  packet = m_low->PerformMsduAggregation (peekedItem->GetPacket (), &peekedHdr, &tstamp, 0, 0);
+
+  result = (packet != 0);
+  NS_TEST_ASSERT_MSG_EQ (result, true, "aggregation failed");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), MsduAggregator::GetSizeIfAggregated (1500, MsduAggregator::GetSizeIfAggregated (1500, 0)), "wrong packet size");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 3030, "wrong packet size");
+  NS_TEST_EXPECT_MSG_EQ (m_txop->GetWifiMacQueue ()->GetNPackets (), 1, "rejected packet removed from the queue");
+
   Simulator::Destroy ();
 
   m_low->Dispose ();
@@ -22,6 +22,9 @@
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
 #include "ns3/dsss-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/interpolated-error-rate-model.h"
+#include "ns3/wifi-phy.h"
 #include "ns3/wifi-tx-vector.h"
 
 using namespace ns3;
@@ -291,6 +294,73 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Interpolated error rate model test case
+ *
+ * The interpolated NIST and YANS models are compared to the analytic ones
+ * between the points of the grid and out of it, for several modes.
+ */
+class WifiErrorRateModelsTestCaseInterpolated : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseInterpolated ();
+  virtual ~WifiErrorRateModelsTestCaseInterpolated ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WifiErrorRateModelsTestCaseInterpolated::WifiErrorRateModelsTestCaseInterpolated ()
+  : TestCase ("WifiErrorRateModel test case interpolated")
+{
+}
+
+WifiErrorRateModelsTestCaseInterpolated::~WifiErrorRateModelsTestCaseInterpolated ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseInterpolated::DoRun (void)
+{
+  std::vector<WifiTxVector> txVectors;
+  txVectors.push_back (WifiTxVector (WifiPhy::GetDsssRate1Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 22, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetDsssRate11Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 22, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 20, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetOfdmRate54Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 20, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetHtMcs0 (), 0, WIFI_PREAMBLE_HT_MF, 400, 1, 1, 0, 40, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetHtMcs7 (), 0, WIFI_PREAMBLE_HT_MF, 400, 1, 1, 0, 40, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetVhtMcs8 (), 0, WIFI_PREAMBLE_VHT, 800, 2, 2, 0, 80, false, false));
+  txVectors.push_back (WifiTxVector (WifiPhy::GetHeMcs11 (), 0, WIFI_PREAMBLE_HE_SU, 800, 1, 1, 0, 20, false, false));
+
+  std::vector<Ptr<ErrorRateModel> > models;
+  models.push_back (CreateObject<NistErrorRateModel> ());
+  models.push_back (CreateObject<YansErrorRateModel> ());
+  for (uint32_t i = 0; i < models.size (); i++)
+    {
+      Ptr<InterpolatedErrorRateModel> interpolated = CreateObject<InterpolatedErrorRateModel> ();
+      interpolated->SetAttribute ("ErrorRateModel", TypeIdValue (models[i]->GetInstanceTypeId ()));
+      for (std::vector<WifiTxVector>::const_iterator txVector = txVectors.begin (); txVector != txVectors.end (); txVector++)
+        {
+          WifiMode mode = txVector->GetMode ();
+          // off the grid points, and out of the grid at both ends
+          for (double snrDb = -12.013; snrDb < 52; snrDb += 0.237)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              for (uint64_t nbits = 8; nbits <= 12000 * 8; nbits *= 10)
+                {
+                  double expected = models[i]->GetChunkSuccessRate (mode, *txVector, snr, nbits);
+                  double ps = interpolated->GetChunkSuccessRate (mode, *txVector, snr, nbits);
+                  NS_TEST_EXPECT_MSG_EQ_TOL (ps, expected, 0.001, models[i]->GetInstanceTypeId ().GetName ()
+                                             << " " << mode << " snr=" << snrDb << " dB nbits=" << nbits);
+                }
+            }
+        }
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +378,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseInterpolated, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
@@ -43,6 +43,14 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/uinteger.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/interference-helper.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/qos-blocked-destinations.h"
+#include <sstream>
+#include <iomanip>
 
 using namespace ns3;
 
@@ -237,6 +245,429 @@ public:
 };
 
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Remote station lookup Test
+ *
+ * Check that the states of many remote stations, and their per-TID
+ * retry counters, are kept apart.
+ */
+class WifiRemoteStationLookupTest : public TestCase
+{
+public:
+  WifiRemoteStationLookupTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WifiRemoteStationLookupTest::WifiRemoteStationLookupTest ()
+  : TestCase ("Check the remote station lookups")
+{
+}
+
+void
+WifiRemoteStationLookupTest::DoRun (void)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+  manager->SetAttribute ("MaxSlrc", UintegerValue (2));
+  manager->SetupPhy (phy);
+
+  // the addresses are not allocated, so as to leave the allocator of the
+  // later tests untouched
+  std::vector<Mac48Address> addresses;
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      std::ostringstream oss;
+      oss << "00:00:00:00:" << std::hex << std::setfill ('0') << std::setw (2) << (i >> 8)
+          << ":" << std::setw (2) << (i & 0xff);
+      addresses.push_back (Mac48Address (oss.str ().c_str ()));
+      if (i % 3 == 0)
+        {
+          manager->RecordWaitAssocTxOk (addresses.back ());
+        }
+    }
+  for (uint32_t i = 0; i < addresses.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (manager->IsWaitAssocTxOk (addresses[i]), (i % 3 == 0), "Wrong state of station " << addresses[i]);
+      NS_TEST_EXPECT_MSG_EQ (manager->IsBrandNew (addresses[i]), (i % 3 != 0), "Wrong state of station " << addresses[i]);
+    }
+
+  Ptr<Packet> packet = Create<Packet> (100);
+  WifiMacHeader hdr1;
+  hdr1.SetType (WIFI_MAC_QOSDATA);
+  hdr1.SetQosTid (1);
+  WifiMacHeader hdr2 = hdr1;
+  hdr2.SetQosTid (2);
+  manager->ReportDataFailed (addresses[1], &hdr1);
+  manager->ReportDataFailed (addresses[2], &hdr1);
+  manager->ReportDataFailed (addresses[1], &hdr1);
+  NS_TEST_EXPECT_MSG_EQ (manager->NeedDataRetransmission (addresses[1], &hdr1, packet), false, "Retry limit not reached");
+  NS_TEST_EXPECT_MSG_EQ (manager->NeedDataRetransmission (addresses[1], &hdr2, packet), true, "Retry counter shared between TIDs");
+  NS_TEST_EXPECT_MSG_EQ (manager->NeedDataRetransmission (addresses[2], &hdr1, packet), true, "Retry counter shared between stations");
+
+  manager->Reset ();
+  NS_TEST_EXPECT_MSG_EQ (manager->IsBrandNew (addresses[0]), true, "State not reset");
+  NS_TEST_EXPECT_MSG_EQ (manager->NeedDataRetransmission (addresses[1], &hdr1, packet), true, "Retry counter not reset");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Interference accounting Test
+ *
+ * A reception overlaps with two other signals, one of which lasts after
+ * it, signals keep arriving during a second reception and a third one
+ * starts at the same time as another signal. The SNR and the energy
+ * durations must account for the overlapping signals only.
+ */
+class InterferenceHelperAccountingTest : public TestCase
+{
+public:
+  InterferenceHelperAccountingTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a signal.
+   * \param duration the duration of the signal
+   * \param rxPowerW the power of the signal
+   * \param rx whether the signal is received
+   */
+  void AddSignal (Time duration, double rxPowerW, bool rx);
+  /**
+   * Check the energy duration above a threshold.
+   * \param energyW the threshold
+   * \param expected the expected duration
+   */
+  void CheckEnergyDuration (double energyW, Time expected);
+  /**
+   * Check the SNR of the received signal and end its reception.
+   * \param expectedInterferenceW the interference at the start of the signal
+   */
+  void EndReception (double expectedInterferenceW);
+
+  InterferenceHelper m_interference; //!< the interference helper
+  Ptr<Event> m_rxEvent;              //!< the received signal
+};
+
+InterferenceHelperAccountingTest::InterferenceHelperAccountingTest ()
+  : TestCase ("Check the interference accounting")
+{
+}
+
+void
+InterferenceHelperAccountingTest::AddSignal (Time duration, double rxPowerW, bool rx)
+{
+  WifiTxVector txVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, false, 1, 1, 0, 20, false, false);
+  Ptr<Event> event = m_interference.Add (Create<Packet> (100), txVector, duration, rxPowerW);
+  if (rx)
+    {
+      m_rxEvent = event;
+      m_interference.NotifyRxStart ();
+    }
+}
+
+void
+InterferenceHelperAccountingTest::CheckEnergyDuration (double energyW, Time expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_interference.GetEnergyDuration (energyW), expected, "Wrong energy duration at " << Simulator::Now ());
+}
+
+void
+InterferenceHelperAccountingTest::EndReception (double expectedInterferenceW)
+{
+  double noiseW = 1.3803e-23 * 290 * 20e6;
+  InterferenceHelper::SnrPer snrPer = m_interference.CalculatePlcpPayloadSnrPer (m_rxEvent);
+  NS_TEST_EXPECT_MSG_EQ_TOL (snrPer.snr, m_rxEvent->GetRxPowerW () / (noiseW + expectedInterferenceW), 1e-6 * snrPer.snr,
+                             "Wrong SNR at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_GT (snrPer.per, 0, "Interference not accounted for");
+  NS_TEST_EXPECT_MSG_LT (snrPer.per, 1, "Wrong PER");
+  m_interference.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperAccountingTest::DoRun (void)
+{
+  m_interference.SetNoiseFigure (1);
+  m_interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+
+  // first reception, from 0 to 100 us, with signals from 10 to 30 us and
+  // from 50 to 250 us
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (100), 1e-10, true);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (20), 5e-11, false);
+  Simulator::Schedule (MicroSeconds (50), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (200), 2e-11, false);
+  Simulator::Schedule (MicroSeconds (60), &InterferenceHelperAccountingTest::CheckEnergyDuration, this, 1e-11, MicroSeconds (190));
+  Simulator::Schedule (MicroSeconds (60), &InterferenceHelperAccountingTest::CheckEnergyDuration, this, 1e-10, MicroSeconds (40));
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelperAccountingTest::EndReception, this, 0);
+
+  // second reception, from 200 to 1200 us, starting during the last
+  // signal and with short signals arriving every 10 us
+  Simulator::Schedule (MicroSeconds (200), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (1000), 1e-10, true);
+  for (uint32_t i = 1; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (200 + 10 * i), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (5), 1e-12, false);
+    }
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperAccountingTest::CheckEnergyDuration, this, 1e-11, MicroSeconds (100));
+  Simulator::Schedule (MicroSeconds (1200), &InterferenceHelperAccountingTest::EndReception, this, 2e-11);
+
+  // third reception, from 1300 to 1400 us, with a signal starting at the
+  // same time and another one arriving later
+  Simulator::Schedule (MicroSeconds (1300), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (100), 1e-10, true);
+  Simulator::Schedule (MicroSeconds (1300), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (10), 5e-11, false);
+  Simulator::Schedule (MicroSeconds (1350), &InterferenceHelperAccountingTest::AddSignal, this, MicroSeconds (20), 2e-11, false);
+  Simulator::Schedule (MicroSeconds (1400), &InterferenceHelperAccountingTest::EndReception, this, 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_rxEvent = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Interference of signals starting at the same time Test
+ *
+ * As with hidden stations, a received signal and an interfering signal
+ * start at the same time, after an earlier signal, and a short signal
+ * arrives during the reception, which prunes the changes. The changes at
+ * the start of the reception must all be kept, so that the interfering
+ * signal is accounted for whichever signal is added first.
+ */
+class InterferenceHelperSimultaneousStartTest : public TestCase
+{
+public:
+  /**
+   * \param interfererFirst whether the interfering signal is added before the received one
+   */
+  InterferenceHelperSimultaneousStartTest (bool interfererFirst);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a signal.
+   * \param duration the duration of the signal
+   * \param rxPowerW the power of the signal
+   * \param rx whether the signal is received
+   */
+  void AddSignal (Time duration, double rxPowerW, bool rx);
+  /**
+   * Check the SNR of the received signal and end its reception.
+   */
+  void EndReception (void);
+
+  bool m_interfererFirst;            //!< whether the interfering signal is added first
+  InterferenceHelper m_interference; //!< the interference helper
+  Ptr<Event> m_rxEvent;              //!< the received signal
+};
+
+InterferenceHelperSimultaneousStartTest::InterferenceHelperSimultaneousStartTest (bool interfererFirst)
+  : TestCase (interfererFirst ? "Check the interference of a signal starting with the reception, added first"
+              : "Check the interference of a signal starting with the reception, added last"),
+    m_interfererFirst (interfererFirst)
+{
+}
+
+void
+InterferenceHelperSimultaneousStartTest::AddSignal (Time duration, double rxPowerW, bool rx)
+{
+  WifiTxVector txVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, false, 1, 1, 0, 20, false, false);
+  Ptr<Event> event = m_interference.Add (Create<Packet> (100), txVector, duration, rxPowerW);
+  if (rx)
+    {
+      m_rxEvent = event;
+      m_interference.NotifyRxStart ();
+    }
+}
+
+void
+InterferenceHelperSimultaneousStartTest::EndReception (void)
+{
+  double noiseW = 1.3803e-23 * 290 * 20e6;
+  InterferenceHelper::SnrPer snrPer = m_interference.CalculatePlcpPayloadSnrPer (m_rxEvent);
+  // the SNR is given by the power before the change of the received
+  // signal, and the PER by all the changes after it
+  double interferenceW = m_interfererFirst ? 8e-11 : 0;
+  NS_TEST_EXPECT_MSG_EQ_TOL (snrPer.snr, m_rxEvent->GetRxPowerW () / (noiseW + interferenceW), 1e-6 * snrPer.snr,
+                             "Wrong SNR");
+  NS_TEST_EXPECT_MSG_GT (snrPer.per, 0.5, "Interference of the simultaneous signal not accounted for");
+  m_interference.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperSimultaneousStartTest::DoRun (void)
+{
+  m_interference.SetNoiseFigure (1);
+  m_interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+
+  // a signal from 0 to 50 us, then the reception from 100 to 200 us and an
+  // interfering signal from 100 to 300 us, and a short signal at 150 us
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperSimultaneousStartTest::AddSignal, this, MicroSeconds (50), 2e-11, false);
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelperSimultaneousStartTest::AddSignal, this,
+                       m_interfererFirst ? MicroSeconds (200) : MicroSeconds (100), m_interfererFirst ? 8e-11 : 1e-10, !m_interfererFirst);
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelperSimultaneousStartTest::AddSignal, this,
+                       m_interfererFirst ? MicroSeconds (100) : MicroSeconds (200), m_interfererFirst ? 1e-10 : 8e-11, m_interfererFirst);
+  Simulator::Schedule (MicroSeconds (150), &InterferenceHelperSimultaneousStartTest::AddSignal, this, MicroSeconds (10), 1e-12, false);
+  Simulator::Schedule (MicroSeconds (200), &InterferenceHelperSimultaneousStartTest::EndReception, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_rxEvent = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief WifiMacQueue index Test
+ *
+ * QoS data frames to two receivers and a data frame are queued. The
+ * frames of a receiver and a TID, and the first frame not blocked, must
+ * be found in queue order, and the stale frames must be dropped.
+ */
+class WifiMacQueueIndexTest : public TestCase
+{
+public:
+  WifiMacQueueIndexTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a queue item.
+   * \param dest the receiver
+   * \param tid the TID, or -1 for a data frame without QoS
+   * \return the item
+   */
+  Ptr<WifiMacQueueItem> CreateItem (Mac48Address dest, int tid);
+  /**
+   * Enqueue a frame to the second receiver.
+   */
+  void EnqueueLate (void);
+  /**
+   * Check that the stale frames have been dropped.
+   */
+  void CheckExpiry (void);
+  /**
+   * Count a dropped frame.
+   * \param item the dropped item
+   */
+  void Drop (Ptr<const WifiMacQueueItem> item);
+
+  Ptr<WifiMacQueue> m_queue;           //!< the queue
+  Mac48Address m_a;                    //!< first receiver
+  Mac48Address m_b;                    //!< second receiver
+  Ptr<const Packet> m_late;            //!< the frame enqueued last
+  uint32_t m_dropped;                  //!< the number of dropped frames
+};
+
+WifiMacQueueIndexTest::WifiMacQueueIndexTest ()
+  : TestCase ("Check the WifiMacQueue indexes"),
+    m_a ("00:00:00:00:00:01"),
+    m_b ("00:00:00:00:00:02"),
+    m_dropped (0)
+{
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueueIndexTest::CreateItem (Mac48Address dest, int tid)
+{
+  WifiMacHeader hdr;
+  if (tid < 0)
+    {
+      hdr.SetType (WIFI_MAC_DATA);
+    }
+  else
+    {
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      hdr.SetQosTid (tid);
+    }
+  hdr.SetAddr1 (dest);
+  return Create<WifiMacQueueItem> (Create<Packet> (100), hdr);
+}
+
+void
+WifiMacQueueIndexTest::EnqueueLate (void)
+{
+  Ptr<WifiMacQueueItem> item = CreateItem (m_b, 0);
+  m_late = item->GetPacket ();
+  m_queue->Enqueue (item);
+}
+
+void
+WifiMacQueueIndexTest::CheckExpiry (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByAddress (m_a), 0, "Stale frames not dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 2, "Wrong number of dropped frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 1, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Dequeue ()->GetPacket (), m_late, "Wrong frame");
+}
+
+void
+WifiMacQueueIndexTest::Drop (Ptr<const WifiMacQueueItem> item)
+{
+  m_dropped++;
+}
+
+void
+WifiMacQueueIndexTest::DoRun (void)
+{
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  m_queue->TraceConnectWithoutContext ("Drop", MakeCallback (&WifiMacQueueIndexTest::Drop, this));
+
+  std::vector<Ptr<WifiMacQueueItem> > items;
+  items.push_back (CreateItem (m_a, 0));
+  items.push_back (CreateItem (m_b, 0));
+  items.push_back (CreateItem (m_a, 1));
+  items.push_back (CreateItem (m_a, -1));
+  items.push_back (CreateItem (m_a, 0));
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      m_queue->Enqueue (items[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, m_a), 2, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, m_a), 1, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, m_b), 1, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, m_b), 0, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByAddress (m_a), 4, "Wrong number of frames");
+
+  Ptr<QosBlockedDestinations> blocked = Create<QosBlockedDestinations> ();
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekFirstAvailable (blocked), items[0], "Wrong first frame");
+  blocked->Block (m_a, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekFirstAvailable (blocked), items[1], "Wrong first available frame");
+  blocked->Block (m_b, 0);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekFirstAvailable (blocked), items[2], "Wrong first available frame");
+
+  // a frame pushed at the front precedes the others
+  Ptr<WifiMacQueueItem> front = CreateItem (m_a, 1);
+  m_queue->PushFront (front);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekFirstAvailable (blocked), front, "Wrong first available frame");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekByTidAndAddress (1, WifiMacHeader::ADDR1, m_a), front, "Wrong first frame");
+  blocked->Block (m_a, 1);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->DequeueFirstAvailable (blocked), items[3], "Wrong first available frame");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->PeekFirstAvailable (blocked), 0, "All the frames are blocked");
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->DequeueByTidAndAddress (0, WifiMacHeader::ADDR1, m_a), items[0], "Wrong frame");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->DequeueByTidAndAddress (0, WifiMacHeader::ADDR1, m_a), items[4], "Wrong frame");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->DequeueByTidAndAddress (0, WifiMacHeader::ADDR1, m_a), 0, "No frame left");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Remove (items[1]->GetPacket ()), true, "Frame not removed");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, m_b), 0, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Dequeue (), front, "Wrong head of the queue");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 1, "Wrong number of frames");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 1, "Wrong number of dropped frames");
+
+  // the frame left is dropped after 10 ms, but not the one enqueued at 5 ms
+  Simulator::Schedule (MilliSeconds (5), &WifiMacQueueIndexTest::EnqueueLate, this);
+  Simulator::Schedule (MilliSeconds (12), &WifiMacQueueIndexTest::CheckExpiry, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_queue = 0;
+}
+
 /**
  * See \bugid{991}
  */
@@ -1714,6 +2145,11 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new WifiRemoteStationLookupTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperAccountingTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperSimultaneousStartTest (true), TestCase::QUICK);
+  AddTestCase (new InterferenceHelperSimultaneousStartTest (false), TestCase::QUICK);
+  AddTestCase (new WifiMacQueueIndexTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
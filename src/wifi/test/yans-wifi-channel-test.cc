@@ -0,0 +1,367 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/wifi-phy-tag.h"
+#include "ns3/nist-error-rate-model.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel receiver culling Test
+ *
+ * A PHY sends at t=0 and t=2 s to receivers at 50 m, 150 m and 1000 m,
+ * the last one being moved to 100 m at t=1 s, and to a receiver leaving
+ * 300 m at 100 m/s. The transmissions are incomplete frames, which each
+ * receiver drops, so that the drops count the deliveries.
+ */
+class YansWifiChannelCullingTestCase : public TestCase
+{
+public:
+  /**
+   * \param maxLossDb the MaxLossDb attribute of the channel
+   * \param maxRange the MaxRange attribute of the channel
+   * \param expected the expected number of deliveries to each receiver
+   */
+  YansWifiChannelCullingTestCase (double maxLossDb, double maxRange, std::vector<uint32_t> expected);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send a signal from the first PHY.
+   */
+  void Send (void);
+  /**
+   * \brief Count a delivery.
+   * \param index the index of the receiving PHY
+   * \param packet the dropped packet
+   */
+  void RxDrop (uint32_t index, Ptr<const Packet> packet);
+
+  double m_maxLossDb;                //!< MaxLossDb attribute of the channel
+  double m_maxRange;                 //!< MaxRange attribute of the channel
+  std::vector<uint32_t> m_expected;  //!< Expected number of deliveries to each receiver
+  std::vector<uint32_t> m_received;  //!< Number of deliveries to each receiver
+  Ptr<YansWifiChannel> m_channel;    //!< Channel
+  Ptr<YansWifiPhy> m_sender;         //!< Sending PHY
+};
+
+YansWifiChannelCullingTestCase::YansWifiChannelCullingTestCase (double maxLossDb, double maxRange,
+                                                                std::vector<uint32_t> expected)
+  : TestCase ("Check the YansWifiChannel receiver culling"),
+    m_maxLossDb (maxLossDb),
+    m_maxRange (maxRange),
+    m_expected (expected)
+{
+}
+
+void
+YansWifiChannelCullingTestCase::Send (void)
+{
+  Ptr<Packet> packet = Create<Packet> (1000);
+  packet->AddPacketTag (WifiPhyTag (WifiTxVector (), NORMAL_MPDU, 0));
+  m_channel->Send (m_sender, packet, 20, MicroSeconds (100));
+}
+
+void
+YansWifiChannelCullingTestCase::RxDrop (uint32_t index, Ptr<const Packet> packet)
+{
+  m_received[index]++;
+}
+
+void
+YansWifiChannelCullingTestCase::DoRun (void)
+{
+  m_channel = CreateObject<YansWifiChannel> ();
+  m_channel->SetAttribute ("MaxLossDb", DoubleValue (m_maxLossDb));
+  m_channel->SetAttribute ("MaxRange", DoubleValue (m_maxRange));
+  m_channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  m_channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  std::vector<Ptr<MobilityModel> > mobilities;
+  double positions[] = {0, 50, 150, 1000};
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (positions[i], 0, 0));
+      mobilities.push_back (mobility);
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (300, 0, 0));
+  moving->SetVelocity (Vector (-100, 0, 0));
+  mobilities.push_back (moving);
+
+  m_received.assign (mobilities.size () - 1, 0);
+  for (uint32_t i = 0; i < mobilities.size (); i++)
+    {
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phy->SetMobility (mobilities[i]);
+      phy->SetChannel (m_channel);
+      if (i == 0)
+        {
+          m_sender = phy;
+        }
+      else
+        {
+          phy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&YansWifiChannelCullingTestCase::RxDrop, this).Bind (i - 1));
+        }
+    }
+
+  Simulator::Schedule (Seconds (0), &YansWifiChannelCullingTestCase::Send, this);
+  Simulator::Schedule (Seconds (1), &MobilityModel::SetPosition, mobilities[3], Vector (100, 0, 0));
+  Simulator::Schedule (Seconds (2), &YansWifiChannelCullingTestCase::Send, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < m_expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], m_expected[i], "Wrong number of deliveries to receiver " << i);
+    }
+  m_channel = 0;
+  m_sender = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel delivery Test
+ *
+ * A PHY sends to four receivers, three of which are at the same distance.
+ * Each receiver must get the signal once, at the propagation delay, in
+ * the context of its node.
+ */
+class YansWifiChannelFanOutTestCase : public TestCase
+{
+public:
+  YansWifiChannelFanOutTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check a delivery.
+   * \param index the index of the receiving PHY
+   * \param packet the dropped packet
+   */
+  void RxDrop (uint32_t index, Ptr<const Packet> packet);
+
+  std::vector<Ptr<Node> > m_nodes;   //!< Nodes of the receivers
+  std::vector<Time> m_rxTimes;       //!< Reception time at each receiver
+  std::vector<uint32_t> m_received;  //!< Number of deliveries to each receiver
+};
+
+YansWifiChannelFanOutTestCase::YansWifiChannelFanOutTestCase ()
+  : TestCase ("Check the YansWifiChannel delivery events")
+{
+}
+
+void
+YansWifiChannelFanOutTestCase::RxDrop (uint32_t index, Ptr<const Packet> packet)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), m_nodes[index]->GetId (), "Wrong context for receiver " << index);
+  m_received[index]++;
+  m_rxTimes[index] = Simulator::Now ();
+}
+
+void
+YansWifiChannelFanOutTestCase::DoRun (void)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  Vector positions[] = {Vector (0, 0, 0), Vector (30, 0, 0), Vector (0, 30, 0), Vector (60, 0, 0), Vector (-30, 0, 0)};
+  Ptr<YansWifiPhy> sender;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+      device->SetNode (node);
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (positions[i]);
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phy->SetDevice (device);
+      phy->SetMobility (mobility);
+      phy->SetChannel (channel);
+      if (i == 0)
+        {
+          sender = phy;
+        }
+      else
+        {
+          m_nodes.push_back (node);
+          phy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&YansWifiChannelFanOutTestCase::RxDrop, this).Bind (i - 1));
+        }
+    }
+  m_received.assign (m_nodes.size (), 0);
+  m_rxTimes.assign (m_nodes.size (), Seconds (0));
+
+  Ptr<Packet> packet = Create<Packet> (1000);
+  packet->AddPacketTag (WifiPhyTag (WifiTxVector (), NORMAL_MPDU, 0));
+  Simulator::ScheduleWithContext (1, Seconds (1), &YansWifiChannel::Send, channel, sender, packet, 20, MicroSeconds (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double distances[] = {30, 30, 60, 30};
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], 1, "Wrong number of deliveries to receiver " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], Seconds (1) + Seconds (distances[i] / 299792458.0), "Wrong reception time at receiver " << i);
+    }
+  m_nodes.clear ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel culled interference Test
+ *
+ * A PHY at 10 m sends a frame to a receiver while a PHY at 100 m has
+ * started sending 10 us earlier. When the interfering signal is culled by
+ * MaxLossDb or MaxRange, it must not lower the SNR of the reception.
+ */
+class YansWifiChannelCulledInterferenceTestCase : public TestCase
+{
+public:
+  YansWifiChannelCulledInterferenceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Run a reception.
+   * \param interfere true if the PHY at 100 m sends
+   * \param maxLossDb the MaxLossDb attribute of the channel
+   * \param maxRange the MaxRange attribute of the channel
+   * \returns the SNR of the reception, or zero if it failed
+   */
+  double RunReception (bool interfere, double maxLossDb, double maxRange);
+  /**
+   * \brief Record a successful reception.
+   * \param packet the received packet
+   * \param snr the SNR of the reception
+   * \param txVector the TXVECTOR of the packet
+   */
+  void RxOk (Ptr<Packet> packet, double snr, WifiTxVector txVector);
+
+  double m_snr; //!< SNR of the last reception
+};
+
+YansWifiChannelCulledInterferenceTestCase::YansWifiChannelCulledInterferenceTestCase ()
+  : TestCase ("Check the interference of the signals culled by the YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelCulledInterferenceTestCase::RxOk (Ptr<Packet> packet, double snr, WifiTxVector txVector)
+{
+  m_snr = snr;
+}
+
+double
+YansWifiChannelCulledInterferenceTestCase::RunReception (bool interfere, double maxLossDb, double maxRange)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("MaxLossDb", DoubleValue (maxLossDb));
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  // receiver, sender, interferer
+  std::vector<Ptr<YansWifiPhy> > phys;
+  double positions[] = {0, 10, 100};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (positions[i], 0, 0));
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+      phy->SetMobility (mobility);
+      phy->SetChannel (channel);
+      phys.push_back (phy);
+    }
+  phys[0]->SetReceiveOkCallback (MakeCallback (&YansWifiChannelCulledInterferenceTestCase::RxOk, this));
+
+  m_snr = 0;
+  WifiTxVector txVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, false, 1, 1, 0, 20, false, false);
+  if (interfere)
+    {
+      Simulator::Schedule (Seconds (1), &WifiPhy::SendPacket, phys[2], Create<Packet> (1000), txVector, NORMAL_MPDU);
+    }
+  Simulator::Schedule (Seconds (1) + MicroSeconds (10), &WifiPhy::SendPacket, phys[1], Create<Packet> (1000),
+                       txVector, NORMAL_MPDU);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_snr;
+}
+
+void
+YansWifiChannelCulledInterferenceTestCase::DoRun (void)
+{
+  double alone = RunReception (false, 1e9, 0);
+  NS_TEST_ASSERT_MSG_GT (alone, 0, "The frame must be received");
+
+  // the interferer is beyond 50 m and 100 dB of loss (about 55 m)
+  double rangeCulled = RunReception (true, 1e9, 50);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rangeCulled, alone, alone * 1e-9, "The signal culled by MaxRange must be ignored");
+
+  double lossCulled = RunReception (true, 100, 0);
+  NS_TEST_EXPECT_MSG_EQ_TOL (lossCulled, alone, alone * 1e-9, "The signal culled by MaxLossDb must be ignored");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel TestSuite
+ */
+class YansWifiChannelTestSuite : public TestSuite
+{
+public:
+  YansWifiChannelTestSuite ();
+};
+
+YansWifiChannelTestSuite::YansWifiChannelTestSuite ()
+  : TestSuite ("yans-wifi-channel", UNIT)
+{
+  // no culling
+  AddTestCase (new YansWifiChannelCullingTestCase (1e9, 0, {2, 2, 2, 2}), TestCase::QUICK);
+  // the receivers beyond 105 dB of loss (about 90 m) are dropped
+  AddTestCase (new YansWifiChannelCullingTestCase (105, 0, {2, 0, 0, 0}), TestCase::QUICK);
+  // the receivers beyond 200 m are ignored
+  AddTestCase (new YansWifiChannelCullingTestCase (1e9, 200, {2, 2, 1, 1}), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelFanOutTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelCulledInterferenceTestCase, TestCase::QUICK);
+}
+
+static YansWifiChannelTestSuite g_yansWifiChannelTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,2 @@
+$ns_ at 1.0 "$node_(0) setdest 25 0 5"
+$ns_ at 7.0 "$node_(0) setdest 11  22  0"
@@ -0,0 +1,7 @@
+# comment
+
+
+$node_(0) set X_ 1.0 # comment 
+$node_(0) set Y_ 2.0 ### 
+$node_(0) set Z_ 3.0 # $node_(0) set Z_ 3.0
+#$node_(0) set Z_ 100 #
\ No newline at end of file
@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program renders a binary trace file, written by the streams of
+// AsciiTraceHelper::CreateBinaryFileStream, as an ascii trace file.
+// Sample usage:  ./waf --run 'decode-binary-trace --input=trace.trb --output=trace.tr'
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include <iostream>
+#include <fstream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Render a binary trace file as an ascii trace file.");
+  cmd.AddValue ("input", "binary trace file, possibly compressed", input);
+  cmd.AddValue ("output", "ascii trace file (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Missing --input" << std::endl;
+      return 1;
+    }
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file)
+        {
+          std::cerr << "Cannot open " << output << std::endl;
+          return 1;
+        }
+      os = &file;
+    }
+  if (!BinaryTraceFile::Decode (input, *os))
+    {
+      std::cerr << input << " is not a valid binary trace file" << std::endl;
+      return 1;
+    }
+  return 0;
+}